@@ -25,8 +25,18 @@
 #include "resources/image.h"
 #include "resources/resourcemanager.h"
 
+/**
+ * Movement further than this within a tick is a jump, which isn't
+ * interpolated.
+ */
+static const float MAX_INTERPOLATED_DISTANCE = 32.0f;
+
+int Actor::mLogicTick = 0;
+float Actor::mInterpolation = 1.0f;
+
 Actor::Actor():
-        mMap(NULL)
+        mMap(NULL),
+        mSavedTick(-1)
 {}
 
 Actor::~Actor()
@@ -56,3 +66,21 @@ int Actor::getTileY() const
 {
     return getPixelY() / mMap->getTileHeight();
 }
+
+Vector Actor::getDrawPosition() const
+{
+    if (mSavedTick != mLogicTick || mInterpolation >= 1.0f)
+        return mPos;
+
+    const Vector moved = mPos - mSavedPos;
+    if (moved.length() > MAX_INTERPOLATED_DISTANCE)
+        return mPos;
+
+    return mSavedPos + moved * mInterpolation;
+}
+
+void Actor::savePosition()
+{
+    mSavedPos = mPos;
+    mSavedTick = mLogicTick;
+}
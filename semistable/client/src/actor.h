@@ -74,6 +74,35 @@ public:
     virtual void setPosition(const Vector &pos)
     { mPos = pos; }
 
+    /**
+     * Returns the position to draw this actor at. When drawing happens
+     * between two logic ticks, this lies between the positions of the actor
+     * at these ticks, so that movement looks smooth at any frame rate.
+     */
+    Vector getDrawPosition() const;
+
+    /**
+     * Remembers the current position as the one of the previous logic tick.
+     */
+    void savePosition();
+
+    /**
+     * Starts a new logic tick. Actors that didn't save their position since
+     * are drawn at their current position.
+     */
+    static void nextLogicTick()
+    { ++mLogicTick; }
+
+    /**
+     * Sets how far the current frame is between the previous and the
+     * current logic tick, from 0 to 1.
+     */
+    static void setInterpolation(float interpolation)
+    { mInterpolation = interpolation; }
+
+    static float getInterpolation()
+    { return mInterpolation; }
+
     /**
      * Returns the pixels X coordinate of the actor.
      */
@@ -123,6 +152,12 @@ protected:
 
 private:
     Actors::iterator mMapActor;
+
+    Vector mSavedPos;           /**< Position at the previous logic tick. */
+    int mSavedTick;             /**< Logic tick the position was saved in. */
+
+    static int mLogicTick;
+    static float mInterpolation;
 };
 
 #endif // ACTOR_H
@@ -75,9 +75,10 @@ bool ActorSprite::draw(Graphics *graphics, int offsetX, int offsetY) const
     // TODO: Eventually, we probably should fix all sprite offsets so that
     //       these translations aren't necessary anymore. The sprites know
     //       best where their base point should be.
-    const int px = getPixelX() + offsetX - 16;
+    const Vector pos = getDrawPosition();
+    const int px = (int) pos.x + offsetX - 16;
     // Temporary fix to the Y offset.
-    const int py = getPixelY() + offsetY -
+    const int py = (int) pos.y + offsetY -
         ((Net::getNetworkType() == ServerInfo::MANASERV) ? 15 : 32);
 
     if (mUsedTargetCursor)
@@ -26,33 +26,19 @@
 #include "utils/stringutils.h"
 #include "utils/dtor.h"
 
+#include <algorithm>
 #include <cassert>
 
 #define for_actors ActorSpritesConstIterator it, it_end; \
 for (it = mActors.begin(), it_end = mActors.end() ; it != it_end; it++)
 
-class FindBeingFunctor
-{
-    public:
-        bool operator() (ActorSprite *actor)
-        {
-            if (actor->getType() == ActorSprite::FLOOR_ITEM)
-                return false;
-            Being* b = static_cast<Being*>(actor);
-
-            Uint16 other_y = y + ((b->getType() == ActorSprite::NPC) ? 1 : 0);
-            const Vector &pos = b->getPosition();
-            return ((int) pos.x / 32 == x &&
-                    ((int) pos.y / 32 == y || (int) pos.y / 32 == other_y) &&
-                    b->isAlive() &&
-                    (type == ActorSprite::UNKNOWN || b->getType() == type));
-        }
+/** The size of the tiles the spatial index is organized in. */
+static const int TILE_SIZE = 32;
 
-        Uint16 x, y;
-        ActorSprite::Type type;
-} beingFinder;
-
-ActorSpriteManager::ActorSpriteManager()
+ActorSpriteManager::ActorSpriteManager():
+    mMap(0),
+    mMaxBeingWidth(0),
+    mMaxBeingHeight(0)
 {
 }
 
@@ -73,6 +59,7 @@ void ActorSpriteManager::setPlayer(LocalPlayer *player)
 {
     player_node = player;
     mActors.insert(player);
+    addToIndex(player);
 }
 
 Being *ActorSpriteManager::createBeing(int id, ActorSprite::Type type, int subtype)
@@ -80,6 +67,7 @@ Being *ActorSpriteManager::createBeing(int id, ActorSprite::Type type, int subty
     Being *being = new Being(id, type, subtype, mMap);
 
     mActors.insert(being);
+    addToIndex(being);
     return being;
 }
 
@@ -88,6 +76,7 @@ FloorItem *ActorSpriteManager::createItem(int id, int itemId, int x, int y)
     FloorItem *floorItem = new FloorItem(id, itemId, x, y, mMap);
 
     mActors.insert(floorItem);
+    addToIndex(floorItem);
     return floorItem;
 }
 
@@ -114,19 +103,42 @@ Being *ActorSpriteManager::findBeing(int id) const
 
 Being *ActorSpriteManager::findBeing(int x, int y, ActorSprite::Type type) const
 {
-    beingFinder.x = x;
-    beingFinder.y = y;
-    beingFinder.type = type;
+    // NPCs can also be found from the tile above them
+    std::vector<ActorSprite*> actors;
+    findInTiles(x, y, x, y + 1, actors);
+
+    for (std::vector<ActorSprite*>::const_iterator it = actors.begin(),
+         it_end = actors.end(); it != it_end; ++it)
+    {
+        if ((*it)->getType() == ActorSprite::FLOOR_ITEM)
+            continue;
 
-    ActorSpritesConstIterator it = find_if(mActors.begin(), mActors.end(),
-                                           beingFinder);
+        Being *being = static_cast<Being*>(*it);
+        if (being->getPixelY() / TILE_SIZE != y &&
+            being->getType() != ActorSprite::NPC)
+            continue;
 
-    return (it == mActors.end()) ? NULL : static_cast<Being*>(*it);
+        if (being->isAlive() &&
+            (type == ActorSprite::UNKNOWN || being->getType() == type))
+            return being;
+    }
+
+    return NULL;
 }
 
 Being *ActorSpriteManager::findBeingByPixel(int x, int y) const
 {
-    for_actors
+    // Beings are drawn centered above their position, so only those with a
+    // position close enough below the pixel can be hit
+    const int xtolMax = mMaxBeingWidth / 2;
+
+    std::vector<ActorSprite*> actors;
+    findInTiles((x - xtolMax) / TILE_SIZE, y / TILE_SIZE,
+                (x + xtolMax) / TILE_SIZE, (y + mMaxBeingHeight) / TILE_SIZE,
+                actors);
+
+    for (std::vector<ActorSprite*>::const_iterator it = actors.begin(),
+         it_end = actors.end(); it != it_end; ++it)
     {
         if ((*it)->getType() == ActorSprite::FLOOR_ITEM)
             continue;
@@ -164,7 +176,12 @@ FloorItem *ActorSpriteManager::findItem(int id) const
 
 FloorItem *ActorSpriteManager::findItem(int x, int y) const
 {
-    for_actors
+    TileBuckets::const_iterator bucket = mTileBuckets.find(Tile(x, y));
+    if (bucket == mTileBuckets.end())
+        return NULL;
+
+    for (ActorSpritesConstIterator it = bucket->second.begin(),
+         it_end = bucket->second.end(); it != it_end; ++it)
     {
         if ((*it)->getTileX() == x && (*it)->getTileY() == y &&
             (*it)->getType() == ActorSprite::FLOOR_ITEM)
@@ -179,14 +196,14 @@ FloorItem *ActorSpriteManager::findItem(int x, int y) const
 Being *ActorSpriteManager::findBeingByName(const std::string &name,
                                      ActorSprite::Type type) const
 {
-    for_actors
-    {
-        if ((*it)->getType() == ActorSprite::FLOOR_ITEM)
-            continue;
+    std::pair<BeingNames::const_iterator, BeingNames::const_iterator> range =
+            mBeingNames.equal_range(name);
 
-        Being *being = static_cast<Being*>(*it);
-        if (being->getName() == name &&
-           (type == ActorSprite::UNKNOWN || type == being->getType()))
+    for (BeingNames::const_iterator it = range.first; it != range.second;
+         ++it)
+    {
+        Being *being = it->second;
+        if (type == ActorSprite::UNKNOWN || type == being->getType())
             return being;
     }
     return NULL;
@@ -199,12 +216,27 @@ const ActorSprites &ActorSpriteManager::getAll() const
 
 void ActorSpriteManager::logic()
 {
+    int maxBeingWidth = 0;
+    int maxBeingHeight = 0;
+
     for_actors
+    {
         (*it)->logic();
 
+        if ((*it)->getType() != ActorSprite::FLOOR_ITEM)
+        {
+            maxBeingWidth = std::max(maxBeingWidth, (*it)->getWidth());
+            maxBeingHeight = std::max(maxBeingHeight, (*it)->getHeight());
+        }
+    }
+
+    mMaxBeingWidth = maxBeingWidth;
+    mMaxBeingHeight = maxBeingHeight;
+
     for (it = mDeleteActors.begin(), it_end = mDeleteActors.end();
          it != it_end; ++it)
     {
+        removeFromIndex(*it);
         mActors.erase(*it);
         delete *it;
     }
@@ -225,8 +257,15 @@ void ActorSpriteManager::clear()
     mActors.clear();
     mDeleteActors.clear();
 
+    mTileBuckets.clear();
+    mActorTiles.clear();
+    mBeingNames.clear();
+
     if (player_node)
+    {
         mActors.insert(player_node);
+        addToIndex(player_node);
+    }
 }
 
 Being *ActorSpriteManager::findNearestLivingBeing(int x, int y,
@@ -237,9 +276,17 @@ Being *ActorSpriteManager::findNearestLivingBeing(int x, int y,
     Being *closestBeing = 0;
     int dist = 0;
 
-    const int maxDist = maxTileDist * 32;
+    const int maxDist = maxTileDist * TILE_SIZE;
 
-    for_actors
+    // Anything further away than a tile more than the maximum distance in
+    // either direction can't be close enough
+    std::vector<ActorSprite*> actors;
+    findInTiles(x / TILE_SIZE - maxTileDist - 1, y / TILE_SIZE - maxTileDist - 1,
+                x / TILE_SIZE + maxTileDist + 1, y / TILE_SIZE + maxTileDist + 1,
+                actors);
+
+    for (std::vector<ActorSprite*>::const_iterator it = actors.begin(),
+         it_end = actors.end(); it != it_end; ++it)
     {
         if ((*it)->getType() == ActorSprite::FLOOR_ITEM)
             continue;
@@ -272,13 +319,7 @@ Being *ActorSpriteManager::findNearestLivingBeing(Being *aroundBeing,
 
 bool ActorSpriteManager::hasActorSprite(ActorSprite *actor) const
 {
-    for_actors
-    {
-        if (actor == *it)
-            return true;
-    }
-
-    return false;
+    return mActors.find(actor) != mActors.end();
 }
 
 void ActorSpriteManager::getPlayerNames(std::vector<std::string> &names,
@@ -313,3 +354,123 @@ void ActorSpriteManager::updatePlayerNames()
             being->updateName();
     }
 }
+
+void ActorSpriteManager::updatePosition(ActorSprite *actor)
+{
+    ActorTiles::iterator it = mActorTiles.find(actor);
+
+    // Beings that aren't managed here, like those in the character selection
+    if (it == mActorTiles.end())
+        return;
+
+    const Tile tile = getTile(actor);
+    if (tile == it->second)
+        return;
+
+    TileBuckets::iterator bucket = mTileBuckets.find(it->second);
+    bucket->second.erase(actor);
+    if (bucket->second.empty())
+        mTileBuckets.erase(bucket);
+
+    mTileBuckets[tile].insert(actor);
+    it->second = tile;
+}
+
+void ActorSpriteManager::updateName(Being *being, const std::string &oldName)
+{
+    std::pair<BeingNames::iterator, BeingNames::iterator> range =
+            mBeingNames.equal_range(oldName);
+
+    for (BeingNames::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == being)
+        {
+            mBeingNames.erase(it);
+            mBeingNames.insert(std::make_pair(being->getName(), being));
+            return;
+        }
+    }
+}
+
+ActorSpriteManager::Tile ActorSpriteManager::getTile(const ActorSprite *actor)
+{
+    const Vector &pos = actor->getPosition();
+    return Tile((int) pos.x / TILE_SIZE, (int) pos.y / TILE_SIZE);
+}
+
+void ActorSpriteManager::addToIndex(ActorSprite *actor)
+{
+    const Tile tile = getTile(actor);
+    mTileBuckets[tile].insert(actor);
+    mActorTiles[actor] = tile;
+
+    if (actor->getType() != ActorSprite::FLOOR_ITEM)
+    {
+        Being *being = static_cast<Being*>(actor);
+        mBeingNames.insert(std::make_pair(being->getName(), being));
+    }
+}
+
+void ActorSpriteManager::removeFromIndex(ActorSprite *actor)
+{
+    ActorTiles::iterator it = mActorTiles.find(actor);
+    if (it == mActorTiles.end())
+        return;
+
+    TileBuckets::iterator bucket = mTileBuckets.find(it->second);
+    bucket->second.erase(actor);
+    if (bucket->second.empty())
+        mTileBuckets.erase(bucket);
+
+    mActorTiles.erase(it);
+
+    if (actor->getType() != ActorSprite::FLOOR_ITEM)
+    {
+        Being *being = static_cast<Being*>(actor);
+        std::pair<BeingNames::iterator, BeingNames::iterator> range =
+                mBeingNames.equal_range(being->getName());
+
+        for (BeingNames::iterator name = range.first; name != range.second;
+             ++name)
+        {
+            if (name->second == being)
+            {
+                mBeingNames.erase(name);
+                break;
+            }
+        }
+    }
+}
+
+void ActorSpriteManager::findInTiles(int minX, int minY, int maxX, int maxY,
+                                     std::vector<ActorSprite*> &result) const
+{
+    // With few occupied tiles, going through all of them is quicker than
+    // looking up each column
+    if (maxX - minX + 1 > (int) mTileBuckets.size())
+    {
+        for (TileBuckets::const_iterator it = mTileBuckets.begin(),
+             it_end = mTileBuckets.end(); it != it_end; ++it)
+        {
+            const Tile &tile = it->first;
+            if (tile.first >= minX && tile.first <= maxX &&
+                tile.second >= minY && tile.second <= maxY)
+            {
+                result.insert(result.end(),
+                              it->second.begin(), it->second.end());
+            }
+        }
+        return;
+    }
+
+    for (int x = minX; x <= maxX; ++x)
+    {
+        TileBuckets::const_iterator it =
+                mTileBuckets.lower_bound(Tile(x, minY));
+        TileBuckets::const_iterator it_end =
+                mTileBuckets.upper_bound(Tile(x, maxY));
+
+        for (; it != it_end; ++it)
+            result.insert(result.end(), it->second.begin(), it->second.end());
+    }
+}
@@ -26,6 +26,8 @@
 #include "being.h"
 #include "flooritem.h"
 
+#include <map>
+
 class LocalPlayer;
 class Map;
 
@@ -152,10 +154,48 @@ class ActorSpriteManager
 
         void updatePlayerNames();
 
+        /**
+         * Moves the given ActorSprite to the tile it is on now in the spatial
+         * index. Beings call this whenever their position changes.
+         */
+        void updatePosition(ActorSprite *actor);
+
+        /**
+         * Updates the name index after the given Being changed its name.
+         */
+        void updateName(Being *being, const std::string &oldName);
+
+        /**
+         * Appends the ActorSprites on the given rectangle of tiles, borders
+         * included, to the result.
+         */
+        void findInTiles(int minX, int minY, int maxX, int maxY,
+                         std::vector<ActorSprite*> &result) const;
+
     protected:
+        /** A tile position, ordered by column and then by row. */
+        typedef std::pair<int, int> Tile;
+        typedef std::map<Tile, ActorSprites> TileBuckets;
+        typedef std::map<ActorSprite*, Tile> ActorTiles;
+        typedef std::multimap<std::string, Being*> BeingNames;
+
+        static Tile getTile(const ActorSprite *actor);
+
+        void addToIndex(ActorSprite *actor);
+        void removeFromIndex(ActorSprite *actor);
+
+
         ActorSprites mActors;
         ActorSprites mDeleteActors;
         Map *mMap;
+
+        TileBuckets mTileBuckets;   /**< The ActorSprites on each tile. */
+        ActorTiles mActorTiles;     /**< The tile each ActorSprite is on. */
+        BeingNames mBeingNames;
+
+        /** The largest being sprite as of the last logic tick. */
+        int mMaxBeingWidth;
+        int mMaxBeingHeight;
 };
 
 extern ActorSpriteManager *actorSpriteManager;
@@ -179,6 +179,9 @@ void Being::setPosition(const Vector &pos)
 {
     Actor::setPosition(pos);
 
+    if (actorSpriteManager)
+        actorSpriteManager->updatePosition(this);
+
     updateCoords();
 
     if (mText)
@@ -389,6 +392,8 @@ void Being::handleAttack(Being *victim, int damage, AttackType type)
 
 void Being::setName(const std::string &name)
 {
+    const std::string oldName = mName;
+
     if (getType() == NPC)
     {
         mName = name.substr(0, name.find('#', 0));
@@ -401,6 +406,9 @@ void Being::setName(const std::string &name)
         if (getType() == PLAYER && getShowName())
             showName();
     }
+
+    if (actorSpriteManager && mName != oldName)
+        actorSpriteManager->updateName(this, oldName);
 }
 
 void Being::setShowName(bool doShowName)
@@ -692,6 +700,9 @@ int Being::getCollisionRadius() const
 
 void Being::logic()
 {
+    if (!mPendingSprites.empty())
+        loadPendingSprites();
+
     // Reduce the time that speech is still displayed
     if (mSpeechTime > 0)
         mSpeechTime--;
@@ -876,8 +887,9 @@ void Being::drawEmotion(Graphics *graphics, int offsetX, int offsetY)
     if (!mEmotion)
         return;
 
-    const int px = getPixelX() - offsetX - 16;
-    const int py = getPixelY() - offsetY - 64 - 32;
+    const Vector pos = getDrawPosition();
+    const int px = (int) pos.x - offsetX - 16;
+    const int py = (int) pos.y - offsetY - 64 - 32;
     const int emotionIndex = mEmotion - 1;
 
     if (emotionIndex >= 0 && emotionIndex <= EmoteDB::getLast())
@@ -886,9 +898,11 @@ void Being::drawEmotion(Graphics *graphics, int offsetX, int offsetY)
 
 void Being::drawSpeech(int offsetX, int offsetY)
 {
-    const int px = getPixelX() - offsetX;
-    const int py = getPixelY() - offsetY;
-    const int speech = config.getIntValue("speech");
+    const Vector pos = getDrawPosition();
+    const int px = (int) pos.x - offsetX;
+    const int py = (int) pos.y - offsetY;
+    static const IntOption speechOption(config, "speech");
+    const int speech = speechOption;
 
     // Draw speech above this being
     if (mSpeechTime == 0)
@@ -1096,6 +1110,9 @@ void Being::setSprite(unsigned int slot, int id, const std::string &color,
     if (slot >= mSpriteColors.size())
         mSpriteColors.resize(slot + 1, "");
 
+    // Any sprite still waiting for its images is replaced
+    mPendingSprites.erase(slot);
+
     // id = 0 means unequip
     if (id == 0)
     {
@@ -1114,8 +1131,24 @@ void Being::setSprite(unsigned int slot, int id, const std::string &color,
             if (!color.empty())
                 filename += "|" + color;
 
-            equipmentSprite = AnimatedSprite::load(
-                                    paths.getStringValue("sprites") + filename);
+            const std::string path = paths.getStringValue("sprites") + filename;
+
+            // Don't stall on decoding the images, they are loaded in the
+            // background and the sprite is set once they are ready
+            if (!ResourceManager::getInstance()->requestSprite(path))
+            {
+                PendingSprite &pending = mPendingSprites[slot];
+                pending.path = path;
+                pending.id = id;
+                pending.color = color;
+                pending.isWeapon = isWeapon;
+
+                mSpriteIDs[slot] = id;
+                mSpriteColors[slot] = color;
+                return;
+            }
+
+            equipmentSprite = AnimatedSprite::load(path);
         }
 
         if (equipmentSprite)
@@ -1133,6 +1166,29 @@ void Being::setSprite(unsigned int slot, int id, const std::string &color,
     mSpriteColors[slot] = color;
 }
 
+void Being::loadPendingSprites()
+{
+    ResourceManager *resman = ResourceManager::getInstance();
+
+    std::map<unsigned int, PendingSprite>::iterator it =
+        mPendingSprites.begin();
+
+    while (it != mPendingSprites.end())
+    {
+        if (!resman->requestSprite(it->second.path))
+        {
+            ++it;
+            continue;
+        }
+
+        const unsigned int slot = it->first;
+        const PendingSprite pending = it->second;
+        mPendingSprites.erase(it++);
+
+        setSprite(slot, pending.id, pending.color, pending.isWeapon);
+    }
+}
+
 void Being::setSpriteID(unsigned int slot, int id)
 {
     setSprite(slot, id, mSpriteColors[slot]);
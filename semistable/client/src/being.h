@@ -292,7 +292,9 @@ class Being : public ActorSprite, public ConfigListener, public Mana::Listener
         { return mParty; }
 
         /**
-         * Sets visible equipments for this being.
+         * Sets visible equipments for this being. When the images of the
+         * equipment still need to be decoded, they are decoded in the
+         * background and the slot keeps its current sprite until then.
          */
         void setSprite(unsigned int slot, int id,
                        const std::string &color = "", bool isWeapon = false);
@@ -511,6 +513,12 @@ class Being : public ActorSprite, public ConfigListener, public Mana::Listener
 
         void updateColors();
 
+        /**
+         * Sets the sprites that were waiting for their images, once these
+         * are ready.
+         */
+        void loadPendingSprites();
+
         BeingInfo *mInfo;
 
         int mActionTime;      /**< Time spent in current action */
@@ -554,6 +562,19 @@ class Being : public ActorSprite, public ConfigListener, public Mana::Listener
         std::vector<std::string> mSpriteColors;
         Gender mGender;
 
+        /**
+         * An equipment sprite waiting for its images to be decoded.
+         */
+        struct PendingSprite
+        {
+            std::string path;
+            int id;
+            std::string color;
+            bool isWeapon;
+        };
+
+        std::map<unsigned int, PendingSprite> mPendingSprites;
+
         // Character guild information
         std::map<int, Guild*> mGuilds;
         Party *mParty;
@@ -0,0 +1,569 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+
+#include "actorspritemanager.h"
+#include "being.h"
+#include "client.h"
+#include "configuration.h"
+#include "defaults.h"
+#include "graphics.h"
+#include "localplayer.h"
+#include "log.h"
+#include "map.h"
+#include "particle.h"
+
+#include "gui/viewport.h"
+
+#include "net/net.h"
+
+#include "resources/colordb.h"
+#include "resources/image.h"
+#include "resources/itemdb.h"
+#include "resources/mapreader.h"
+#include "resources/monsterdb.h"
+#include "resources/resourcemanager.h"
+
+#include "utils/profiler.h"
+#include "utils/stringutils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+extern Viewport *viewport;
+extern Particle *particleEngine;
+
+/** The logic runs at 100 ticks per second, so frames are at 50 fps. */
+static const int TICKS_PER_FRAME = 2;
+
+/** The number of frames it takes the camera to go round the map. */
+static const int CAMERA_LOOP_FRAMES = 1500;
+
+/** The number of frames it takes a monster to walk its circle. */
+static const int WALK_LOOP_FRAMES = 200;
+
+static const float PI = 3.14159265f;
+
+/** How far away in tiles the destinations of searched paths can be. */
+static const int PATH_RANGE = 20;
+
+/** The number of frames after which particle effects are placed anew. */
+static const int EFFECT_LOOP_FRAMES = 200;
+
+/**
+ * Returns the number of bytes currently allocated from the heap, or -1 when
+ * that is unknown on this platform.
+ */
+static long heapInUse()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    return (long) mallinfo2().uordblks;
+#else
+    return (long) mallinfo().uordblks;
+#endif
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Returns the value below which the given percentage of the sorted values
+ * lies.
+ */
+static int percentile(const std::vector<int> &sorted, int percent)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+Benchmark::Benchmark(const std::string &mapName, int beings, int frames,
+                     int paths, int effects):
+    mMapName(mapName),
+    mBeingCount(std::max(beings, 0)),
+    mFrameCount(std::max(frames, 1)),
+    mPathCount(std::max(paths, 0)),
+    mEffectCount(std::max(effects, 0)),
+    mMap(0),
+    mHeapBefore(-1),
+    mHeapAfter(-1)
+{
+}
+
+Benchmark::~Benchmark()
+{
+    delete actorSpriteManager;
+    actorSpriteManager = 0;
+    delete player_node;
+    player_node = 0;
+    delete particleEngine;
+    particleEngine = 0;
+    delete viewport;
+    viewport = 0;
+    delete mMap;
+}
+
+int Benchmark::run()
+{
+    if (mPathCount > 0)
+        return runPaths();
+    if (mEffectCount > 0)
+        return runParticles();
+
+    logger->log("Benchmark: rendering %s with %d beings for %d frames",
+                mMapName.c_str(), mBeingCount, mFrameCount);
+
+    // Beings need the handlers of a netcode, without being connected. The
+    // Manaserv netcode leaves moving them to us.
+    Net::loadNetcode(ServerInfo::MANASERV);
+
+    paths.init("paths.xml", true);
+    paths.setDefaultValues(getPathsDefaults());
+
+    ColorDB::load();
+    ItemDB::load();
+    Being::load();
+    MonsterDB::load();
+    ActorSprite::load();
+
+    // Particle effects use random numbers
+    srand(1);
+
+    actorSpriteManager = new ActorSpriteManager;
+    particleEngine = new Particle(NULL);
+    particleEngine->setupEngine();
+
+    viewport = new Viewport;
+    viewport->setDimension(gcn::Rectangle(0, 0, graphics->getWidth(),
+                                          graphics->getHeight()));
+
+    // The camera follows the player, which follows the scripted path
+    player_node = new LocalPlayer(1, 0);
+    actorSpriteManager->setPlayer(player_node);
+
+    if (!loadMap())
+        return 1;
+
+    actorSpriteManager->setMap(mMap);
+    particleEngine->setMap(mMap);
+    viewport->setMap(mMap);
+    mMap->initializeParticleEffects(particleEngine);
+
+    spawnBeings();
+
+    const int frameSection = Profiler::section("Frame");
+    const int logicSection = Profiler::section("Benchmark logic");
+    const int drawSection = Profiler::section("Viewport::draw");
+    const int updateScreenSection = Profiler::section("updateScreen");
+
+    Profiler::acquire();
+    mFrameTimes.reserve(mFrameCount);
+    mDrawCalls.reserve(mFrameCount);
+    mHeapBefore = heapInUse();
+
+    for (int frame = 0; frame < mFrameCount; ++frame)
+    {
+        Profiler::endFrame();
+
+        // Allow closing the window when it is visible
+        SDL_Event event;
+        while (SDL_PollEvent(&event))
+        {
+            if (event.type == SDL_QUIT)
+            {
+                logger->log("Benchmark: interrupted");
+                return 1;
+            }
+        }
+
+        Graphics::resetDrawCalls();
+        const int64_t start = Profiler::now();
+        {
+            ProfileScope frameScope(frameSection);
+            {
+                ProfileScope scope(logicSection);
+                updateScene(frame);
+                for (int tick = 0; tick < TICKS_PER_FRAME; ++tick)
+                {
+                    nextTick(0, 0);
+                    ActorSprite::actorLogic();
+                    actorSpriteManager->logic();
+                    particleEngine->update();
+                    mMap->update();
+                }
+            }
+            {
+                ProfileScope scope(drawSection);
+                viewport->draw(graphics);
+            }
+            ProfileScope scope(updateScreenSection);
+            graphics->updateScreen();
+        }
+
+        mFrameTimes.push_back((int) (Profiler::now() - start));
+        mDrawCalls.push_back(Graphics::getDrawCalls());
+    }
+
+    mHeapAfter = heapInUse();
+    Profiler::endFrame();
+
+    printResults();
+    return 0;
+}
+
+bool Benchmark::loadMap()
+{
+    std::string fullMap = paths.getValue("maps", "maps/") + mMapName + ".tmx";
+    ResourceManager *resman = ResourceManager::getInstance();
+    if (!resman->exists(fullMap))
+        fullMap += ".gz";
+
+    mMap = MapReader::readMap(fullMap);
+    if (!mMap)
+    {
+        logger->log("Benchmark: error while loading %s", fullMap.c_str());
+        fprintf(stderr, "Could not load map %s\n", fullMap.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+int Benchmark::runPaths()
+{
+    logger->log("Benchmark: searching %d paths on %s",
+                mPathCount, mMapName.c_str());
+
+    paths.init("paths.xml", true);
+    paths.setDefaultValues(getPathsDefaults());
+
+    if (!loadMap())
+        return 1;
+
+    srand(1);
+
+    const int width = mMap->getWidth();
+    const int height = mMap->getHeight();
+
+    std::vector<int> searchTimes;
+    searchTimes.reserve(mPathCount);
+    int found = 0;
+    long totalNodes = 0;
+
+    for (int i = 0; i < mPathCount; ++i)
+    {
+        // Prefer walkable tiles, but don't search forever on closed maps
+        int startX = 0, startY = 0, destX = 0, destY = 0;
+        for (int attempt = 0; attempt < 100; ++attempt)
+        {
+            startX = rand() % width;
+            startY = rand() % height;
+            destX = startX + rand() % (PATH_RANGE * 2 + 1) - PATH_RANGE;
+            destY = startY + rand() % (PATH_RANGE * 2 + 1) - PATH_RANGE;
+            if (mMap->getWalk(startX, startY) && mMap->getWalk(destX, destY))
+                break;
+        }
+
+        const int64_t start = Profiler::now();
+        const Path path = mMap->findPixelPath(startX * 32 + 16,
+                                              startY * 32 + 16,
+                                              destX * 32 + 16,
+                                              destY * 32 + 16,
+                                              0, Map::BLOCKMASK_WALL);
+        searchTimes.push_back((int) (Profiler::now() - start));
+
+        if (!path.empty())
+        {
+            ++found;
+            totalNodes += path.size();
+        }
+    }
+
+    std::sort(searchTimes.begin(), searchTimes.end());
+
+    long totalTime = 0;
+    for (unsigned i = 0; i < searchTimes.size(); ++i)
+        totalTime += searchTimes[i];
+
+    std::vector<std::string> lines;
+    lines.push_back(strprintf("Path finding on %s (%dx%d): %d searches, "
+                              "%d paths found, %.1f nodes per path",
+            mMapName.c_str(), width, height, mPathCount, found,
+            found ? (float) totalNodes / found : 0.0f));
+    lines.push_back(strprintf("Search time (us): median %d, p90 %d, p99 %d, "
+                              "max %d, total %ld",
+            percentile(searchTimes, 50), percentile(searchTimes, 90),
+            percentile(searchTimes, 99), searchTimes.back(), totalTime));
+
+    for (unsigned i = 0; i < lines.size(); ++i)
+    {
+        printf("%s\n", lines[i].c_str());
+        logger->log("%s", lines[i].c_str());
+    }
+
+    return 0;
+}
+
+int Benchmark::runParticles()
+{
+    logger->log("Benchmark: updating %d particle effects on %s for %d frames",
+                mEffectCount, mMapName.c_str(), mFrameCount);
+
+    paths.init("paths.xml", true);
+    paths.setDefaultValues(getPathsDefaults());
+
+    if (!loadMap())
+        return 1;
+
+    // Both runs see the same effects, once with every particle as its own
+    // object and once with plain image particles batched
+    std::vector<int> objectTimes, objectCounts;
+    std::vector<int> batchedTimes, batchedCounts;
+    timeParticles(false, objectTimes, objectCounts);
+    timeParticles(true, batchedTimes, batchedCounts);
+
+    long objectTotal = 0, batchedTotal = 0;
+    for (unsigned i = 0; i < objectTimes.size(); ++i)
+        objectTotal += objectTimes[i];
+    for (unsigned i = 0; i < batchedTimes.size(); ++i)
+        batchedTotal += batchedTimes[i];
+
+    std::vector<std::string> lines;
+    lines.push_back(strprintf("Particles on %s: %d effects, %d frames",
+            mMapName.c_str(), mEffectCount, mFrameCount));
+    lines.push_back(strprintf("%-24s %10s %10s", "", "objects", "batched"));
+    lines.push_back(strprintf("%-24s %10d %10d", "Particles, median",
+            percentile(objectCounts, 50), percentile(batchedCounts, 50)));
+    lines.push_back(strprintf("%-24s %10d %10d", "Particles, max",
+            objectCounts.back(), batchedCounts.back()));
+    lines.push_back(strprintf("%-24s %10d %10d", "Update time (us), median",
+            percentile(objectTimes, 50), percentile(batchedTimes, 50)));
+    lines.push_back(strprintf("%-24s %10d %10d", "Update time (us), p90",
+            percentile(objectTimes, 90), percentile(batchedTimes, 90)));
+    lines.push_back(strprintf("%-24s %10d %10d", "Update time (us), p99",
+            percentile(objectTimes, 99), percentile(batchedTimes, 99)));
+    lines.push_back(strprintf("%-24s %10d %10d", "Update time (us), max",
+            objectTimes.back(), batchedTimes.back()));
+    lines.push_back(strprintf("%-24s %10ld %10ld", "Update time (us), total",
+            objectTotal, batchedTotal));
+
+    for (unsigned i = 0; i < lines.size(); ++i)
+    {
+        printf("%s\n", lines[i].c_str());
+        logger->log("%s", lines[i].c_str());
+    }
+
+    return 0;
+}
+
+void Benchmark::timeParticles(bool batching,
+                              std::vector<int> &updateTimes,
+                              std::vector<int> &particleCounts)
+{
+    srand(1);
+
+    particleEngine = new Particle(NULL);
+    particleEngine->setupEngine();
+    particleEngine->setMap(mMap);
+    Particle::batching = batching;
+
+    std::vector<Particle*> effects;
+    updateTimes.reserve(mFrameCount);
+    particleCounts.reserve(mFrameCount);
+
+    for (int frame = 0; frame < mFrameCount; ++frame)
+    {
+        if (frame % EFFECT_LOOP_FRAMES == 0)
+            spawnEffects(effects);
+
+        const int64_t start = Profiler::now();
+        for (int tick = 0; tick < TICKS_PER_FRAME; ++tick)
+            particleEngine->update();
+        updateTimes.push_back((int) (Profiler::now() - start));
+        particleCounts.push_back(Particle::particleCount);
+    }
+
+    // Deletes the effects along with the engine
+    delete particleEngine;
+    particleEngine = 0;
+
+    std::sort(updateTimes.begin(), updateTimes.end());
+    std::sort(particleCounts.begin(), particleCounts.end());
+}
+
+void Benchmark::spawnEffects(std::vector<Particle*> &effects)
+{
+    for (unsigned i = 0; i < effects.size(); ++i)
+        effects[i]->kill();
+    effects.clear();
+
+    const std::string effectFile = paths.getStringValue("particles") +
+                                   paths.getStringValue("levelUpEffectFile");
+    const int tileWidth = mMap->getTileWidth();
+    const int tileHeight = mMap->getTileHeight();
+
+    for (int i = 0; i < mEffectCount; ++i)
+    {
+        const int x = rand() % mMap->getWidth();
+        const int y = rand() % mMap->getHeight();
+        Particle *effect = particleEngine->addEffect(effectFile,
+                x * tileWidth + tileWidth / 2,
+                y * tileHeight + tileHeight / 2);
+
+        // Kept until killed, so the pointer stays valid for the next round
+        if (effect)
+        {
+            effect->disableAutoDelete();
+            effects.push_back(effect);
+        }
+    }
+}
+
+void Benchmark::spawnBeings()
+{
+    const std::vector<int> monsterIds = MonsterDB::getIds();
+    if (monsterIds.empty())
+    {
+        logger->log("Benchmark: no monsters known, not spawning any");
+        return;
+    }
+
+    const int tileWidth = mMap->getTileWidth();
+    const int tileHeight = mMap->getTileHeight();
+
+    for (int i = 0; i < mBeingCount; ++i)
+    {
+        // Prefer walkable tiles, but don't search forever on closed maps
+        int x = 0, y = 0;
+        for (int attempt = 0; attempt < 100; ++attempt)
+        {
+            x = rand() % mMap->getWidth();
+            y = rand() % mMap->getHeight();
+            if (mMap->getWalk(x, y))
+                break;
+        }
+
+        const int monsterId = monsterIds[i % monsterIds.size()];
+        Being *being = actorSpriteManager->createBeing(i + 2,
+                                                       ActorSprite::MONSTER,
+                                                       monsterId);
+
+        Walker walker;
+        walker.being = being;
+        walker.center = Vector(x * tileWidth + tileWidth / 2,
+                               y * tileHeight + tileHeight / 2);
+        walker.radius = (float) (tileWidth * (1 + rand() % 3));
+        walker.phase = (rand() % 360) * PI / 180;
+        mWalkers.push_back(walker);
+
+        being->setPosition(walker.center);
+        being->setAction(Being::MOVE);
+    }
+}
+
+void Benchmark::updateScene(int frame)
+{
+    const float mapWidth = mMap->getWidth() * mMap->getTileWidth();
+    const float mapHeight = mMap->getHeight() * mMap->getTileHeight();
+
+    // The camera goes round the map along a figure of eight
+    const float t = 2 * PI * (frame % CAMERA_LOOP_FRAMES) / CAMERA_LOOP_FRAMES;
+    player_node->setPosition(mapWidth / 2 + mapWidth * 0.4f * sin(t),
+                             mapHeight / 2 + mapHeight * 0.4f * sin(2 * t));
+
+    const float walkAngle = 2 * PI * (frame % WALK_LOOP_FRAMES) /
+                            WALK_LOOP_FRAMES;
+
+    for (std::vector<Walker>::iterator it = mWalkers.begin(),
+         it_end = mWalkers.end(); it != it_end; ++it)
+    {
+        const float angle = walkAngle + it->phase;
+        it->being->setPosition(it->center.x + it->radius * cos(angle),
+                               it->center.y + it->radius * sin(angle));
+
+        // Walking counter-clockwise, so the direction is the tangent
+        const float dx = -sin(angle);
+        const float dy = cos(angle);
+        if (std::abs(dx) > std::abs(dy))
+            it->being->setDirection(dx > 0 ? Being::RIGHT : Being::LEFT);
+        else
+            it->being->setDirection(dy > 0 ? Being::DOWN : Being::UP);
+    }
+}
+
+void Benchmark::printResults() const
+{
+    std::vector<int> frameTimes = mFrameTimes;
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    std::vector<int> drawCalls = mDrawCalls;
+    std::sort(drawCalls.begin(), drawCalls.end());
+
+    long totalDrawCalls = 0;
+    for (unsigned i = 0; i < drawCalls.size(); ++i)
+        totalDrawCalls += drawCalls[i];
+
+    std::vector<std::string> lines;
+    lines.push_back(strprintf("Benchmark of %s: %d beings, %d frames, %s",
+            mMapName.c_str(), (int) mWalkers.size(), mFrameCount,
+            Image::getLoadAsOpenGL() ? "OpenGL" : "SDL"));
+    lines.push_back(strprintf("Frame time (ms): median %.2f, p90 %.2f, "
+                              "p99 %.2f, max %.2f",
+            percentile(frameTimes, 50) / 1000.0f,
+            percentile(frameTimes, 90) / 1000.0f,
+            percentile(frameTimes, 99) / 1000.0f,
+            frameTimes.back() / 1000.0f));
+    lines.push_back(strprintf("Draw calls per frame: mean %.1f, median %d, "
+                              "max %d",
+            (float) totalDrawCalls / drawCalls.size(),
+            percentile(drawCalls, 50), drawCalls.back()));
+
+    if (mHeapBefore >= 0)
+    {
+        lines.push_back(strprintf("Heap growth while rendering: %ld bytes",
+                                  mHeapAfter - mHeapBefore));
+    }
+
+    lines.push_back("Sections over the last frames (ms, median/p95/max):");
+    for (int i = 0; i < Profiler::getSectionCount(); ++i)
+    {
+        const Profiler::Stats stats = Profiler::getStats(i);
+        if (stats.max == 0.0f)
+            continue;
+
+        lines.push_back(strprintf("  %-24s %7.2f %7.2f %7.2f",
+                Profiler::getSectionName(i).c_str(),
+                stats.median, stats.p95, stats.max));
+    }
+
+    for (unsigned i = 0; i < lines.size(); ++i)
+    {
+        printf("%s\n", lines[i].c_str());
+        logger->log("%s", lines[i].c_str());
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "vector.h"
+
+#include <string>
+#include <vector>
+
+class Being;
+class Map;
+class Particle;
+
+/**
+ * Renders a map crowded with monsters for a fixed number of frames, while
+ * the camera follows a scripted path, and prints how long the frames took.
+ *
+ * Nothing depends on a server or on timing: the logic is advanced by a fixed
+ * number of ticks each frame and random numbers are seeded the same way on
+ * each run, so results can be compared between builds. The graphics backend
+ * is the one the client would use, so running once with and once without
+ * <code>--no-opengl</code> compares both. The software renderer also works
+ * with <code>SDL_VIDEODRIVER=dummy</code>.
+ *
+ * When a number of paths is given, nothing is rendered. Instead, that many
+ * paths between random walkable tiles of the map are searched, the way
+ * clicking on the map would.
+ *
+ * When a number of particle effects is given, nothing is rendered either.
+ * That many level up effects are placed on the map and only the updates of
+ * the particle engine are timed, once with every particle as a separate
+ * object and once with batched image particles, side by side.
+ */
+class Benchmark
+{
+    public:
+        /**
+         * @param mapName the map to render, like the server would name it
+         * @param beings  the number of monsters to spawn
+         * @param frames  the number of frames to render
+         * @param paths   the number of paths to search instead of rendering
+         * @param effects the number of particle effects to update instead of
+         *                rendering
+         */
+        Benchmark(const std::string &mapName, int beings, int frames,
+                  int paths = 0, int effects = 0);
+
+        ~Benchmark();
+
+        /**
+         * Runs the benchmark and prints the results.
+         *
+         * @return the exit code for the client
+         */
+        int run();
+
+    private:
+        bool loadMap();
+
+        /**
+         * Searches paths on the map and prints how long that took.
+         */
+        int runPaths();
+
+        /**
+         * Updates particle effects and prints how long that took.
+         */
+        int runParticles();
+
+        /**
+         * Updates particle effects with or without batching, and returns the
+         * sorted update times and particle counts of each frame.
+         */
+        void timeParticles(bool batching,
+                           std::vector<int> &updateTimes,
+                           std::vector<int> &particleCounts);
+
+        /**
+         * Kills the effects placed before and places new ones at random
+         * spots of the map.
+         */
+        void spawnEffects(std::vector<Particle*> &effects);
+
+        void spawnBeings();
+
+        /**
+         * Moves the beings and the camera to where they are in the given
+         * frame.
+         */
+        void updateScene(int frame);
+
+        void printResults() const;
+
+        /**
+         * A monster walking in circles around the place it was spawned.
+         */
+        struct Walker
+        {
+            Being *being;
+            Vector center;
+            float radius;
+            float phase;
+        };
+
+        std::string mMapName;
+        int mBeingCount;
+        int mFrameCount;
+        int mPathCount;
+        int mEffectCount;
+
+        Map *mMap;
+        std::vector<Walker> mWalkers;
+
+        std::vector<int> mFrameTimes;       /**< In microseconds. */
+        std::vector<int> mDrawCalls;
+        long mHeapBefore;
+        long mHeapAfter;
+};
+
+#endif // BENCHMARK_H
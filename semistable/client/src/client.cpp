@@ -22,6 +22,8 @@
 #include "client.h"
 #include "main.h"
 
+#include "actor.h"
+#include "benchmark.h"
 #include "chatlog.h"
 #include "configuration.h"
 #include "emoteshortcut.h"
@@ -77,6 +79,7 @@
 
 #include "utils/gettext.h"
 #include "utils/mkdir.h"
+#include "utils/profiler.h"
 #include "utils/stringutils.h"
 
 #ifdef __APPLE__
@@ -128,6 +131,7 @@ void ErrorListener::action(const gcn::ActionEvent &)
 }
 
 volatile int tick_time;       /**< Tick counter */
+volatile Uint32 tick_started = 0; /**< SDL time at which the tick started */
 volatile int fps = 0;         /**< Frames counted in the last second */
 volatile int frame_count = 0; /**< Counts the frames during one second */
 volatile int cur_time;
@@ -142,6 +146,7 @@ Uint32 nextTick(Uint32 interval, void *param)
     tick_time++;
     if (tick_time == MAX_TICK_VALUE)
         tick_time = 0;
+    tick_started = SDL_GetTicks();
     return interval;
 }
 
@@ -418,7 +423,10 @@ Client::Client(const Options &options):
 
     // Initialize logic and seconds counters
     tick_time = 0;
-    mLogicCounterId = SDL_AddTimer(MILLISECONDS_IN_A_TICK, nextTick, NULL);
+
+    // The benchmark advances the logic ticks itself, to be reproducible
+    if (mOptions.benchmarkMap.empty())
+        mLogicCounterId = SDL_AddTimer(MILLISECONDS_IN_A_TICK, nextTick, NULL);
     mSecondsCounterId = SDL_AddTimer(1000, nextSecond, NULL);
 
     // Initialize frame limiting
@@ -472,18 +480,43 @@ Client::~Client()
 
 int Client::exec()
 {
+    if (!mOptions.benchmarkMap.empty())
+    {
+        Benchmark benchmark(mOptions.benchmarkMap,
+                            mOptions.benchmarkBeings,
+                            mOptions.benchmarkFrames,
+                            mOptions.benchmarkPaths,
+                            mOptions.benchmarkParticles);
+        return benchmark.run();
+    }
+
     int lastTickTime = tick_time;
 
     Game *game = 0;
     SDL_Event event;
 
+    const int frameSection = Profiler::section("Frame");
+    const int inputSection = Profiler::section("handleInput");
+    const int networkSection = Profiler::section("flushNetwork");
+    const int guiLogicSection = Profiler::section("gui->logic");
+    const int gameLogicSection = Profiler::section("game->logic");
+    const int guiDrawSection = Profiler::section("gui->draw");
+    const int updateScreenSection = Profiler::section("updateScreen");
+
+    BoolOption interpolateMovement(config, "interpolatemovement");
+
     while (mState != STATE_EXIT)
     {
+        // Finish the measurements of the previous frame
+        Profiler::endFrame();
+        ProfileScope frameScope(frameSection);
+
         bool handledEvents = false;
 
         if (game)
         {
             // Let the game handle the events while it is active
+            ProfileScope scope(inputSection);
             game->handleInput();
         }
         else
@@ -508,13 +541,25 @@ int Client::exec()
         }
 
         if (Net::getGeneralHandler())
+        {
+            ProfileScope scope(networkSection);
             Net::getGeneralHandler()->flushNetwork();
+        }
+
+        // Finish loading the images decoded in the background
+        ResourceManager::getInstance()->processDecodedImages();
 
         while (get_elapsed_time(lastTickTime) > 0)
         {
-            gui->logic();
+            {
+                ProfileScope scope(guiLogicSection);
+                gui->logic();
+            }
             if (game)
+            {
+                ProfileScope scope(gameLogicSection);
                 game->logic();
+            }
 
             ++lastTickTime;
         }
@@ -526,7 +571,26 @@ int Client::exec()
         if (SDL_GetAppState() & SDL_APPACTIVE)
         {
             frame_count++;
-            gui->draw();
+
+            // Draw moving actors between where they were at the last two
+            // ticks, so that they don't stutter when frames and ticks
+            // don't line up
+            if (interpolateMovement)
+            {
+                const float elapsed = SDL_GetTicks() - tick_started;
+                Actor::setInterpolation(
+                        std::min(elapsed / MILLISECONDS_IN_A_TICK, 1.0f));
+            }
+            else
+            {
+                Actor::setInterpolation(1.0f);
+            }
+
+            {
+                ProfileScope scope(guiDrawSection);
+                gui->draw();
+            }
+            ProfileScope scope(updateScreenSection);
             graphics->updateScreen();
         }
         else
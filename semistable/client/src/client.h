@@ -67,6 +67,12 @@ extern LoginData loginData;
  */
 int get_elapsed_time(int start_time);
 
+/**
+ * Advances the tick counter. Called by the logic timer, except in benchmark
+ * mode, where the benchmark advances the ticks itself.
+ */
+Uint32 nextTick(Uint32 interval, void *param);
+
 /**
  * All client states.
  */
@@ -128,7 +134,11 @@ public:
             skipUpdate(false),
             chooseDefault(false),
             noOpenGL(false),
-            serverPort(0)
+            serverPort(0),
+            benchmarkBeings(200),
+            benchmarkFrames(1000),
+            benchmarkPaths(0),
+            benchmarkParticles(0)
         {}
 
         bool printHelp;
@@ -149,6 +159,12 @@ public:
 
         std::string serverName;
         short serverPort;
+
+        std::string benchmarkMap;
+        int benchmarkBeings;
+        int benchmarkFrames;
+        int benchmarkPaths;
+        int benchmarkParticles;
     };
 
     Client(const Options &options);
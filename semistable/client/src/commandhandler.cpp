@@ -23,6 +23,7 @@
 
 #include "channelmanager.h"
 #include "channel.h"
+#include "client.h"
 #include "game.h"
 #include "localplayer.h"
 #include "playerrelations.h"
@@ -37,9 +38,11 @@
 #include "net/partyhandler.h"
 
 #include "utils/gettext.h"
+#include "utils/profiler.h"
 #include "utils/stringutils.h"
 
-CommandHandler::CommandHandler()
+CommandHandler::CommandHandler():
+    mTracing(false)
 {}
 
 void CommandHandler::handleCommand(const std::string &command, ChatTab *tab)
@@ -120,6 +123,10 @@ void CommandHandler::handleCommand(const std::string &command, ChatTab *tab)
     {
         handlePresent(args, tab);
     }
+    else if (type == "trace")
+    {
+        handleTrace(args, tab);
+    }
     else if (type == "away")
     {
         handleAway(args, tab);
@@ -189,6 +196,7 @@ void CommandHandler::handleHelp(const std::string &args, ChatTab *tab)
                        "toggles the chat log"));
         tab->chatLog(_("/present > Get list of players present "
                        "(sent to chat log, if logging)"));
+        tab->chatLog(_("/trace > Save the timings of the last frames"));
 
         tab->chatLog(_("/announce > Global announcement (GM only)"));
 
@@ -304,6 +312,16 @@ void CommandHandler::handleHelp(const std::string &args, ChatTab *tab)
         tab->chatLog(_("Command: /toggle"));
         tab->chatLog(_("This command displays the return toggle status."));
     }
+    else if (args == "trace")
+    {
+        tab->chatLog(_("Command: /trace <filename>"));
+        tab->chatLog(_("This command saves the timings of the last frames to "
+                       "<filename> in the local data directory, which can be "
+                       "viewed with chrome://tracing."));
+        tab->chatLog(_("Timings are recorded while the debug window is open, "
+                       "or from the first time this command is used until "
+                       "they are saved."));
+    }
     else if (args == "unignore")
     {
         tab->chatLog(_("Command: /unignore <player>"));
@@ -482,6 +500,45 @@ void CommandHandler::handlePresent(const std::string &args, ChatTab *tab)
     chatWindow->doPresent();
 }
 
+void CommandHandler::handleTrace(const std::string &args, ChatTab *tab)
+{
+    std::string fileName = args;
+    trim(fileName);
+    if (fileName.empty())
+        fileName = "trace.json";
+
+    // Traces are only written to the local data directory
+    if (fileName.find_first_of("/\\:") != std::string::npos ||
+        fileName == "." || fileName == "..")
+    {
+        tab->chatLog(_("Please give a file name without a directory."));
+        return;
+    }
+
+    if (!Profiler::isEnabled())
+    {
+        Profiler::acquire();
+        mTracing = true;
+        tab->chatLog(_("Recording frame timings. Use /trace again to save "
+                       "them."));
+        return;
+    }
+
+    const std::string file = Client::getLocalDataDirectory() + "/" + fileName;
+
+    if (Profiler::exportTrace(file))
+        tab->chatLog(strprintf(_("Frame timings saved to %s."), file.c_str()));
+    else
+        tab->chatLog(_("Failed to save frame timings."));
+
+    // The next /trace records anew, unless the debug window is open
+    if (mTracing)
+    {
+        Profiler::release();
+        mTracing = false;
+    }
+}
+
 void CommandHandler::handleIgnore(const std::string &args, ChatTab *tab)
 {
     if (args.empty())
@@ -133,6 +133,11 @@ class CommandHandler
          */
         void handlePresent(const std::string &args, ChatTab *tab);
 
+        /**
+         * Handle a trace command.
+         */
+        void handleTrace(const std::string &args, ChatTab *tab);
+
         /**
          * Handle an ignore command.
          */
@@ -147,6 +152,8 @@ class CommandHandler
          * Handle away command.
          */
         void handleAway(const std::string &args, ChatTab *tab);
+
+        bool mTracing;          /**< Whether /trace acquired the profiler. */
 };
 
 extern CommandHandler *commandHandler;
@@ -22,6 +22,7 @@
 #ifndef CONFIGURATION_H
 #define CONFIGURATION_H
 
+#include "configlistener.h"
 #include "utils/stringutils.h"
 #include "defaults.h"
 
@@ -32,7 +33,6 @@
 #include <map>
 #include <string>
 
-class ConfigListener;
 class ConfigurationObject;
 
 /**
@@ -272,6 +272,74 @@ class Configuration : public ConfigurationObject
         DefaultsData *mDefaultsData;   /**< Defaults of value for a given key */
 };
 
+/**
+ * Handle to a configuration option, for code that reads the option often.
+ * The key is looked up and the value parsed once, after which the value is
+ * kept up to date by listening for changes to the option.
+ *
+ * Handles should only be created once the configuration has been loaded,
+ * which is why they are usually members or function-local statics.
+ *
+ * \param T The type of the option value: int, float, bool or std::string
+ */
+template <class T>
+class ConfigOption : public ConfigListener
+{
+    public:
+        ConfigOption(Configuration &configuration, const std::string &key):
+            mConfiguration(configuration),
+            mKey(key)
+        {
+            update();
+            mConfiguration.addListener(mKey, this);
+        }
+
+        ~ConfigOption()
+        {
+            mConfiguration.removeListener(mKey, this);
+        }
+
+        const T &get() const
+        { return mValue; }
+
+        operator const T &() const
+        { return mValue; }
+
+        void optionChanged(const std::string &)
+        { update(); }
+
+    private:
+        ConfigOption(const ConfigOption &);
+        ConfigOption &operator=(const ConfigOption &);
+
+        void update();
+
+        Configuration &mConfiguration;
+        const std::string mKey;
+        T mValue;
+};
+
+template <>
+inline void ConfigOption<int>::update()
+{ mValue = mConfiguration.getIntValue(mKey); }
+
+template <>
+inline void ConfigOption<float>::update()
+{ mValue = mConfiguration.getFloatValue(mKey); }
+
+template <>
+inline void ConfigOption<bool>::update()
+{ mValue = mConfiguration.getBoolValue(mKey); }
+
+template <>
+inline void ConfigOption<std::string>::update()
+{ mValue = mConfiguration.getStringValue(mKey); }
+
+typedef ConfigOption<int> IntOption;
+typedef ConfigOption<float> FloatOption;
+typedef ConfigOption<bool> BoolOption;
+typedef ConfigOption<std::string> StringOption;
+
 extern Configuration branding;
 extern Configuration config;
 extern Configuration paths;
@@ -80,6 +80,7 @@ DefaultsData* getConfigDefaults()
     AddDEF(configData, "particleMaxCount", 3000);
     AddDEF(configData, "particleFastPhysics", 0);
     AddDEF(configData, "particleEmitterSkip", 1);
+    AddDEF(configData, "particleBatching", true);
     AddDEF(configData, "particleeffects", true);
     AddDEF(configData, "logToStandardOut", false);
     AddDEF(configData, "opengl", false);
@@ -94,6 +95,7 @@ DefaultsData* getConfigDefaults()
     AddDEF(configData, "username", "");
     AddDEF(configData, "lastCharacter", "");
     AddDEF(configData, "fpslimit", 60);
+    AddDEF(configData, "interpolatemovement", true);
     AddDEF(configData, "updatehost", "");
     AddDEF(configData, "screenshotDirectory", "");
     AddDEF(configData, "useScreenshotDirectorySuffix", true);
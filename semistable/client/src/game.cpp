@@ -82,6 +82,7 @@
 
 #include "utils/gettext.h"
 #include "utils/mkdir.h"
+#include "utils/profiler.h"
 
 #include <guichan/exception.hpp>
 #include <guichan/focushandler.hpp>
@@ -345,11 +346,27 @@ void Game::logic()
     handleInput();
 
     // Handle all necessary game logic
-    ActorSprite::actorLogic();
-    actorSpriteManager->logic();
-    particleEngine->update();
+    static const int actorSection = Profiler::section("Actor logic");
+    static const int particleSection = Profiler::section("Particle update");
+    static const int mapSection = Profiler::section("Map::update");
+
     if (mCurrentMap)
+        mCurrentMap->saveActorPositions();
+
+    {
+        ProfileScope scope(actorSection);
+        ActorSprite::actorLogic();
+        actorSpriteManager->logic();
+    }
+    {
+        ProfileScope scope(particleSection);
+        particleEngine->update();
+    }
+    if (mCurrentMap)
+    {
+        ProfileScope scope(mapSection);
         mCurrentMap->update();
+    }
 
     cur_time = time(NULL);
 
@@ -29,6 +29,28 @@
 
 #include <SDL_gfxBlitFunc.h>
 
+/**
+ * A chunk pre-rendered into a single SDL image.
+ */
+class SDLImageChunk : public ImageChunk
+{
+    public:
+        SDLImageChunk(Image *image):
+            mImage(image)
+        {}
+
+        ~SDLImageChunk()
+        { delete mImage; }
+
+        Image *getImage() const
+        { return mImage; }
+
+    private:
+        Image *mImage;
+};
+
+int Graphics::mDrawCalls = 0;
+
 Graphics::Graphics():
     mWidth(0),
     mHeight(0),
@@ -160,6 +182,7 @@ bool Graphics::drawRescaledImage(Image *image, int srcX, int srcY,
     srcRect.h = height;
 
     returnValue = !(SDL_BlitSurface(tmpImage->mSDLSurface, &srcRect, mTarget, &dstRect) < 0);
+    ++mDrawCalls;
 
     delete tmpImage;
 
@@ -186,7 +209,10 @@ bool Graphics::drawImage(Image *image, int srcX, int srcY, int dstX, int dstY,
     srcRect.w = width;
     srcRect.h = height;
 
-    if (mBlitMode == BLIT_NORMAL)
+    ++mDrawCalls;
+
+    // The SDL_gfx blitter only handles surfaces with an alpha channel
+    if (mBlitMode == BLIT_NORMAL || !image->mHasAlphaChannel)
         return !(SDL_BlitSurface(image->mSDLSurface, &srcRect, mTarget, &dstRect) < 0);
     else
         return !(SDL_gfxBlitRGBA(image->mSDLSurface, &srcRect, mTarget, &dstRect) < 0);
@@ -230,7 +256,11 @@ void Graphics::drawImagePattern(Image *image, int x, int y, int w, int h)
             srcRect.x = srcX; srcRect.y = srcY;
             srcRect.w = dw;   srcRect.h = dh;
 
-            SDL_BlitSurface(image->mSDLSurface, &srcRect, mTarget, &dstRect);
+            if (mBlitMode == BLIT_NORMAL || !image->mHasAlphaChannel)
+                SDL_BlitSurface(image->mSDLSurface, &srcRect, mTarget, &dstRect);
+            else
+                SDL_gfxBlitRGBA(image->mSDLSurface, &srcRect, mTarget, &dstRect);
+            ++mDrawCalls;
         }
     }
 }
@@ -271,12 +301,23 @@ void Graphics::drawRescaledImagePattern(Image *image, int x, int y,
             srcRect.w = dw;   srcRect.h = dh;
 
             SDL_BlitSurface(tmpImage->mSDLSurface, &srcRect, mTarget, &dstRect);
+            ++mDrawCalls;
         }
     }
 
     delete tmpImage;
 }
 
+void Graphics::drawImageParts(Image *image, const ImagePart *parts, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const ImagePart &part = parts[i];
+        drawImage(image, part.srcX, part.srcY, part.dstX, part.dstY,
+                  part.width, part.height);
+    }
+}
+
 void Graphics::drawImageRect(int x, int y, int w, int h,
                              Image *topLeft, Image *topRight,
                              Image *bottomLeft, Image *bottomRight,
@@ -329,6 +370,53 @@ void Graphics::drawImageRect(int x, int y, int w, int h,
             imgRect.grid[4]);
 }
 
+Graphics *Graphics::beginChunk(int width, int height)
+{
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    int rmask = 0xff000000;
+    int gmask = 0x00ff0000;
+    int bmask = 0x0000ff00;
+    int amask = 0x000000ff;
+#else
+    int rmask = 0x000000ff;
+    int gmask = 0x0000ff00;
+    int bmask = 0x00ff0000;
+    int amask = 0xff000000;
+#endif
+
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height,
+                                                32, rmask, gmask, bmask, amask);
+    if (!surface)
+        return NULL;
+
+    // Draw into the transparent surface while keeping its alpha channel
+    Graphics *chunkGraphics = new Graphics();
+    chunkGraphics->setBlitMode(BLIT_GFX);
+    chunkGraphics->setTarget(surface);
+    chunkGraphics->_beginDraw();
+
+    return chunkGraphics;
+}
+
+ImageChunk *Graphics::endChunk(Graphics *chunkGraphics)
+{
+    SDL_Surface *surface = chunkGraphics->getTarget();
+    delete chunkGraphics;
+
+    Image *image = Image::load(surface);
+    SDL_FreeSurface(surface);
+
+    if (!image)
+        return NULL;
+
+    return new SDLImageChunk(image);
+}
+
+void Graphics::drawChunk(const ImageChunk *chunk, int x, int y)
+{
+    drawImage(static_cast<const SDLImageChunk*>(chunk)->getImage(), x, y);
+}
+
 void Graphics::updateScreen()
 {
     SDL_Flip(mTarget);
@@ -67,6 +67,31 @@ struct ImageRect
     Image *grid[9];
 };
 
+/**
+ * A part of an image along with the position it is drawn at.
+ *
+ * @see Graphics::drawImageParts
+ */
+struct ImagePart
+{
+    int srcX, srcY;
+    int dstX, dstY;
+    int width, height;
+};
+
+/**
+ * A group of images that was pre-rendered by the graphics context, so that it
+ * can be drawn again with a single call. Used to cache the static tiles of
+ * map layers.
+ *
+ * @see Graphics::beginChunk
+ */
+class ImageChunk
+{
+    public:
+        virtual ~ImageChunk() {}
+};
+
 /**
  * A central point of control for graphics.
  */
@@ -157,6 +182,13 @@ class Graphics : public gcn::SDLGraphics
                                int x, int y, int w, int h,
                                int scaledWidth, int scaledHeight);
 
+        /**
+         * Draws several parts of the same image at once, like the glyphs of
+         * a string from a font atlas.
+         */
+        virtual void drawImageParts(Image *image,
+                                    const ImagePart *parts, int count);
+
         /**
          * Draws a rectangle using images. 4 corner images, 4 side images and 1
          * image for the inside.
@@ -187,6 +219,29 @@ class Graphics : public gcn::SDLGraphics
             drawImageRect(area.x, area.y, area.width, area.height, imgRect);
         }
 
+        /**
+         * Starts pre-rendering a chunk of the given size. Everything drawn
+         * through the returned graphics context, relative to its top-left
+         * corner, ends up in the chunk returned by endChunk().
+         *
+         * @return the graphics context to draw the chunk contents with, or
+         *         <code>NULL</code> when the chunk could not be created.
+         */
+        virtual Graphics *beginChunk(int width, int height);
+
+        /**
+         * Finishes the chunk started with beginChunk().
+         *
+         * @param chunkGraphics the context returned by beginChunk().
+         * @return the pre-rendered chunk, owned by the caller.
+         */
+        virtual ImageChunk *endChunk(Graphics *chunkGraphics);
+
+        /**
+         * Draws a chunk created with beginChunk() and endChunk().
+         */
+        virtual void drawChunk(const ImageChunk *chunk, int x, int y);
+
         void setBlitMode(BlitMode mode)
         { mBlitMode = mode; }
 
@@ -216,7 +271,17 @@ class Graphics : public gcn::SDLGraphics
 
         gcn::Font *getFont() const { return mFont; }
 
+        /**
+         * Returns the number of blits or OpenGL draw calls made by all
+         * graphics contexts since the counter was last reset.
+         */
+        static int getDrawCalls() { return mDrawCalls; }
+
+        static void resetDrawCalls() { mDrawCalls = 0; }
+
     protected:
+        static int mDrawCalls;
+
         int mWidth;
         int mHeight;
         int mBpp;
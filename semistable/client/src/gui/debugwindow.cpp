@@ -33,14 +33,18 @@
 
 #include "gui/widgets/label.h"
 #include "gui/widgets/layout.h"
+#include "gui/widgets/textbox.h"
 
 #include "resources/image.h"
 
 #include "utils/gettext.h"
+#include "utils/profiler.h"
 #include "utils/stringutils.h"
 
 DebugWindow::DebugWindow():
-    Window(_("Debug"))
+    Window(_("Debug")),
+    mLastProfilerUpdate(0),
+    mProfiling(false)
 {
     setWindowName("Debug");
     setupWindow->registerWindowForReset(this);
@@ -48,7 +52,7 @@ DebugWindow::DebugWindow():
     setResizable(true);
     setCloseButton(true);
     setSaveVisible(true);
-    setDefaultSize(400, 100, ImageRect::CENTER);
+    setDefaultSize(400, 300, ImageRect::CENTER);
 
 #ifdef USE_OPENGL
     if (Image::getLoadAsOpenGL())
@@ -70,6 +74,10 @@ DebugWindow::DebugWindow():
     mParticleDetailLabel = new Label();
     mAmbientDetailLabel = new Label();
 
+    mProfilerBox = new TextBox;
+    mProfilerBox->setEditable(false);
+    mProfilerBox->setOpaque(false);
+
     place(0, 0, mFPSLabel, 3);
     place(3, 0, mTileMouseLabel);
     place(0, 1, mMusicFileLabel, 3);
@@ -78,6 +86,7 @@ DebugWindow::DebugWindow():
     place(3, 2, mParticleDetailLabel);
     place(0, 3, mMinimapLabel, 4);
     place(3, 3, mAmbientDetailLabel);
+    place(0, 4, mProfilerBox, 4);
 
     loadWindowState();
 }
@@ -122,4 +131,40 @@ void DebugWindow::logic()
                                     Setup_Video::overlayDetailToString()));
 
     mAmbientDetailLabel->adjustSize();
+
+    // Twice a second is often enough to follow the statistics
+    if (get_elapsed_time(mLastProfilerUpdate) >= 500)
+    {
+        mLastProfilerUpdate = tick_time;
+        updateProfilerText();
+    }
+}
+
+void DebugWindow::setVisible(bool visible)
+{
+    Window::setVisible(visible);
+
+    if (visible == mProfiling)
+        return;
+
+    mProfiling = visible;
+    if (visible)
+        Profiler::acquire();
+    else
+        Profiler::release();
+}
+
+void DebugWindow::updateProfilerText()
+{
+    std::string text = _("Frame times (median / 95% / max):");
+
+    for (int i = 0; i < Profiler::getSectionCount(); ++i)
+    {
+        const Profiler::Stats stats = Profiler::getStats(i);
+        text += strprintf("\n%s: %.2f / %.2f / %.2f ms",
+                          Profiler::getSectionName(i).c_str(),
+                          stats.median, stats.p95, stats.max);
+    }
+
+    mProfilerBox->setText(text);
 }
@@ -25,6 +25,7 @@
 #include "gui/widgets/window.h"
 
 class Label;
+class TextBox;
 
 /**
  * The debug window.
@@ -44,11 +45,24 @@ class DebugWindow : public Window
          */
         void logic();
 
+        /**
+         * Enables the profiler while the window is visible.
+         */
+        void setVisible(bool visible);
+
     private:
+        /**
+         * Updates the frame time statistics.
+         */
+        void updateProfilerText();
+
         Label *mMusicFileLabel, *mMapLabel, *mMinimapLabel;
         Label *mTileMouseLabel, *mFPSLabel;
         Label *mParticleCountLabel, *mParticleDetailLabel;
         Label *mAmbientDetailLabel;
+        TextBox *mProfilerBox;
+        int mLastProfilerUpdate;
+        bool mProfiling;        /**< Whether the profiler was acquired. */
 
         std::string mFPSText;
 };
@@ -23,7 +23,6 @@
 #include "gui/emotepopup.h"
 
 #include "animatedsprite.h"
-#include "configuration.h"
 #include "emoteshortcut.h"
 #include "graphics.h"
 #include "localplayer.h"
@@ -60,7 +59,7 @@ EmotePopup::EmotePopup():
     if (!mSelectionImage)
         logger->error("Unable to load selection.png");
 
-    mSelectionImage->setAlpha(config.getFloatValue("guialpha"));
+    mSelectionImage->setAlpha(Theme::instance()->getGuiAlpha());
 
     addMouseListener(this);
     recalculateSize();
@@ -26,63 +26,72 @@
 
 #include "resources/image.h"
 
-#include "utils/stringutils.h"
-
 #include <guichan/exception.hpp>
 
-const unsigned int CACHE_SIZE = 256;
-
-class TextChunk
-{
-    public:
-        TextChunk(const std::string &text, const gcn::Color &color) :
-            img(NULL), text(text), color(color)
-        {
-        }
+#include <algorithm>
 
-        ~TextChunk()
-        {
-            delete img;
-        }
-
-        bool operator==(const TextChunk &chunk) const
-        {
-            return (chunk.text == text && chunk.color == color);
-        }
+/** Size of a glyph atlas page. */
+const int ATLAS_WIDTH = 512;
+const int ATLAS_HEIGHT = 512;
 
-        void generate(TTF_Font *font)
-        {
-            SDL_Color sdlCol;
-            sdlCol.b = color.b;
-            sdlCol.r = color.r;
-            sdlCol.g = color.g;
+/** Number of pages after which the atlas is rebuilt from scratch. */
+const unsigned int MAX_ATLAS_PAGES = 8;
 
-            const char* str = getSafeUtf8String(text);
-            SDL_Surface *surface = TTF_RenderUTF8_Blended(
-                    font, str, sdlCol);
-            delete[] str;
+// Kerning can be queried since SDL_ttf 2.0.10
+#if SDL_TTF_MAJOR_VERSION > 2 || SDL_TTF_MINOR_VERSION > 0 || \
+    SDL_TTF_PATCHLEVEL >= 10
+#define HAVE_TTF_KERNING
+#endif
 
-            if (!surface)
-            {
-                throw "Rendering font to surface failed: " +
-                    std::string(TTF_GetError());
-            }
+/**
+ * Decodes the UTF-8 character at the given position and advances the
+ * position past it. Like SDL_ttf, invalid sequences are not rejected, and
+ * characters outside the basic multilingual plane are replaced.
+ */
+static Uint16 nextCharacter(const std::string &text, std::string::size_type &i)
+{
+    const unsigned char c = text[i++];
+    unsigned int ch;
+    int trailing;
 
-            img = Image::load(surface);
+    if (c >= 0xF0)
+    {
+        ch = c & 0x07;
+        trailing = 3;
+    }
+    else if (c >= 0xE0)
+    {
+        ch = c & 0x0F;
+        trailing = 2;
+    }
+    else if (c >= 0xC0)
+    {
+        ch = c & 0x1F;
+        trailing = 1;
+    }
+    else
+    {
+        return c;
+    }
 
-            SDL_FreeSurface(surface);
-        }
+    for (; trailing > 0 && i < text.length(); --trailing)
+        ch = (ch << 6) | (text[i++] & 0x3F);
 
-        Image *img;
-        std::string text;
-        gcn::Color color;
-};
+    return ch > 0xFFFF ? 0xFFFD : ch;
+}
 
-typedef std::list<TextChunk>::iterator CacheIterator;
+TrueTypeFont::GlyphTable::GlyphTable()
+{
+    for (int i = 0; i < 256; ++i)
+        latin[i].page = GLYPH_NOT_RENDERED;
+}
 
 static int fontCounter;
 
-TrueTypeFont::TrueTypeFont(const std::string &filename, int size, int style)
+TrueTypeFont::TrueTypeFont(const std::string &filename, int size, int style):
+    mPenX(0),
+    mPenY(0),
+    mRowHeight(0)
 {
     if (fontCounter == 0 && TTF_Init() == -1)
     {
@@ -100,10 +109,21 @@ TrueTypeFont::TrueTypeFont(const std::string &filename, int size, int style)
     }
 
     TTF_SetFontStyle(mFont, style);
+
+#ifdef HAVE_TTF_KERNING
+    mKerning = TTF_GetFontKerning(mFont) != 0;
+#else
+    mKerning = false;
+#endif
+
+    for (int i = 0; i < 256; ++i)
+        mAdvances[i] = -1;
 }
 
 TrueTypeFont::~TrueTypeFont()
 {
+    clearAtlas();
+
     TTF_CloseFont(mFont);
     --fontCounter;
 
@@ -127,65 +147,420 @@ void TrueTypeFont::drawString(gcn::Graphics *graphics,
         throw "Not a valid graphics object!";
     }
 
-    gcn::Color col = g->getColor();
+    const gcn::Color &col = g->getColor();
     const float alpha = col.a / 255.0f;
 
-    /* The alpha value is ignored at string generation so avoid caching the
-     * same text with different alpha values.
+    // Rebuild the atlas when too many colors or characters were used
+    if (mPages.size() >= MAX_ATLAS_PAGES)
+        clearAtlas();
+
+    /* The alpha value is ignored at glyph rendering so avoid rendering the
+     * same glyphs with different alpha values.
      */
-    col.a = 255;
+    SDL_Color sdlCol;
+    sdlCol.r = col.r;
+    sdlCol.g = col.g;
+    sdlCol.b = col.b;
+
+    GlyphTable *&table = mGlyphTables[(col.r << 16) | (col.g << 8) | col.b];
+    if (!table)
+        table = new GlyphTable;
+
+    // Lay out the string. The buffers are reused between calls.
+    static std::vector<ImagePart> parts;
+    static std::vector<int> partPages;
+    parts.clear();
+    partPages.clear();
+
+    int penX = x;
+    int previousIndex = 0;
+    std::string::size_type i = 0;
+    while (i < text.length())
+    {
+        const Uint16 ch = nextCharacter(text, i);
+        const Glyph &glyph = getGlyph(*table, ch, sdlCol);
+
+        if (mKerning)
+            penX += getKerning(previousIndex, ch);
+
+        if (glyph.page >= 0)
+        {
+            ImagePart part;
+            part.srcX = glyph.x;
+            part.srcY = glyph.y;
+            part.dstX = penX + glyph.offsetX;
+            part.dstY = y + glyph.offsetY;
+            part.width = glyph.width;
+            part.height = glyph.height;
+            parts.push_back(part);
+            partPages.push_back(glyph.page);
+        }
 
-    TextChunk chunk(text, col);
+        penX += getAdvance(ch);
+    }
 
-    bool found = false;
+    if (parts.empty())
+        return;
 
-    for (CacheIterator i = mCache.begin(); i != mCache.end(); ++i)
+    // Draw the glyphs page by page
+    static std::vector<ImagePart> pageParts;
+    for (unsigned int page = 0; page < mPages.size(); ++page)
     {
-        if (chunk == (*i))
+        pageParts.clear();
+        for (unsigned int j = 0; j < parts.size(); ++j)
+        {
+            if (partPages[j] == (int) page)
+                pageParts.push_back(parts[j]);
+        }
+
+        if (pageParts.empty())
+            continue;
+
+        // Upload the glyphs added since the last time, all at once
+        AtlasPage &atlasPage = mPages[page];
+        if (atlasPage.dirty)
+        {
+            if (!atlasPage.image ||
+                !atlasPage.image->update(atlasPage.surface,
+                                         atlasPage.dirtyArea))
+            {
+                delete atlasPage.image;
+                atlasPage.image = Image::load(atlasPage.surface);
+            }
+            atlasPage.dirty = false;
+        }
+
+        if (!atlasPage.image)
+            continue;
+
+        if (alpha < 1.0f && !atlasPage.image->isAnOpenGLOne())
         {
-            // Raise priority: move it to front
-            mCache.splice(mCache.begin(), mCache, i);
-            found = true;
-            break;
+            drawTranslucent(g, atlasPage, pageParts, alpha);
+            continue;
         }
+
+        // With OpenGL, this only sets the color the page is modulated with
+        atlasPage.image->setAlpha(alpha);
+        g->drawImageParts(atlasPage.image, &pageParts[0], pageParts.size());
     }
+}
 
-    // Surface not found
-    if (!found)
+void TrueTypeFont::drawTranslucent(Graphics *graphics, const AtlasPage &page,
+                                   const std::vector<ImagePart> &parts,
+                                   float alpha)
+{
+    int left = parts[0].dstX;
+    int top = parts[0].dstY;
+    int right = left;
+    int bottom = top;
+    for (unsigned int i = 0; i < parts.size(); ++i)
     {
-        if (mCache.size() >= CACHE_SIZE)
+        left = std::min(left, parts[i].dstX);
+        top = std::min(top, parts[i].dstY);
+        right = std::max(right, parts[i].dstX + parts[i].width);
+        bottom = std::max(bottom, parts[i].dstY + parts[i].height);
+    }
+
+    const SDL_PixelFormat *format = page.surface->format;
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                                                right - left, bottom - top,
+                                                32,
+                                                format->Rmask, format->Gmask,
+                                                format->Bmask, format->Amask);
+    if (!surface)
+        return;
+
+    // Copy the glyphs with their alpha scaled, keeping the more opaque
+    // pixel where overhanging glyphs overlap
+    const Uint32 *src = (const Uint32 *) page.surface->pixels;
+    Uint32 *dst = (Uint32 *) surface->pixels;
+    const int srcPitch = page.surface->pitch / 4;
+    const int dstPitch = surface->pitch / 4;
+    const int scale = (int) (alpha * 256);
+
+    for (unsigned int i = 0; i < parts.size(); ++i)
+    {
+        const ImagePart &part = parts[i];
+        for (int y = 0; y < part.height; ++y)
         {
-            mCache.pop_back();
+            const Uint32 *srcRow = src + (part.srcY + y) * srcPitch
+                                       + part.srcX;
+            Uint32 *dstRow = dst + (part.dstY - top + y) * dstPitch
+                                 + part.dstX - left;
+
+            for (int x = 0; x < part.width; ++x)
+            {
+                const Uint32 a = ((srcRow[x] & format->Amask)
+                                  >> format->Ashift) * scale >> 8;
+                if (a > ((dstRow[x] & format->Amask) >> format->Ashift))
+                {
+                    dstRow[x] = (srcRow[x] & ~format->Amask)
+                              | (a << format->Ashift);
+                }
+            }
         }
-        mCache.push_front(chunk);
-        mCache.front().generate(mFont);
     }
 
-    mCache.front().img->setAlpha(alpha);
-    g->drawImage(mCache.front().img, x, y);
+    Image *image = Image::load(surface);
+    SDL_FreeSurface(surface);
+
+    if (image)
+    {
+        graphics->drawImage(image, left, top);
+        delete image;
+    }
 }
 
 int TrueTypeFont::getWidth(const std::string &text) const
 {
-    for (CacheIterator i = mCache.begin(); i != mCache.end(); i++)
+    int width = 0;
+    int previousIndex = 0;
+
+    std::string::size_type i = 0;
+    while (i < text.length())
     {
-        if (i->text == text)
-        {
-            // Raise priority: move it to front
-            // Assumption is that TTF::draw will be called next
-            mCache.splice(mCache.begin(), mCache, i);
-            return i->img->getWidth();
-        }
+        const Uint16 ch = nextCharacter(text, i);
+        if (mKerning)
+            width += getKerning(previousIndex, ch);
+        width += getAdvance(ch);
     }
 
-    int w, h;
-    const char* str = getSafeUtf8String(text);
-    TTF_SizeUTF8(mFont, str, &w, &h);
-    delete[] str;
-    return w;
+    return width;
 }
 
 int TrueTypeFont::getHeight() const
 {
     return TTF_FontHeight(mFont);
 }
+
+const TrueTypeFont::Glyph &TrueTypeFont::getGlyph(GlyphTable &table,
+                                                  Uint16 ch,
+                                                  const SDL_Color &color)
+{
+    Glyph *glyph;
+
+    if (ch < 256)
+    {
+        glyph = &table.latin[ch];
+    }
+    else
+    {
+        std::map<Uint16, Glyph>::iterator it = table.other.find(ch);
+        if (it == table.other.end())
+        {
+            Glyph newGlyph;
+            newGlyph.page = GLYPH_NOT_RENDERED;
+            it = table.other.insert(std::make_pair(ch, newGlyph)).first;
+        }
+        glyph = &it->second;
+    }
+
+    if (glyph->page == GLYPH_NOT_RENDERED)
+        renderGlyph(*glyph, ch, color);
+
+    return *glyph;
+}
+
+void TrueTypeFont::renderGlyph(Glyph &glyph, Uint16 ch,
+                               const SDL_Color &color)
+{
+    glyph.page = GLYPH_EMPTY;
+
+    // Control characters and byte order marks have nothing to draw
+    if (ch < 32 || ch == 0xFEFF || ch == 0xFFFE)
+        return;
+
+    const Uint16 str[2] = { ch, 0 };
+    SDL_Surface *surface = TTF_RenderUNICODE_Blended(mFont, str, color);
+
+    if (!surface)
+        return;
+
+    SDL_Rect srcRect;
+    srcRect.x = 0;
+    srcRect.y = 0;
+    srcRect.w = surface->w;
+    srcRect.h = surface->h;
+    int offsetX = 0;
+
+    int minX, maxX, minY, maxY, advance;
+    if (TTF_GlyphMetrics(mFont, ch, &minX, &maxX, &minY, &maxY, &advance) == 0)
+    {
+        // SDL_ttf moves glyphs that extend to the left of the pen to the
+        // right, so that they aren't cut off
+        if (minX < 0)
+            offsetX = minX;
+
+        // Only store the rows covered by the glyph. Bold and underlined
+        // glyphs may cover more than their metrics say.
+        const int style = TTF_GetFontStyle(mFont);
+        if (style == TTF_STYLE_NORMAL || style == TTF_STYLE_ITALIC)
+        {
+            const int ascent = TTF_FontAscent(mFont);
+            const int glyphTop = std::max(ascent - maxY, 0);
+            const int glyphBottom = std::min(ascent - minY, (int) surface->h);
+            if (glyphBottom > glyphTop)
+            {
+                srcRect.y = glyphTop;
+                srcRect.h = glyphBottom - glyphTop;
+            }
+        }
+    }
+
+    if (srcRect.w > ATLAS_WIDTH || srcRect.h > ATLAS_HEIGHT)
+    {
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    // Start a new row or page when the glyph doesn't fit
+    if (mPenX + srcRect.w > ATLAS_WIDTH)
+    {
+        mPenX = 0;
+        mPenY += mRowHeight;
+        mRowHeight = 0;
+    }
+
+    if (mPages.empty() || mPenY + srcRect.h > ATLAS_HEIGHT)
+    {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+        int rmask = 0xff000000;
+        int gmask = 0x00ff0000;
+        int bmask = 0x0000ff00;
+        int amask = 0x000000ff;
+#else
+        int rmask = 0x000000ff;
+        int gmask = 0x0000ff00;
+        int bmask = 0x00ff0000;
+        int amask = 0xff000000;
+#endif
+
+        AtlasPage page;
+        page.surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                                            ATLAS_WIDTH, ATLAS_HEIGHT,
+                                            32, rmask, gmask, bmask, amask);
+        page.image = NULL;
+        page.dirty = false;
+
+        if (!page.surface)
+        {
+            SDL_FreeSurface(surface);
+            return;
+        }
+
+        mPages.push_back(page);
+        mPenX = 0;
+        mPenY = 0;
+        mRowHeight = 0;
+    }
+
+    // Copy the pixels including their alpha instead of blending them
+    SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
+
+    AtlasPage &page = mPages.back();
+    SDL_Rect dstRect;
+    dstRect.x = mPenX;
+    dstRect.y = mPenY;
+    SDL_BlitSurface(surface, &srcRect, page.surface, &dstRect);
+
+    // Grow the area to upload so that it includes the glyph
+    if (!page.dirty)
+    {
+        page.dirtyArea.x = mPenX;
+        page.dirtyArea.y = mPenY;
+        page.dirtyArea.w = srcRect.w;
+        page.dirtyArea.h = srcRect.h;
+        page.dirty = true;
+    }
+    else
+    {
+        const int left = std::min<int>(page.dirtyArea.x, mPenX);
+        const int top = std::min<int>(page.dirtyArea.y, mPenY);
+        const int right = std::max<int>(page.dirtyArea.x + page.dirtyArea.w,
+                                        mPenX + srcRect.w);
+        const int bottom = std::max<int>(page.dirtyArea.y + page.dirtyArea.h,
+                                         mPenY + srcRect.h);
+        page.dirtyArea.x = left;
+        page.dirtyArea.y = top;
+        page.dirtyArea.w = right - left;
+        page.dirtyArea.h = bottom - top;
+    }
+
+    glyph.page = mPages.size() - 1;
+    glyph.x = mPenX;
+    glyph.y = mPenY;
+    glyph.width = srcRect.w;
+    glyph.height = srcRect.h;
+    glyph.offsetX = offsetX;
+    glyph.offsetY = srcRect.y;
+
+    // Leave a pixel between glyphs so that they don't bleed into each other
+    mPenX += srcRect.w + 1;
+    if (srcRect.h + 1 > mRowHeight)
+        mRowHeight = srcRect.h + 1;
+
+    SDL_FreeSurface(surface);
+}
+
+int TrueTypeFont::getAdvance(Uint16 ch) const
+{
+    if (ch < 256 && mAdvances[ch] >= 0)
+        return mAdvances[ch];
+
+    if (ch >= 256)
+    {
+        std::map<Uint16, int>::const_iterator it = mOtherAdvances.find(ch);
+        if (it != mOtherAdvances.end())
+            return it->second;
+    }
+
+    int minX, maxX, minY, maxY, advance;
+    if (TTF_GlyphMetrics(mFont, ch, &minX, &maxX, &minY, &maxY, &advance) < 0)
+        advance = 0;
+
+    if (ch < 256)
+        mAdvances[ch] = advance;
+    else
+        mOtherAdvances[ch] = advance;
+
+    return advance;
+}
+
+int TrueTypeFont::getKerning(int &previousIndex, Uint16 ch) const
+{
+#ifdef HAVE_TTF_KERNING
+    // Returns the index of the glyph, like TTF_SizeUTF8 uses it
+    const int index = TTF_GlyphIsProvided(mFont, ch);
+    int kerning = 0;
+
+    if (previousIndex && index)
+        kerning = TTF_GetFontKerningSize(mFont, previousIndex, index);
+
+    previousIndex = index;
+    return kerning;
+#else
+    return 0;
+#endif
+}
+
+void TrueTypeFont::clearAtlas()
+{
+    for (std::map<Uint32, GlyphTable*>::iterator i = mGlyphTables.begin();
+         i != mGlyphTables.end(); ++i)
+    {
+        delete i->second;
+    }
+    mGlyphTables.clear();
+
+    for (std::vector<AtlasPage>::iterator i = mPages.begin();
+         i != mPages.end(); ++i)
+    {
+        delete i->image;
+        SDL_FreeSurface(i->surface);
+    }
+    mPages.clear();
+
+    mPenX = 0;
+    mPenY = 0;
+    mRowHeight = 0;
+}
@@ -35,14 +35,21 @@
 #endif
 #endif
 
-#include <list>
+#include <map>
 #include <string>
+#include <vector>
 
-class TextChunk;
+class Graphics;
+class Image;
+struct ImagePart;
 
 /**
  * A wrapper around SDL_ttf for allowing the use of TrueType fonts.
  *
+ * Glyphs are rendered once per color into atlas pages, and strings are laid
+ * out from a table of glyph advances and the kerning of the font. All glyphs
+ * of a string that are on the same page are drawn with a single call.
+ *
  * <b>NOTE:</b> This class initializes SDL_ttf as necessary.
  */
 class TrueTypeFont : public gcn::Font
@@ -73,10 +80,95 @@ class TrueTypeFont : public gcn::Font
                         int x, int y);
 
     private:
+        /**
+         * The location of a rendered glyph in the atlas.
+         */
+        struct Glyph
+        {
+            int page;           /**< Atlas page, or one of GlyphState. */
+            int x, y;           /**< Position on the atlas page. */
+            int width, height;
+            int offsetX, offsetY;   /**< Position relative to the pen. */
+        };
+
+        enum GlyphState
+        {
+            GLYPH_EMPTY = -1,       /**< Nothing to draw for this glyph. */
+            GLYPH_NOT_RENDERED = -2
+        };
+
+        /**
+         * The glyphs rendered in a single color. The first 256 code points
+         * are looked up directly, others through a map.
+         */
+        struct GlyphTable
+        {
+            GlyphTable();
+
+            Glyph latin[256];
+            std::map<Uint16, Glyph> other;
+        };
+
+        /**
+         * A page of the glyph atlas.
+         */
+        struct AtlasPage
+        {
+            SDL_Surface *surface;
+            Image *image;       /**< Uploaded copy of the surface. */
+            bool dirty;         /**< Whether glyphs were added since upload. */
+            SDL_Rect dirtyArea; /**< Area of the glyphs added since upload. */
+        };
+
+        /**
+         * Returns the glyph for the given character from the given table,
+         * rendering it into the atlas when it isn't there yet.
+         */
+        const Glyph &getGlyph(GlyphTable &table, Uint16 ch,
+                              const SDL_Color &color);
+
+        /**
+         * Renders a glyph into the atlas.
+         */
+        void renderGlyph(Glyph &glyph, Uint16 ch, const SDL_Color &color);
+
+        /**
+         * Draws glyphs of the given page at the given alpha, without
+         * changing the page. Used by the software renderer, which would
+         * otherwise rewrite the alpha of the whole page.
+         */
+        void drawTranslucent(Graphics *graphics, const AtlasPage &page,
+                             const std::vector<ImagePart> &parts,
+                             float alpha);
+
+        /**
+         * Returns the horizontal advance of the given character.
+         */
+        int getAdvance(Uint16 ch) const;
+
+        /**
+         * Returns the kerning between the glyph with the given index and the
+         * given character, and sets the index to that of the character.
+         */
+        int getKerning(int &previousIndex, Uint16 ch) const;
+
+        /**
+         * Frees all atlas pages and forgets about the rendered glyphs.
+         */
+        void clearAtlas();
+
         TTF_Font *mFont;
+        bool mKerning;          /**< Whether to apply the kerning. */
+
+        // Advances of the glyphs, -1 when not known yet
+        mutable int mAdvances[256];
+        mutable std::map<Uint16, int> mOtherAdvances;
 
-        // Word surfaces cache
-        mutable std::list<TextChunk> mCache;
+        // Glyph atlas, with a glyph table for each color
+        std::map<Uint32, GlyphTable*> mGlyphTables;
+        std::vector<AtlasPage> mPages;
+        int mPenX, mPenY;       /**< Free position on the last page. */
+        int mRowHeight;         /**< Height of the current row of glyphs. */
 };
 
 #endif
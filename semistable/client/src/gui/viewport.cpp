@@ -40,6 +40,7 @@
 
 #include "resources/resourcemanager.h"
 
+#include "utils/profiler.h"
 #include "utils/stringutils.h"
 
 extern volatile int tick_time;
@@ -50,6 +51,8 @@ Viewport::Viewport():
     mMouseY(0),
     mPixelViewX(0.0f),
     mPixelViewY(0.0f),
+    mLastPixelViewX(0.0f),
+    mLastPixelViewY(0.0f),
     mShowDebugPath(false),
     mPlayerFollowMouse(false),
     mLocalWalkTime(-1),
@@ -124,6 +127,9 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
     // Apply lazy scrolling
     while (lastTick < tick_time)
     {
+        mLastPixelViewX = mPixelViewX;
+        mLastPixelViewY = mPixelViewY;
+
         if (player_x > mPixelViewX + mScrollRadius)
         {
             mPixelViewX += (player_x - mPixelViewX - mScrollRadius) /
@@ -156,6 +162,8 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
     {
         mPixelViewX = player_x;
         mPixelViewY = player_y;
+        mLastPixelViewX = mPixelViewX;
+        mLastPixelViewY = mPixelViewY;
     };
 
     // Don't move camera so that the end of the map is on screen
@@ -174,9 +182,23 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
 
     // Center camera on map if the map is smaller than the screen
     if (mapWidthPixels < graphics->getWidth())
+    {
         mPixelViewX = (mapWidthPixels - graphics->getWidth()) / 2;
+        mLastPixelViewX = mPixelViewX;
+    }
     if (mapHeightPixels < graphics->getHeight())
+    {
         mPixelViewY = (mapHeightPixels - graphics->getHeight()) / 2;
+        mLastPixelViewY = mPixelViewY;
+    }
+
+    // Move the camera between its positions at the last two ticks, like the
+    // actors are drawn between theirs
+    const float interpolation = Actor::getInterpolation();
+    const int viewX = (int) (mLastPixelViewX +
+                             (mPixelViewX - mLastPixelViewX) * interpolation);
+    const int viewY = (int) (mLastPixelViewY +
+                             (mPixelViewY - mLastPixelViewY) * interpolation);
 
     // Draw black background if map is smaller than the screen
     if (        mapWidthPixels < graphics->getWidth()
@@ -191,13 +213,13 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
     // Draw tiles and sprites
     if (mMap)
     {
-        mMap->draw(graphics, (int) mPixelViewX, (int) mPixelViewY);
+        mMap->draw(graphics, viewX, viewY);
 
         if (mShowDebugPath)
         {
             mMap->drawCollision(graphics,
-                                (int) mPixelViewX,
-                                (int) mPixelViewY,
+                                viewX,
+                                viewY,
                                 mShowDebugPath);
             if (mShowDebugPath == Map::MAP_DEBUG)
                 _drawDebugPath(graphics);
@@ -213,7 +235,9 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
     // Draw text
     if (textManager)
     {
-        textManager->draw(graphics, (int) mPixelViewX, (int) mPixelViewY);
+        static const int textSection = Profiler::section("TextManager::draw");
+        ProfileScope scope(textSection);
+        textManager->draw(graphics, viewX, viewY);
     }
 
     // Draw player names, speech, and emotion sprite as needed
@@ -225,8 +249,8 @@ void Viewport::draw(gcn::Graphics *gcnGraphics)
             continue;
 
         Being *b = static_cast<Being*>(*it);
-        b->drawSpeech((int) mPixelViewX, (int) mPixelViewY);
-        b->drawEmotion(graphics, (int) mPixelViewX, (int) mPixelViewY);
+        b->drawSpeech(viewX, viewY);
+        b->drawEmotion(graphics, viewX, viewY);
     }
 
     if (miniStatusWindow)
@@ -328,7 +352,7 @@ void Viewport::_drawPath(Graphics *graphics, const Path &path,
 
             graphics->fillRectangle(gcn::Rectangle(squareX, squareY, 8, 8));
             graphics->drawText(
-                    toString(mMap->getMetaTile(i->x, i->y)->Gcost),
+                    toString(mMap->getPathCost(i->x, i->y)),
                     squareX + 4, squareY + 12, gcn::Graphics::CENTER);
         }
     }
@@ -342,7 +366,7 @@ void Viewport::_drawPath(Graphics *graphics, const Path &path,
             graphics->fillRectangle(gcn::Rectangle(squareX - 4, squareY - 4,
                                                    8, 8));
             graphics->drawText(
-                    toString(mMap->getMetaTile(i->x / 32, i->y / 32)->Gcost),
+                    toString(mMap->getPathCost(i->x / 32, i->y / 32)),
                     squareX + 4, squareY + 12, gcn::Graphics::CENTER);
         }
 
@@ -190,6 +190,8 @@ class Viewport : public WindowContainer, public gcn::MouseListener,
         int mMouseY;                 /**< Current mouse position in pixels. */
         float mPixelViewX;           /**< Current viewpoint in pixels. */
         float mPixelViewY;           /**< Current viewpoint in pixels. */
+        float mLastPixelViewX;       /**< Viewpoint at the previous tick. */
+        float mLastPixelViewY;       /**< Viewpoint at the previous tick. */
         int mShowDebugPath;         /**< Show a path from player to pointer. */
 
         bool mPlayerFollowMouse;
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/button.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "gui/palette.h"
@@ -125,7 +124,7 @@ Button::~Button()
 
 void Button::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (mAlpha != alpha)
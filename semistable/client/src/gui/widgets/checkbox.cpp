@@ -21,7 +21,6 @@
 
 #include "gui/widgets/checkbox.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "gui/palette.h"
@@ -92,7 +91,7 @@ void CheckBox::draw(gcn::Graphics* graphics)
 
 void CheckBox::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (mAlpha != alpha)
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/dropdown.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "gui/palette.h"
@@ -110,7 +109,7 @@ DropDown::~DropDown()
 
 void DropDown::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (mAlpha != alpha)
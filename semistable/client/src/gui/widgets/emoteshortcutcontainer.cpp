@@ -51,7 +51,7 @@ EmoteShortcutContainer::EmoteShortcutContainer():
 
     mBackgroundImg = Theme::getImageFromTheme("item_shortcut_bgr.png");
 
-    mBackgroundImg->setAlpha(config.getFloatValue("guialpha"));
+    mBackgroundImg->setAlpha(Theme::instance()->getGuiAlpha());
 
     // Setup emote sprites
     for (int i = 0; i <= EmoteDB::getLast(); i++)
@@ -72,9 +72,9 @@ EmoteShortcutContainer::~EmoteShortcutContainer()
 
 void EmoteShortcutContainer::draw(gcn::Graphics *graphics)
 {
-    if (config.getFloatValue("guialpha") != mAlpha)
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
     {
-        mAlpha = config.getFloatValue("guialpha");
+        mAlpha = Theme::instance()->getGuiAlpha();
         mBackgroundImg->setAlpha(mAlpha);
     }
 
@@ -53,7 +53,7 @@ ItemShortcutContainer::ItemShortcutContainer():
     mBackgroundImg = Theme::getImageFromTheme("item_shortcut_bgr.png");
     mMaxItems = itemShortcut->getItemCount();
 
-    mBackgroundImg->setAlpha(config.getFloatValue("guialpha"));
+    mBackgroundImg->setAlpha(Theme::instance()->getGuiAlpha());
 
     mBoxHeight = mBackgroundImg->getHeight();
     mBoxWidth = mBackgroundImg->getWidth();
@@ -67,9 +67,9 @@ ItemShortcutContainer::~ItemShortcutContainer()
 
 void ItemShortcutContainer::draw(gcn::Graphics *graphics)
 {
-    if (config.getFloatValue("guialpha") != mAlpha)
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
     {
-        mAlpha = config.getFloatValue("guialpha");
+        mAlpha = Theme::instance()->getGuiAlpha();
         mBackgroundImg->setAlpha(mAlpha);
     }
 
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/listbox.h"
 
-#include "configuration.h"
 
 #include "gui/palette.h"
 #include "gui/sdlinput.h"
@@ -46,7 +45,7 @@ ListBox::~ListBox()
 
 void ListBox::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (mAlpha != alpha)
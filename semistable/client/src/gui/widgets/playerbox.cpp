@@ -23,7 +23,6 @@
 
 #include "animatedsprite.h"
 #include "being.h"
-#include "configuration.h"
 #include "graphics.h"
 
 #include "resources/image.h"
@@ -56,7 +55,7 @@ PlayerBox::PlayerBox(const Being *being):
                         bggridx[x], bggridy[y],
                         bggridx[x + 1] - bggridx[x] + 1,
                         bggridy[y + 1] - bggridy[y] + 1);
-                background.grid[a]->setAlpha(config.getFloatValue("guialpha"));
+                background.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
                 a++;
             }
         }
@@ -90,11 +89,11 @@ void PlayerBox::draw(gcn::Graphics *graphics)
         mBeing->drawSpriteAt(static_cast<Graphics*>(graphics), x, y);
     }
 
-    if (config.getFloatValue("guialpha") != mAlpha)
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
     {
         for (int a = 0; a < 9; a++)
         {
-            background.grid[a]->setAlpha(config.getFloatValue("guialpha"));
+            background.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
         }
     }
 }
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/progressbar.h"
 
-#include "configuration.h"
 #include "graphics.h"
 #include "textrenderer.h"
 
@@ -123,7 +122,7 @@ void ProgressBar::logic()
 
 void ProgressBar::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (mAlpha != alpha)
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/radiobutton.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "resources/image.h"
@@ -77,9 +76,9 @@ RadioButton::~RadioButton()
 
 void RadioButton::drawBox(gcn::Graphics* graphics)
 {
-    if (config.getFloatValue("guialpha") != mAlpha)
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
     {
-        mAlpha = config.getFloatValue("guialpha");
+        mAlpha = Theme::instance()->getGuiAlpha();
         radioNormal->setAlpha(mAlpha);
         radioChecked->setAlpha(mAlpha);
         radioDisabled->setAlpha(mAlpha);
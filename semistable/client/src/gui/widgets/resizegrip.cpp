@@ -21,7 +21,6 @@
 
 #include "gui/widgets/resizegrip.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "resources/image.h"
@@ -58,9 +57,9 @@ ResizeGrip::~ResizeGrip()
 
 void ResizeGrip::draw(gcn::Graphics *graphics)
 {
-    if (config.getFloatValue("guialpha") != mAlpha)
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
     {
-        mAlpha = config.getFloatValue("guialpha");
+        mAlpha = Theme::instance()->getGuiAlpha();
         gripImage->setAlpha(mAlpha);
     }
 
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/scrollarea.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "resources/image.h"
@@ -107,7 +106,7 @@ void ScrollArea::init()
                         bggridx[x], bggridy[y],
                         bggridx[x + 1] - bggridx[x] + 1,
                         bggridy[y + 1] - bggridy[y] + 1);
-                background.grid[a]->setAlpha(config.getFloatValue("guialpha"));
+                background.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
                 a++;
             }
         }
@@ -134,8 +133,8 @@ void ScrollArea::init()
                         vsgridx[x], vsgridy[y],
                         vsgridx[x + 1] - vsgridx[x],
                         vsgridy[y + 1] - vsgridy[y]);
-                vMarker.grid[a]->setAlpha(config.getFloatValue("guialpha"));
-                vMarkerHi.grid[a]->setAlpha(config.getFloatValue("guialpha"));
+                vMarker.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
+                vMarkerHi.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
                 a++;
             }
         }
@@ -212,7 +211,7 @@ void ScrollArea::logic()
 
 void ScrollArea::updateAlpha()
 {
-        float alpha = std::max(config.getFloatValue("guialpha"),
+        float alpha = std::max(Theme::instance()->getGuiAlpha(),
                                Theme::instance()->getMinimumOpacity());
 
     if (alpha != mAlpha)
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/shoplistbox.h"
 
-#include "configuration.h"
 #include "graphics.h"
 #include "shopitem.h"
 
@@ -71,8 +70,8 @@ void ShopListBox::draw(gcn::Graphics *gcnGraphics)
     if (!mListModel)
         return;
 
-    if (config.getFloatValue("guialpha") != mAlpha)
-        mAlpha = config.getFloatValue("guialpha");
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
+        mAlpha = Theme::instance()->getGuiAlpha();
 
     int alpha = (int)(mAlpha * 255.0f);
     const gcn::Color* highlightColor =
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/slider.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "resources/image.h"
@@ -125,7 +124,7 @@ void Slider::init()
 
 void Slider::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (alpha != mAlpha)
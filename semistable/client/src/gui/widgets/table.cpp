@@ -21,7 +21,6 @@
 
 #include "gui/widgets/table.h"
 
-#include "configuration.h"
 
 #include "gui/sdlinput.h"
 
@@ -271,8 +270,8 @@ void GuiTable::draw(gcn::Graphics* graphics)
     if (!mModel)
         return;
 
-    if (config.getFloatValue("guialpha") != mAlpha)
-        mAlpha = config.getFloatValue("guialpha");
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
+        mAlpha = Theme::instance()->getGuiAlpha();
 
     if (mOpaque)
     {
@@ -21,7 +21,6 @@
 
 #include "gui/widgets/textfield.h"
 
-#include "configuration.h"
 #include "graphics.h"
 
 #include "gui/palette.h"
@@ -65,7 +64,7 @@ TextField::TextField(const std::string &text, bool loseFocusOnTab):
                         gridx[x], gridy[y],
                         gridx[x + 1] - gridx[x] + 1,
                         gridy[y + 1] - gridy[y] + 1);
-                skin.grid[a]->setAlpha(config.getFloatValue("guialpha"));
+                skin.grid[a]->setAlpha(Theme::instance()->getGuiAlpha());
                 a++;
             }
         }
@@ -86,7 +85,7 @@ TextField::~TextField()
 
 void TextField::updateAlpha()
 {
-    float alpha = std::max(config.getFloatValue("guialpha"),
+    float alpha = std::max(Theme::instance()->getGuiAlpha(),
                            Theme::instance()->getMinimumOpacity());
 
     if (alpha != mAlpha)
@@ -21,13 +21,14 @@
 
 #include "gui/widgets/textpreview.h"
 
-#include "configuration.h"
 #include "textrenderer.h"
 
 #include "gui/gui.h"
 #include "gui/palette.h"
 #include "gui/truetypefont.h"
 
+#include "resources/theme.h"
+
 #include <typeinfo>
 
 float TextPreview::mAlpha = 1.0;
@@ -45,8 +46,8 @@ TextPreview::TextPreview(const std::string &text):
 
 void TextPreview::draw(gcn::Graphics* graphics)
 {
-    if (config.getFloatValue("guialpha") != mAlpha)
-        mAlpha = config.getFloatValue("guialpha");
+    if (Theme::instance()->getGuiAlpha() != mAlpha)
+        mAlpha = Theme::instance()->getGuiAlpha();
 
     int alpha = (int) (mAlpha * 255.0f);
 
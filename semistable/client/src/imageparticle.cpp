@@ -44,8 +44,9 @@ bool ImageParticle::draw(Graphics *graphics, int offsetX, int offsetY) const
     if (!mAlive || !mImage)
         return false;
 
-    int screenX = (int) mPos.x + offsetX - mImage->getWidth() / 2;
-    int screenY = (int) mPos.y - (int)mPos.z + offsetY - mImage->getHeight()/2;
+    const Vector pos = getDrawPosition();
+    int screenX = (int) pos.x + offsetX - mImage->getWidth() / 2;
+    int screenY = (int) pos.y - (int)pos.z + offsetY - mImage->getHeight()/2;
 
     // Check if on screen
     if (screenX + mImage->getWidth() < 0 ||
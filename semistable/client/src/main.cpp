@@ -65,6 +65,17 @@ static void printHelp()
 #ifdef USE_OPENGL
         << _("     --no-opengl      : Disable OpenGL for this session") << endl
 #endif
+        << _("     --benchmark      : Measure rendering of the given map, "
+                                     "then quit") << endl
+        << _("     --benchmark-beings : Number of beings to render in the "
+                                     "benchmark") << endl
+        << _("     --benchmark-frames : Number of frames to render in the "
+                                     "benchmark") << endl
+        << _("     --benchmark-paths : Search this number of paths on the "
+                                     "map instead of rendering it") << endl
+        << _("     --benchmark-particles : Update this number of particle "
+                                     "effects with and without batching "
+                                     "instead of rendering") << endl
         ;
 }
 
@@ -94,6 +105,11 @@ static void parseOptions(int argc, char *argv[], Client::Options &options)
         { "chat-log-dir",   required_argument, 0, 'l' },
         { "version",        no_argument,       0, 'v' },
         { "screenshot-dir", required_argument, 0, 'i' },
+        { "benchmark",      required_argument, 0, 'b' },
+        { "benchmark-beings", required_argument, 0, 'N' },
+        { "benchmark-frames", required_argument, 0, 'F' },
+        { "benchmark-paths", required_argument, 0, 'A' },
+        { "benchmark-particles", required_argument, 0, 'E' },
         { 0 }
     };
 
@@ -155,6 +171,21 @@ static void parseOptions(int argc, char *argv[], Client::Options &options)
             case 'i':
                 options.screenshotDir = optarg;
                 break;
+            case 'b':
+                options.benchmarkMap = optarg;
+                break;
+            case 'N':
+                options.benchmarkBeings = atoi(optarg);
+                break;
+            case 'F':
+                options.benchmarkFrames = atoi(optarg);
+                break;
+            case 'A':
+                options.benchmarkPaths = atoi(optarg);
+                break;
+            case 'E':
+                options.benchmarkParticles = atoi(optarg);
+                break;
         }
     }
 
@@ -26,6 +26,7 @@
 #include "configuration.h"
 #include "graphics.h"
 #include "particle.h"
+#include "pathfinder.h"
 #include "simpleanimation.h"
 #include "tileset.h"
 
@@ -34,33 +35,30 @@
 #include "resources/resourcemanager.h"
 
 #include "utils/dtor.h"
+#include "utils/profiler.h"
 #include "utils/stringutils.h"
 
-#include <queue>
+#include <algorithm>
+#include <cstring>
 
 /**
- * A location on a tile map. Used for pathfinding, open list.
+ * Size in tiles of the blocks in which non-fringe layers are pre-rendered.
  */
-struct Location
-{
-    /**
-     * Constructor.
-     */
-    Location(int px, int py, MetaTile *ptile):
-        x(px), y(py), tile(ptile)
-    {}
+static const int CHUNK_SIZE = 16;
 
-    /**
-     * Comparison operator.
-     */
-    bool operator< (const Location &loc) const
-    {
-        return tile->Fcost > loc.tile->Fcost;
-    }
+/**
+ * Number of chunks kept pre-rendered around the visible ones on each side.
+ */
+static const int CHUNK_MARGIN = 1;
 
-    int x, y;
-    MetaTile *tile;
-};
+/**
+ * Maximum number of pre-rendered chunks per layer. In software mode each
+ * chunk takes up to 512 x 512 x 4 bytes (1 MiB, a bit more with tall
+ * tiles), so this limits a layer to roughly 48 MiB. That covers the visible
+ * chunks plus the margin up to a resolution of about 2560 x 1600. Chunks
+ * beyond the limit are drawn tile by tile.
+ */
+static const int MAX_CHUNK_IMAGES = 48;
 
 TileAnimation::TileAnimation(Animation *ani):
     mLastImage(NULL)
@@ -73,6 +71,12 @@ TileAnimation::~TileAnimation()
     delete mAnimation;
 }
 
+void TileAnimation::addAffectedTile(MapLayer *layer, int index)
+{
+    mAffected.push_back(std::make_pair(layer, index));
+    layer->setTileAnimated(index);
+}
+
 void TileAnimation::update(int ticks)
 {
     if (!mAnimation)
@@ -97,16 +101,31 @@ void TileAnimation::update(int ticks)
 MapLayer::MapLayer(int x, int y, int width, int height, bool isFringeLayer):
     mX(x), mY(y),
     mWidth(width), mHeight(height),
-    mIsFringeLayer(isFringeLayer)
+    mIsFringeLayer(isFringeLayer),
+    mChunksX((width + CHUNK_SIZE - 1) / CHUNK_SIZE),
+    mChunksY((height + CHUNK_SIZE - 1) / CHUNK_SIZE),
+    mKeptStartCX(0), mKeptStartCY(0), mKeptEndCX(0), mKeptEndCY(0),
+    mChunkImages(0),
+    mChunksFailed(false)
 {
     const int size = mWidth * mHeight;
     mTiles = new Image*[size];
     std::fill_n(mTiles, size, (Image*) 0);
+
+    // The fringe layer is drawn tile by tile in between the actors
+    if (!mIsFringeLayer)
+        mChunks.resize(mChunksX * mChunksY);
 }
 
 MapLayer::~MapLayer()
 {
     delete[] mTiles;
+
+    for (std::vector<Chunk>::iterator i = mChunks.begin(), i_end = mChunks.end();
+         i != i_end; ++i)
+    {
+        delete i->image;
+    }
 }
 
 void MapLayer::setTile(int x, int y, Image *img)
@@ -114,14 +133,45 @@ void MapLayer::setTile(int x, int y, Image *img)
     setTile(x + y * mWidth, img);
 }
 
+void MapLayer::setTile(int index, Image *img)
+{
+    mTiles[index] = img;
+
+    if (mChunks.empty())
+        return;
+
+    // Invalidate the pre-rendered chunk
+    Chunk &chunk = getChunk(index);
+    releaseChunk(chunk);
+    chunk.empty = false;
+}
+
+void MapLayer::setTileAnimated(int index)
+{
+    if (mChunks.empty())
+        return;
+
+    Chunk &chunk = getChunk(index);
+    releaseChunk(chunk);
+    chunk.animated = true;
+}
+
 Image* MapLayer::getTile(int x, int y) const
 {
     return mTiles[x + y * mWidth];
 }
 
+MapLayer::Chunk &MapLayer::getChunk(int index) const
+{
+    const int cx = (index % mWidth) / CHUNK_SIZE;
+    const int cy = (index / mWidth) / CHUNK_SIZE;
+    return mChunks[cx + cy * mChunksX];
+}
+
 void MapLayer::draw(Graphics *graphics, int startX, int startY,
                     int endX, int endY, int scrollX, int scrollY,
-                    const Actors &actors, int debugFlags) const
+                    const std::vector<Actor*> &actors,
+                    int debugFlags) const
 {
     startX -= mX;
     startY -= mY;
@@ -133,68 +183,231 @@ void MapLayer::draw(Graphics *graphics, int startX, int startY,
     if (endX > mWidth) endX = mWidth;
     if (endY > mHeight) endY = mHeight;
 
-    Actors::const_iterator ai = actors.begin();
-
     int dx = (mX * 32) - scrollX;
     int dy = (mY * 32) - scrollY + 32;
 
-    for (int y = startY; y < endY; y++)
+    if (!mIsFringeLayer)
     {
-        int y32 = y * 32;
+        // The special debug modes leave out some of the tiles, which the
+        // pre-rendered chunks can't do.
+        if (debugFlags == Map::MAP_NORMAL || debugFlags == Map::MAP_DEBUG)
+            drawChunks(graphics, startX, startY, endX, endY, dx, dy);
+        else
+            drawTiles(graphics, startX, startY, endX, endY, dx, dy,
+                      debugFlags);
+        return;
+    }
+
+    std::vector<Actor*>::const_iterator ai = actors.begin();
 
-        // If drawing the fringe layer, make sure all actors above this row of
-        // tiles have been drawn
-        if (mIsFringeLayer)
+    for (int y = startY; y < endY; y++)
+    {
+        // Make sure all actors above this row of tiles have been drawn
+        while (ai != actors.end() && (*ai)->getPixelY() <= y * 32)
         {
-            while (ai != actors.end() && (*ai)->getPixelY() <= y * 32)
-            {
-                (*ai)->draw(graphics, -scrollX, -scrollY);
-                ai++;
-            }
+            (*ai)->draw(graphics, -scrollX, -scrollY);
+            ai++;
         }
 
-        if (debugFlags != Map::MAP_SPECIAL3)
-        {
-            const int py0 = y32 + dy;
+        drawTiles(graphics, startX, y, endX, y + 1, dx, dy, debugFlags);
+    }
 
-            for (int x = startX; x < endX; x++)
+    // Draw any remaining actors
+    while (ai != actors.end())
+    {
+        (*ai)->draw(graphics, -scrollX, -scrollY);
+        ai++;
+    }
+}
+
+void MapLayer::drawTiles(Graphics *graphics,
+                         int startX, int startY,
+                         int endX, int endY,
+                         int dx, int dy,
+                         int debugFlags) const
+{
+    if (debugFlags == Map::MAP_SPECIAL3)
+        return;
+
+    for (int y = startY; y < endY; y++)
+    {
+        const int py0 = y * 32 + dy;
+
+        for (int x = startX; x < endX; x++)
+        {
+            Image *img = getTile(x, y);
+            if (img)
             {
-                Image *img = getTile(x, y);
-                if (img)
+                const int px = (x * 32) + dx;
+                const int py = py0 - img->getHeight();
+                if ((debugFlags != Map::MAP_SPECIAL
+                    && debugFlags != Map::MAP_SPECIAL2)
+                    || img->getHeight() <= 32)
                 {
-                    const int px = (x * 32) + dx;
-                    const int py = py0 - img->getHeight();
-                    if ((debugFlags != Map::MAP_SPECIAL
-                        && debugFlags != Map::MAP_SPECIAL2)
-                        || img->getHeight() <= 32)
+                    int width = 0;
+                    int c = getTileDrawWidth(x, y, endX, width);
+                    if (!c)
+                    {
+                        graphics->drawImage(img, px, py);
+                    }
+                    else
                     {
-                        int width = 0;
-                        int c = getTileDrawWidth(x, y, endX, width);
-                        if (!c)
-                        {
-                            graphics->drawImage(img, px, py);
-                        }
-                        else
-                        {
-                            graphics->drawImagePattern(img, px, py,
-                                width, img->getHeight());
-                        }
-                        x += c;
+                        graphics->drawImagePattern(img, px, py,
+                            width, img->getHeight());
                     }
+                    x += c;
                 }
             }
         }
     }
+}
 
-    // Draw any remaining actors
-    if (mIsFringeLayer)
+void MapLayer::drawChunks(Graphics *graphics,
+                          int startX, int startY,
+                          int endX, int endY,
+                          int dx, int dy) const
+{
+    if (startX >= endX || startY >= endY)
+        return;
+
+    const int startCX = startX / CHUNK_SIZE;
+    const int startCY = startY / CHUNK_SIZE;
+    const int endCX = (endX + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const int endCY = (endY + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // Chunks are drawn row by row, like the tiles they contain. Only tiles
+    // that are both taller and wider than a single tile may overlap a
+    // neighbouring chunk in a different order than before.
+    for (int cy = startCY; cy < endCY; cy++)
     {
-        while (ai != actors.end())
+        for (int cx = startCX; cx < endCX; cx++)
         {
-            (*ai)->draw(graphics, -scrollX, -scrollY);
-            ai++;
+            Chunk &chunk = mChunks[cx + cy * mChunksX];
+            if (chunk.empty)
+                continue;
+
+            const int tileX = cx * CHUNK_SIZE;
+            const int tileY = cy * CHUNK_SIZE;
+
+            if (!chunk.image && !chunk.animated && !mChunksFailed &&
+                mChunkImages < MAX_CHUNK_IMAGES)
+                renderChunk(graphics, cx, cy);
+
+            if (chunk.image)
+            {
+                graphics->drawChunk(chunk.image,
+                                    tileX * 32 + dx,
+                                    tileY * 32 + dy - 32 + chunk.offsetY);
+            }
+            else if (!chunk.empty)
+            {
+                drawTiles(graphics, tileX, tileY,
+                          std::min(tileX + CHUNK_SIZE, mWidth),
+                          std::min(tileY + CHUNK_SIZE, mHeight),
+                          dx, dy, Map::MAP_NORMAL);
+            }
         }
     }
+
+    const int keepStartCX = std::max(startCX - CHUNK_MARGIN, 0);
+    const int keepStartCY = std::max(startCY - CHUNK_MARGIN, 0);
+    const int keepEndCX = std::min(endCX + CHUNK_MARGIN, mChunksX);
+    const int keepEndCY = std::min(endCY + CHUNK_MARGIN, mChunksY);
+
+    if (keepStartCX != mKeptStartCX || keepStartCY != mKeptStartCY ||
+        keepEndCX != mKeptEndCX || keepEndCY != mKeptEndCY)
+    {
+        releaseChunks(keepStartCX, keepStartCY, keepEndCX, keepEndCY);
+    }
+}
+
+void MapLayer::renderChunk(Graphics *graphics, int cx, int cy) const
+{
+    Chunk &chunk = mChunks[cx + cy * mChunksX];
+
+    const int startX = cx * CHUNK_SIZE;
+    const int startY = cy * CHUNK_SIZE;
+    const int endX = std::min(startX + CHUNK_SIZE, mWidth);
+    const int endY = std::min(startY + CHUNK_SIZE, mHeight);
+
+    // Find out how far larger tiles stick out at the top and the right
+    bool empty = true;
+    int overTop = 0;
+    int overRight = 0;
+    for (int y = startY; y < endY; y++)
+    {
+        for (int x = startX; x < endX; x++)
+        {
+            if (Image *img = getTile(x, y))
+            {
+                empty = false;
+                overTop = std::max(overTop, img->getHeight() - 32);
+                overRight = std::max(overRight,
+                                     (x - endX + 1) * 32 + img->getWidth() - 32);
+            }
+        }
+    }
+
+    if (empty)
+    {
+        chunk.empty = true;
+        return;
+    }
+
+    const int width = (endX - startX) * 32 + overRight;
+    const int height = (endY - startY) * 32 + overTop;
+
+    // Don't retry every frame when pre-rendering fails, but draw the tiles
+    // of this layer one by one instead.
+    Graphics *chunkGraphics = graphics->beginChunk(width, height);
+    if (!chunkGraphics)
+    {
+        mChunksFailed = true;
+        return;
+    }
+
+    drawTiles(chunkGraphics, startX, startY, endX, endY,
+              -startX * 32, overTop + 32 - startY * 32, Map::MAP_NORMAL);
+
+    chunk.image = graphics->endChunk(chunkGraphics);
+    chunk.offsetY = -overTop;
+
+    if (chunk.image)
+        mChunkImages++;
+    else
+        mChunksFailed = true;
+}
+
+void MapLayer::releaseChunks(int startCX, int startCY,
+                             int endCX, int endCY) const
+{
+    // Pre-rendered chunks only exist within the previously kept range
+    for (int cy = mKeptStartCY; cy < mKeptEndCY; cy++)
+    {
+        for (int cx = mKeptStartCX; cx < mKeptEndCX; cx++)
+        {
+            if (cx >= startCX && cx < endCX &&
+                cy >= startCY && cy < endCY)
+                continue;
+
+            releaseChunk(mChunks[cx + cy * mChunksX]);
+        }
+    }
+
+    mKeptStartCX = startCX;
+    mKeptStartCY = startCY;
+    mKeptEndCX = endCX;
+    mKeptEndCY = endCY;
+}
+
+void MapLayer::releaseChunk(Chunk &chunk) const
+{
+    if (!chunk.image)
+        return;
+
+    delete chunk.image;
+    chunk.image = 0;
+    mChunkImages--;
 }
 
 int MapLayer::getTileDrawWidth(int x1, int y1, int endX, int &width) const
@@ -218,12 +431,12 @@ Map::Map(int width, int height, int tileWidth, int tileHeight):
     mTileWidth(tileWidth), mTileHeight(tileHeight),
     mMaxTileHeight(height),
     mDebugFlags(MAP_NORMAL),
-    mOnClosedList(1), mOnOpenList(2),
     mLastScrollX(0.0f), mLastScrollY(0.0f)
 {
     const int size = mWidth * mHeight;
 
     mMetaTiles = new MetaTile[size];
+    mPathFinder = new PathFinder(mMetaTiles, mWidth, mHeight);
     for (int i = 0; i < NB_BLOCKTYPES; i++)
     {
         mOccupation[i] = new int[size];
@@ -234,6 +447,7 @@ Map::Map(int width, int height, int tileWidth, int tileHeight):
 Map::~Map()
 {
     // delete metadata, layers, tilesets and overlays
+    delete mPathFinder;
     delete[] mMetaTiles;
     for (int i = 0; i < NB_BLOCKTYPES; i++)
     {
@@ -321,11 +535,6 @@ void Map::addTileset(Tileset *tileset)
         mMaxTileHeight = tileset->getHeight();
 }
 
-bool actorCompare(const Actor *a, const Actor *b)
-{
-    return a->getPixelY() < b->getPixelY();
-}
-
 void Map::update(int ticks)
 {
     // Update animated tiles
@@ -337,8 +546,36 @@ void Map::update(int ticks)
     }
 }
 
+void Map::saveActorPositions()
+{
+    Actor::nextLogicTick();
+
+    for (Actors::iterator it = mActors.begin(), it_end = mActors.end();
+         it != it_end; ++it)
+    {
+        (*it)->savePosition();
+    }
+}
+
+/**
+ * Returns the profiler section of the map layer with the given index.
+ */
+static int layerSection(int index)
+{
+    static std::vector<int> sections;
+    while ((int) sections.size() <= index)
+    {
+        sections.push_back(Profiler::section("Map layer " +
+                                             toString(sections.size())));
+    }
+    return sections[index];
+}
+
 void Map::draw(Graphics *graphics, int scrollX, int scrollY)
 {
+    static const int drawSection = Profiler::section("Map::draw");
+    ProfileScope scope(drawSection);
+
     // Calculate range of tiles which are on-screen
     int endPixelY = graphics->getHeight() + scrollY + mTileHeight - 1;
     endPixelY += mMaxTileHeight - mTileHeight;
@@ -349,14 +586,17 @@ void Map::draw(Graphics *graphics, int scrollX, int scrollY)
 
     // Make sure actors are sorted ascending by Y-coordinate
     // so that they overlap correctly
-    mActors.sort(actorCompare);
+    sortActors();
+    collectVisibleActors(graphics, scrollX, scrollY);
 
     // update scrolling of all ambient layers
     updateAmbientLayers(scrollX, scrollY);
 
+    static const IntOption overlayDetail(config, "OverlayDetail");
+
     // Draw backgrounds
     drawAmbientLayers(graphics, BACKGROUND_LAYERS, scrollX, scrollY,
-                      config.getIntValue("OverlayDetail"));
+                      overlayDetail);
 
     // draw the game world
     Layers::const_iterator layeri = mLayers.begin();
@@ -369,10 +609,11 @@ void Map::draw(Graphics *graphics, int scrollX, int scrollY)
         {
             if ((*layeri)->isFringeLayer())
             {
+                ProfileScope layerScope(layerSection(layeri - mLayers.begin()));
                 (*layeri)->draw(graphics,
                                 startX, startY, endX, endY,
                                 scrollX, scrollY,
-                                mActors, mDebugFlags);
+                                mVisibleActors, mDebugFlags);
             }
         }
     }
@@ -383,17 +624,18 @@ void Map::draw(Graphics *graphics, int scrollX, int scrollY)
             if ((*layeri)->isFringeLayer() && mDebugFlags == MAP_SPECIAL2)
                 overFringe = true;
 
+            ProfileScope layerScope(layerSection(layeri - mLayers.begin()));
             (*layeri)->draw(graphics,
                             startX, startY, endX, endY,
                             scrollX, scrollY,
-                            mActors, mDebugFlags);
+                            mVisibleActors, mDebugFlags);
         }
     }
 
     // Draws beings with a lower opacity to make them visible
     // even when covered by a wall or some other elements...
-    Actors::const_iterator ai = mActors.begin();
-    while (ai != mActors.end())
+    std::vector<Actor*>::const_iterator ai = mVisibleActors.begin();
+    while (ai != mVisibleActors.end())
     {
         if (Actor *actor = *ai)
         {
@@ -409,7 +651,71 @@ void Map::draw(Graphics *graphics, int scrollX, int scrollY)
     }
 
     drawAmbientLayers(graphics, FOREGROUND_LAYERS, scrollX, scrollY,
-                      config.getIntValue("OverlayDetail"));
+                      overlayDetail);
+}
+
+void Map::sortActors()
+{
+    if (mActors.empty())
+        return;
+
+    Actors::iterator i = mActors.begin();
+    for (++i; i != mActors.end(); )
+    {
+        Actors::iterator next = i;
+        ++next;
+
+        const int y = (*i)->getPixelY();
+        Actors::iterator pos = i;
+        while (pos != mActors.begin())
+        {
+            Actors::iterator before = pos;
+            --before;
+            if ((*before)->getPixelY() <= y)
+                break;
+            pos = before;
+        }
+
+        // Splicing keeps the iterators held by the actors valid
+        if (pos != i)
+            mActors.splice(pos, mActors, i);
+
+        i = next;
+    }
+}
+
+void Map::collectVisibleActors(Graphics *graphics, int scrollX, int scrollY)
+{
+    // Leave some room for target cursors and sprite offsets
+    const int margin = 2 * mTileWidth;
+
+    const int left = scrollX - margin;
+    const int right = scrollX + graphics->getWidth() + margin;
+    const int top = scrollY - margin;
+    const int bottom = scrollY + graphics->getHeight() + margin;
+
+    mVisibleActors.clear();
+
+    for (Actors::const_iterator i = mActors.begin(), i_end = mActors.end();
+         i != i_end; ++i)
+    {
+        const Actor *actor = *i;
+        const int width = actor->getWidth();
+        const int height = actor->getHeight();
+
+        // Actors without a known size (like particles) are always drawn
+        if (width > 0 && height > 0)
+        {
+            const int x = actor->getPixelX();
+            const int y = actor->getPixelY();
+
+            if (x + width < left || x - width > right ||
+                y < top || y - height > bottom)
+                continue;
+        }
+
+        mVisibleActors.push_back(*i);
+    }
 }
 
 void Map::drawCollision(Graphics *graphics, int scrollX, int scrollY,
@@ -642,6 +948,21 @@ const std::string Map::getFilename() const
     return fileName.substr(lastSlash, lastDot - lastSlash);
 }
 
+/**
+ * Limits the collision radius of a being to what the path finding can
+ * handle.
+ */
+static int normalizeRadius(int radius)
+{
+    // FIXME: Hande beings with more than 1/2 tile radius by not letting them
+    // go or spawn in too narrow places. The server will have to be aware
+    // of being's radius value (in tiles) to handle this gracefully.
+    if (radius > 32 / 2) radius = 32 / 2;
+    // set a default value if no value returned.
+    if (radius < 1) radius = 32 / 3;
+    return radius;
+}
+
 Position Map::checkNodeOffsets(int radius, unsigned char walkMask,
                                const Position &position) const
 {
@@ -653,13 +974,7 @@ Position Map::checkNodeOffsets(int radius, unsigned char walkMask,
     int fx = position.x % 32;
     int fy = position.y % 32;
 
-    // Compute the being radius:
-    // FIXME: Hande beings with more than 1/2 tile radius by not letting them
-    // go or spawn in too narrow places. The server will have to be aware
-    // of being's radius value (in tiles) to handle this gracefully.
-    if (radius > 32 / 2) radius = 32 / 2;
-    // set a default value if no value returned.
-    if (radius < 1) radius = 32 / 3;
+    radius = normalizeRadius(radius);
 
     // We check diagonal first as they are more restrictive.
     // Top-left border check
@@ -748,196 +1063,46 @@ Path Map::findPixelPath(int startPixelX, int startPixelY, int endPixelX,
     myPath.pop_back();
     myPath.push_back(destination);
 
+    // Walk straight where nothing is in the way, instead of from tile to tile
+    mPathFinder->smoothPixelPath(myPath, startPixelX, startPixelY,
+                                 normalizeRadius(radius), walkMask);
+
     return myPath;
 }
 
 Path Map::findPath(int startX, int startY, int destX, int destY,
                    unsigned char walkmask, int maxCost)
 {
-    static int const basicCost = 100;
-
-    // Path to be built up (empty by default)
-    Path path;
-
-    // Declare open list, a list with open tiles sorted on F cost
-    std::priority_queue<Location> openList;
-
-    // Return when destination not walkable
-    if (!getWalk(destX, destY, walkmask))
-        return path;
-
-    // Reset starting tile's G cost to 0
-    MetaTile *startTile = getMetaTile(startX, startY);
-    startTile->Gcost = 0;
-
-    // Add the start point to the open list
-    openList.push(Location(startX, startY, startTile));
+    // Walking through beings costs extra, so collect where they are once
+    // instead of checking each tile that is looked at
+    std::vector<Position> occupied;
 
-    bool foundPath = false;
-
-    // Keep trying new open tiles until no more tiles to try or target found
-    while (!openList.empty() && !foundPath)
+    if (actorSpriteManager)
     {
-        // Take the location with the lowest F cost from the open list.
-        Location curr = openList.top();
-        openList.pop();
-
-        // If the tile is already on the closed list, this means it has already
-        // been processed with a shorter path to the start point (lower G cost)
-        if (curr.tile->whichList == mOnClosedList)
+        // Each step costs at least one tile, so the search stays within
+        // maxCost tiles of the start
+        std::vector<ActorSprite*> actors;
+        actorSpriteManager->findInTiles(startX - maxCost, startY - maxCost,
+                                        startX + maxCost, startY + maxCost,
+                                        actors);
+
+        std::vector<ActorSprite*>::const_iterator it, it_end;
+        for (it = actors.begin(), it_end = actors.end(); it != it_end; it++)
         {
-            continue;
-        }
-
-        // Put the current tile on the closed list
-        curr.tile->whichList = mOnClosedList;
-
-        // Check the adjacent tiles
-        for (int dy = -1; dy <= 1; dy++)
-        {
-            for (int dx = -1; dx <= 1; dx++)
-            {
-                // Calculate location of tile to check
-                const int x = curr.x + dx;
-                const int y = curr.y + dy;
-
-                // Skip if if we're checking the same tile we're leaving from,
-                // or if the new location falls outside of the map boundaries
-                if ((dx == 0 && dy == 0) || !contains(x, y))
-                {
-                    continue;
-                }
-
-                MetaTile *newTile = getMetaTile(x, y);
-
-                // Skip if the tile is on the closed list or is not walkable
-                // unless its the destination tile
-                if (newTile->whichList == mOnClosedList ||
-                    ((newTile->blockmask & walkmask)
-                     && !(x == destX && y == destY)))
-                {
-                    continue;
-                }
-
-                // When taking a diagonal step, verify that we can skip the
-                // corner.
-                if (dx != 0 && dy != 0)
-                {
-                    MetaTile *t1 = getMetaTile(curr.x, curr.y + dy);
-                    MetaTile *t2 = getMetaTile(curr.x + dx, curr.y);
-
-                    if ((t1->blockmask | t2->blockmask) & BLOCKMASK_WALL)
-                        continue;
-                }
-
-                // Calculate G cost for this route, ~sqrt(2) for moving diagonal
-                int Gcost = curr.tile->Gcost +
-                    (dx == 0 || dy == 0 ? basicCost : basicCost * 362 / 256);
-
-                /* Demote an arbitrary direction to speed pathfinding by
-                   adding a defect (TODO: change depending on the desired
-                   visual effect, e.g. a cross-product defect toward
-                   destination).
-                   Important: as long as the total defect along any path is
-                   less than the basicCost, the pathfinder will still find one
-                   of the shortest paths! */
-                if (dx == 0 || dy == 0)
-                {
-                    // Demote horizontal and vertical directions, so that two
-                    // consecutive directions cannot have the same Fcost.
-                    ++Gcost;
-                }
-
-                // It costs extra to walk through a being (needs to be enough
-                // to make it more attractive to walk around).
-                if (occupied(x, y))
-                {
-                    Gcost += 3 * basicCost;
-                }
-
-                // Skip if Gcost becomes too much
-                // Warning: probably not entirely accurate
-                if (Gcost > maxCost * basicCost)
-                {
-                    continue;
-                }
-
-                if (newTile->whichList != mOnOpenList)
-                {
-                    // Found a new tile (not on open nor on closed list)
-
-                    /* Update Hcost of the new tile. The pathfinder does not
-                       work reliably if the heuristic cost is higher than the
-                       real cost. In particular, using Manhattan distance is
-                       forbidden here. */
-                    int dx = std::abs(x - destX), dy = std::abs(y - destY);
-                    newTile->Hcost = std::abs(dx - dy) * basicCost +
-                        std::min(dx, dy) * (basicCost * 362 / 256);
-
-                    // Set the current tile as the parent of the new tile
-                    newTile->parentX = curr.x;
-                    newTile->parentY = curr.y;
-
-                    // Update Gcost and Fcost of new tile
-                    newTile->Gcost = Gcost;
-                    newTile->Fcost = Gcost + newTile->Hcost;
-
-                    if (x != destX || y != destY)
-                    {
-                        // Add this tile to the open list
-                        newTile->whichList = mOnOpenList;
-                        openList.push(Location(x, y, newTile));
-                    }
-                    else
-                    {
-                        // Target location was found
-                        foundPath = true;
-                    }
-                }
-                else if (Gcost < newTile->Gcost)
-                {
-                    // Found a shorter route.
-                    // Update Gcost and Fcost of the new tile
-                    newTile->Gcost = Gcost;
-                    newTile->Fcost = Gcost + newTile->Hcost;
-
-                    // Set the current tile as the parent of the new tile
-                    newTile->parentX = curr.x;
-                    newTile->parentY = curr.y;
-
-                    // Add this tile to the open list (it's already
-                    // there, but this instance has a lower F score)
-                    openList.push(Location(x, y, newTile));
-                }
-            }
+            const ActorSprite *actor = *it;
+            if (actor->getType() != ActorSprite::FLOOR_ITEM)
+                occupied.push_back(Position(actor->getTileX(),
+                                            actor->getTileY()));
         }
     }
 
-    // Two new values to indicate whether a tile is on the open or closed list,
-    // this way we don't have to clear all the values between each pathfinding.
-    mOnClosedList += 2;
-    mOnOpenList += 2;
-
-    // If a path has been found, iterate backwards using the parent locations
-    // to extract it.
-    if (foundPath)
-    {
-        int pathX = destX;
-        int pathY = destY;
-
-        while (pathX != startX || pathY != startY)
-        {
-            // Add the new path node to the start of the path list
-            path.push_front(Position(pathX, pathY));
-
-            // Find out the next parent
-            MetaTile *tile = getMetaTile(pathX, pathY);
-            pathX = tile->parentX;
-            pathY = tile->parentY;
-        }
-    }
+    return mPathFinder->findPath(startX, startY, destX, destY, walkmask,
+                                 maxCost, occupied);
+}
 
-    return path;
+int Map::getPathCost(int x, int y) const
+{
+    return mPathFinder->getCost(x, y);
 }
 
 void Map::addParticleEffect(const std::string &effectFile, int x, int y, int w, int h)
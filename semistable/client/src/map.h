@@ -32,8 +32,10 @@
 class Animation;
 class AmbientLayer;
 class Graphics;
+class ImageChunk;
 class MapLayer;
 class Particle;
+class PathFinder;
 class SimpleAnimation;
 class Tileset;
 
@@ -50,15 +52,8 @@ struct MetaTile
     /**
      * Constructor.
      */
-    MetaTile() : whichList(0), blockmask(0) {}
-
-    // Pathfinding members
-    int Fcost;               /**< Estimation of total path cost */
-    int Gcost;               /**< Cost from start to this location */
-    int Hcost;               /**< Estimated cost to goal */
-    int whichList;           /**< No list, open list or closed list */
-    int parentX;             /**< X coordinate of parent tile */
-    int parentY;             /**< Y coordinate of parent tile */
+    MetaTile() : blockmask(0) {}
+
     unsigned char blockmask; /**< Blocking properties of this tile */
 };
 
@@ -71,8 +66,7 @@ class TileAnimation
         TileAnimation(Animation *ani);
         ~TileAnimation();
         void update(int ticks = 1);
-        void addAffectedTile(MapLayer *layer, int index)
-        { mAffected.push_back(std::make_pair(layer, index)); }
+        void addAffectedTile(MapLayer *layer, int index);
     private:
         std::list<std::pair<MapLayer*, int> > mAffected;
         SimpleAnimation *mAnimation;
@@ -106,7 +100,13 @@ class MapLayer
         /**
          * Set tile image with x + y * width already known.
          */
-        void setTile(int index, Image *img) { mTiles[index] = img; }
+        void setTile(int index, Image *img);
+
+        /**
+         * Marks the tile at the given index as animated. Animated tiles are
+         * not pre-rendered, since they change too often.
+         */
+        void setTileAnimated(int index);
 
         /**
          * Get tile image, with x and y in layer coordinates.
@@ -125,7 +125,7 @@ class MapLayer
                   int startX, int startY,
                   int endX, int endY,
                   int scrollX, int scrollY,
-                  const Actors &actors,
+                  const std::vector<Actor*> &actors,
                   int mDebugFlags) const;
 
         bool isFringeLayer()
@@ -134,10 +134,77 @@ class MapLayer
         int getTileDrawWidth(int x1, int y1, int endX, int &width) const;
 
     private:
+        /**
+         * A block of CHUNK_SIZE x CHUNK_SIZE tiles, pre-rendered so that it
+         * can be drawn with a single call. Tiles that are larger than a
+         * single tile make the image extend above and to the right of the
+         * block.
+         */
+        struct Chunk
+        {
+            Chunk():
+                image(0), offsetY(0), empty(false), animated(false)
+            {}
+
+            ImageChunk *image;  /**< Pre-rendered tiles, if up to date. */
+            int offsetY;        /**< Top of the image relative to the block. */
+            bool empty;         /**< Known to contain no tiles. */
+            bool animated;      /**< Contains animated tiles. */
+        };
+
+        /**
+         * Draws tiles one by one, the way the fringe layer and animated
+         * chunks are drawn.
+         */
+        void drawTiles(Graphics *graphics,
+                       int startX, int startY,
+                       int endX, int endY,
+                       int dx, int dy,
+                       int debugFlags) const;
+
+        /**
+         * Draws the given range of tiles using pre-rendered chunks.
+         */
+        void drawChunks(Graphics *graphics,
+                        int startX, int startY,
+                        int endX, int endY,
+                        int dx, int dy) const;
+
+        /**
+         * Pre-renders the chunk at the given chunk coordinates.
+         */
+        void renderChunk(Graphics *graphics, int cx, int cy) const;
+
+        /**
+         * Frees the pre-rendered chunks within the previously kept chunk
+         * range that fall outside of the given one, and remembers the given
+         * range as the kept one.
+         */
+        void releaseChunks(int startCX, int startCY,
+                           int endCX, int endCY) const;
+
+        /**
+         * Frees the pre-rendered image of the given chunk, if any.
+         */
+        void releaseChunk(Chunk &chunk) const;
+
+        /**
+         * Returns the chunk containing the tile with the given index.
+         */
+        Chunk &getChunk(int index) const;
+
         int mX, mY;
         int mWidth, mHeight;
         bool mIsFringeLayer;    /**< Whether the actors are drawn. */
         Image **mTiles;
+
+        int mChunksX, mChunksY; /**< Number of chunks in each direction. */
+        mutable std::vector<Chunk> mChunks;
+
+        /** Chunk range whose pre-rendered images are kept (end exclusive). */
+        mutable int mKeptStartCX, mKeptStartCY, mKeptEndCX, mKeptEndCY;
+        mutable int mChunkImages;   /**< Number of pre-rendered chunks. */
+        mutable bool mChunksFailed; /**< Pre-rendering is not available. */
 };
 
 /**
@@ -192,6 +259,12 @@ class Map : public Properties
          */
         void update(int ticks = 1);
 
+        /**
+         * Starts a new logic tick, remembering the positions of the actors
+         * on the map so that drawing can interpolate from there.
+         */
+        void saveActorPositions();
+
         /**
          * Draws the map to the given graphics output. This method draws all
          * layers, actors and overlay effects.
@@ -298,6 +371,12 @@ class Map : public Properties
         Path findPath(int startX, int startY, int destX, int destY,
                       unsigned char walkmask, int maxCost = 20);
 
+        /**
+         * Returns the cost of the route to the given tile in the last path
+         * search, or -1 when the search didn't get there.
+         */
+        int getPathCost(int x, int y) const;
+
         /**
          * Adds a particle effect
          */
@@ -344,6 +423,20 @@ class Map : public Properties
             BACKGROUND_LAYERS
         };
 
+        /**
+         * Restores the ascending Y order of the actors. Since actors move only
+         * a little between frames, this is an insertion sort that only does
+         * work for the actors that moved past one another.
+         */
+        void sortActors();
+
+        /**
+         * Collects the actors that may be visible on the screen into
+         * mVisibleActors, keeping their order.
+         */
+        void collectVisibleActors(Graphics *graphics,
+                                  int scrollX, int scrollY);
+
         /**
          * Updates scrolling of ambient layers. Has to be called each game tick.
          */
@@ -371,13 +464,13 @@ class Map : public Properties
         MetaTile *mMetaTiles;
         Layers mLayers;
         Tilesets mTilesets;
-        Actors mActors;
+        Actors mActors;                     /**< Sorted ascending by Y. */
+        std::vector<Actor*> mVisibleActors; /**< Reused each frame. */
 
         // debug flags
         int mDebugFlags;
 
-        // Pathfinding members
-        int mOnClosedList, mOnOpenList;
+        PathFinder *mPathFinder;
 
         // Overlay data
         std::list<AmbientLayer*> mBackgrounds;
@@ -138,34 +138,39 @@ void connectToServer(const ServerInfo &server)
     }
     else
     {
-        if (networkType != ServerInfo::UNKNOWN && getGeneralHandler() != NULL)
-        {
-            getGeneralHandler()->unload();
-        }
+        loadNetcode(server.type);
+    }
 
-        switch (server.type)
-        {
-            case ServerInfo::MANASERV:
-                new ManaServ::GeneralHandler;
-                break;
+    getLoginHandler()->setServer(server);
 
-            case ServerInfo::TMWATHENA:
-                new TmwAthena::GeneralHandler;
-                break;
+    getLoginHandler()->connect();
+}
 
-            default:
-                // Shouldn't happen...
-                break;
-        }
+void loadNetcode(ServerInfo::Type type)
+{
+    if (networkType != ServerInfo::UNKNOWN && getGeneralHandler() != NULL)
+    {
+        getGeneralHandler()->unload();
+    }
+
+    switch (type)
+    {
+        case ServerInfo::MANASERV:
+            new ManaServ::GeneralHandler;
+            break;
 
-        getGeneralHandler()->load();
+        case ServerInfo::TMWATHENA:
+            new TmwAthena::GeneralHandler;
+            break;
 
-        networkType = server.type;
+        default:
+            // Shouldn't happen...
+            break;
     }
 
-    getLoginHandler()->setServer(server);
+    getGeneralHandler()->load();
 
-    getLoginHandler()->connect();
+    networkType = type;
 }
 
 void unload()
@@ -69,6 +69,11 @@ ServerInfo::Type getNetworkType();
  */
 void connectToServer(const ServerInfo &server);
 
+/**
+ * Sets up the handlers of the given type of server, without connecting.
+ */
+void loadNetcode(ServerInfo::Type type);
+
 void unload();
 
 } // namespace Net
@@ -46,7 +46,8 @@ GLuint OpenGLGraphics::mLastImage = 0;
 
 OpenGLGraphics::OpenGLGraphics():
     mAlpha(false), mTexture(false), mColorAlpha(false),
-    mSync(false)
+    mSync(false),
+    mChunkList(0)
 {
     mFloatTexArray = new GLfloat[vertexBufSize * 4];
     mIntTexArray = new GLint[vertexBufSize * 4];
@@ -264,6 +265,7 @@ bool OpenGLGraphics::drawImage(Image *image, int srcX, int srcY,
     setTexturingAndBlending(true);
 
     drawQuad(image, srcX, srcY, dstX, dstY, width, height);
+    ++mDrawCalls;
 
     if (!useColor)
     {
@@ -323,6 +325,7 @@ bool OpenGLGraphics::drawRescaledImage(Image *image, int srcX, int srcY,
     // Draw a textured quad.
     drawRescaledQuad(image, srcX, srcY, dstX, dstY, width, height,
                      desiredWidth, desiredHeight);
+    ++mDrawCalls;
 
     if (smooth) // A basic smooth effect...
     {
@@ -336,6 +339,7 @@ bool OpenGLGraphics::drawRescaledImage(Image *image, int srcX, int srcY,
                          desiredWidth - 1, desiredHeight);
         drawRescaledQuad(image, srcX, srcY, dstX, dstY + 1, width, height,
                          desiredWidth, desiredHeight - 1);
+        mDrawCalls += 4;
     }
 
     if (!useColor)
@@ -610,6 +614,173 @@ void OpenGLGraphics::drawRescaledImagePattern(Image *image, int x, int y,
     glColor4ub(mColor.r, mColor.g, mColor.b, mColor.a);
 }
 
+void OpenGLGraphics::drawImageParts(Image *image,
+                                    const ImagePart *parts, int count)
+{
+    if (!image || count <= 0)
+        return;
+
+    const int srcX = image->mBounds.x;
+    const int srcY = image->mBounds.y;
+
+    const float tw = static_cast<float>(image->getTextureWidth());
+    const float th = static_cast<float>(image->getTextureHeight());
+
+    glColor4f(1.0f, 1.0f, 1.0f, image->mAlpha);
+
+    bindTexture(Image::mTextureType, image->mGLImage);
+
+    setTexturingAndBlending(true);
+
+    unsigned int vp = 0;
+    const unsigned int vLimit = vertexBufSize * 4;
+    const bool normalized = image->getTextureType() == GL_TEXTURE_2D;
+
+    // Draw all parts as one array of textured rectangles
+    for (int i = 0; i < count; ++i)
+    {
+        const ImagePart &part = parts[i];
+        const int sx = srcX + part.srcX;
+        const int sy = srcY + part.srcY;
+
+        if (normalized)
+        {
+            const float texX1 = static_cast<float>(sx) / tw;
+            const float texY1 = static_cast<float>(sy) / th;
+            const float texX2 = static_cast<float>(sx + part.width) / tw;
+            const float texY2 = static_cast<float>(sy + part.height) / th;
+
+            mFloatTexArray[vp + 0] = texX1;
+            mFloatTexArray[vp + 1] = texY1;
+
+            mFloatTexArray[vp + 2] = texX2;
+            mFloatTexArray[vp + 3] = texY1;
+
+            mFloatTexArray[vp + 4] = texX2;
+            mFloatTexArray[vp + 5] = texY2;
+
+            mFloatTexArray[vp + 6] = texX1;
+            mFloatTexArray[vp + 7] = texY2;
+        }
+        else
+        {
+            mIntTexArray[vp + 0] = sx;
+            mIntTexArray[vp + 1] = sy;
+
+            mIntTexArray[vp + 2] = sx + part.width;
+            mIntTexArray[vp + 3] = sy;
+
+            mIntTexArray[vp + 4] = sx + part.width;
+            mIntTexArray[vp + 5] = sy + part.height;
+
+            mIntTexArray[vp + 6] = sx;
+            mIntTexArray[vp + 7] = sy + part.height;
+        }
+
+        mIntVertArray[vp + 0] = part.dstX;
+        mIntVertArray[vp + 1] = part.dstY;
+
+        mIntVertArray[vp + 2] = part.dstX + part.width;
+        mIntVertArray[vp + 3] = part.dstY;
+
+        mIntVertArray[vp + 4] = part.dstX + part.width;
+        mIntVertArray[vp + 5] = part.dstY + part.height;
+
+        mIntVertArray[vp + 6] = part.dstX;
+        mIntVertArray[vp + 7] = part.dstY + part.height;
+
+        vp += 8;
+        if (vp >= vLimit)
+        {
+            if (normalized)
+                drawQuadArrayfi(vp);
+            else
+                drawQuadArrayii(vp);
+            vp = 0;
+        }
+    }
+
+    if (vp > 0)
+    {
+        if (normalized)
+            drawQuadArrayfi(vp);
+        else
+            drawQuadArrayii(vp);
+    }
+
+    glColor4ub(static_cast<GLubyte>(mColor.r),
+               static_cast<GLubyte>(mColor.g),
+               static_cast<GLubyte>(mColor.b),
+               static_cast<GLubyte>(mColor.a));
+}
+
+/**
+ * A chunk recorded into an OpenGL display list.
+ */
+class GLImageChunk : public ImageChunk
+{
+    public:
+        GLImageChunk(GLuint list):
+            mList(list)
+        {}
+
+        ~GLImageChunk()
+        { glDeleteLists(mList, 1); }
+
+        GLuint getList() const
+        { return mList; }
+
+    private:
+        GLuint mList;
+};
+
+Graphics *OpenGLGraphics::beginChunk(int width, int height)
+{
+    GLuint list = glGenLists(1);
+    if (!list)
+        return NULL;
+
+    // Make sure the state the recorded draw calls rely on is really set,
+    // since the state changes themselves are not executed while compiling.
+    setTexturingAndBlending(true);
+    mLastImage = 0;
+
+    mChunkList = list;
+    glNewList(list, GL_COMPILE);
+
+    return this;
+}
+
+ImageChunk *OpenGLGraphics::endChunk(Graphics *)
+{
+    glEndList();
+
+    // Texture bindings were only recorded, not executed
+    mLastImage = 0;
+
+    GLuint list = mChunkList;
+    mChunkList = 0;
+    return new GLImageChunk(list);
+}
+
+void OpenGLGraphics::drawChunk(const ImageChunk *chunk, int x, int y)
+{
+    setTexturingAndBlending(true);
+
+    glPushMatrix();
+    glTranslatef(x, y, 0);
+    glCallList(static_cast<const GLImageChunk*>(chunk)->getList());
+    ++mDrawCalls;
+    glPopMatrix();
+
+    // The list has bound textures and changed the current color
+    mLastImage = 0;
+    glColor4ub(static_cast<GLubyte>(mColor.r),
+               static_cast<GLubyte>(mColor.g),
+               static_cast<GLubyte>(mColor.b),
+               static_cast<GLubyte>(mColor.a));
+}
+
 void OpenGLGraphics::updateScreen()
 {
     glFlush();
@@ -739,6 +910,7 @@ void OpenGLGraphics::drawPoint(int x, int y)
     glBegin(GL_POINTS);
     glVertex2i(x, y);
     glEnd();
+    ++mDrawCalls;
 }
 
 void OpenGLGraphics::drawLine(int x1, int y1, int x2, int y2)
@@ -753,6 +925,7 @@ void OpenGLGraphics::drawLine(int x1, int y1, int x2, int y2)
     glBegin(GL_POINTS);
     glVertex2f(x2 + 0.5f, y2 + 0.5f);
     glEnd();
+    mDrawCalls += 2;
 }
 
 void OpenGLGraphics::drawRectangle(const gcn::Rectangle& rect)
@@ -825,6 +998,7 @@ void OpenGLGraphics::drawRectangle(const gcn::Rectangle& rect, bool filled)
 
     glVertexPointer(2, GL_FLOAT, 0, &vert);
     glDrawArrays(filled ? GL_QUADS : GL_LINE_LOOP, 0, 4);
+    ++mDrawCalls;
 
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 }
@@ -844,6 +1018,7 @@ inline void OpenGLGraphics::drawQuadArrayfi(int size)
     glTexCoordPointer(2, GL_FLOAT, 0, mFloatTexArray);
 
     glDrawArrays(GL_QUADS, 0, size / 2);
+    ++mDrawCalls;
 }
 
 inline void OpenGLGraphics::drawQuadArrayii(int size)
@@ -852,6 +1027,7 @@ inline void OpenGLGraphics::drawQuadArrayii(int size)
     glTexCoordPointer(2, GL_INT, 0, mIntTexArray);
 
     glDrawArrays(GL_QUADS, 0, size / 2);
+    ++mDrawCalls;
 }
 
 #endif // USE_OPENGL
@@ -83,6 +83,14 @@ class OpenGLGraphics : public Graphics
                                       int x, int y, int w, int h,
                                       int scaledWidth, int scaledHeight);
 
+        void drawImageParts(Image *image, const ImagePart *parts, int count);
+
+        Graphics *beginChunk(int width, int height);
+
+        ImageChunk *endChunk(Graphics *chunkGraphics);
+
+        void drawChunk(const ImageChunk *chunk, int x, int y);
+
         void updateScreen();
 
         void _beginDraw();
@@ -128,6 +136,7 @@ class OpenGLGraphics : public Graphics
         bool mAlpha, mTexture;
         bool mColorAlpha;
         bool mSync;
+        GLuint mChunkList;  /**< Display list being recorded, if any. */
 };
 
 #endif
@@ -22,21 +22,18 @@
 #include <algorithm>
 #include <cmath>
 
-#include "animationparticle.h"
 #include "configuration.h"
-#include "imageparticle.h"
 #include "log.h"
 #include "map.h"
 #include "particle.h"
 #include "particleemitter.h"
-#include "rotationalparticle.h"
 #include "textparticle.h"
 
+#include "resources/particleeffectdef.h"
 #include "resources/resourcemanager.h"
 
 #include "utils/dtor.h"
 #include "utils/mathutils.h"
-#include "utils/xml.h"
 
 #include <guichan/color.hpp>
 
@@ -51,6 +48,7 @@ class Image;
 int Particle::particleCount = 0;
 int Particle::maxCount = 0;
 int Particle::fastPhysics = 0;
+bool Particle::batching = true;
 int Particle::emitterSkip = 1;
 bool Particle::enabled = true;
 const float Particle::PARTICLE_SKY = 800.0f;
@@ -90,6 +88,7 @@ void Particle::setupEngine()
     Particle::fastPhysics = config.getIntValue("particleFastPhysics");
     Particle::emitterSkip = config.getIntValue("particleEmitterSkip") + 1;
     Particle::enabled = config.getBoolValue("particleeffects");
+    Particle::batching = config.getBoolValue("particleBatching");
     disableAutoDelete();
     logger->log("Particle engine set up");
 }
@@ -191,7 +190,8 @@ bool Particle::update()
             for (EmitterIterator e = mChildEmitters.begin();
                  e != mChildEmitters.end(); e++)
             {
-                Particles newParticles = (*e)->createParticles(mLifetimePast);
+                Particles newParticles = (*e)->createParticles(mLifetimePast,
+                                                               this);
                 for (ParticleIterator p = newParticles.begin();
                      p != newParticles.end(); p++)
                 {
@@ -261,81 +261,23 @@ Particle *Particle::createChild()
 Particle *Particle::addEffect(const std::string &particleEffectFile,
                               int pixelX, int pixelY, int rotation)
 {
-    Particle *newParticle = NULL;
-
-    XML::Document doc(particleEffectFile);
-    xmlNodePtr rootNode = doc.rootNode();
+    ResourceManager *resman = ResourceManager::getInstance();
+    ParticleEffectDef *effect = resman->getParticleEffect(particleEffectFile);
 
-    if (!rootNode || !xmlStrEqual(rootNode->name, BAD_CAST "effect"))
+    if (!effect)
     {
         logger->log("Error loading particle: %s", particleEffectFile.c_str());
         return NULL;
     }
 
-    ResourceManager *resman = ResourceManager::getInstance();
-
-    // Parse particles
-    for_each_xml_child_node(effectChildNode, rootNode)
-    {
-        // We're only interested in particles
-        if (!xmlStrEqual(effectChildNode->name, BAD_CAST "particle"))
-            continue;
-
-        // Determine the exact particle type
-        xmlNodePtr node;
-
-        // Animation
-        if ((node = XML::findFirstChildByName(effectChildNode, "animation")))
-        {
-            newParticle = new AnimationParticle(mMap, node);
-        }
-        // Rotational
-        else if ((node = XML::findFirstChildByName(effectChildNode, "rotation")))
-        {
-            newParticle = new RotationalParticle(mMap, node);
-        }
-        // Image
-        else if ((node = XML::findFirstChildByName(effectChildNode, "image")))
-        {
-            Image *img= resman->getImage((const char*)
-                    node->xmlChildrenNode->content);
-
-            newParticle = new ImageParticle(mMap, img);
-        }
-        // Other
-        else
-        {
-            newParticle = new Particle(mMap);
-        }
-
-        // Read and set the basic properties of the particle
-        float offsetX = XML::getFloatProperty(effectChildNode, "position-x", 0);
-        float offsetY = XML::getFloatProperty(effectChildNode, "position-y", 0);
-        float offsetZ = XML::getFloatProperty(effectChildNode, "position-z", 0);
-        Vector position (mPos.x + (float)pixelX + offsetX,
-                         mPos.y + (float)pixelY + offsetY,
-                         mPos.z + offsetZ);
-        newParticle->moveTo(position);
-
-        int lifetime = XML::getProperty(effectChildNode, "lifetime", -1);
-        newParticle->setLifetime(lifetime);
-        bool resizeable = "false" != XML::getProperty(effectChildNode, "size-adjustable", "false");
-        newParticle->setAllowSizeAdjust(resizeable);
-
-        // Look for additional emitters for this particle
-        for_each_xml_child_node(emitterNode, effectChildNode)
-        {
-            if (!xmlStrEqual(emitterNode->name, BAD_CAST "emitter"))
-                continue;
-
-            ParticleEmitter *newEmitter;
-            newEmitter = new ParticleEmitter(emitterNode, newParticle, mMap,
-                                             rotation);
-            newParticle->addEmitter(newEmitter);
-        }
-
-        mChildParticles.push_back(newParticle);
-    }
+    // The definition stays cached as an orphaned resource for a while after
+    // being released, so effects spawned repeatedly are only parsed once
+    Vector position(mPos.x + (float) pixelX,
+                    mPos.y + (float) pixelY,
+                    mPos.z);
+    Particle *newParticle = effect->instantiate(mMap, position, rotation,
+                                                mChildParticles);
+    effect->decRef();
 
     return newParticle;
 }
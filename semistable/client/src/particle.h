@@ -50,6 +50,7 @@ class Particle : public Actor
         static int maxCount;             /**< Maximum number of particles */
         static int emitterSkip;          /**< Duration of pause between two emitter updates in ticks */
         static bool enabled;   /**< true when non-crucial particle effects are disabled */
+        static bool batching;  /**< Whether plain image particles are batched */
 
         /**
          * Constructor.
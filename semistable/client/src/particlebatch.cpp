@@ -0,0 +1,305 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "particlebatch.h"
+
+#include "graphics.h"
+
+#include "resources/image.h"
+
+#include "utils/mathutils.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#define SIN45 0.707106781f
+
+ParticleBatch::ParticleBatch(Map *map, Image *image,
+                             Particle *parent, Particle *target):
+    Particle(map),
+    mImage(image),
+    mParent(parent),
+    mParticleTarget(target)
+{
+    if (mImage)
+        mImage->incRef();
+}
+
+ParticleBatch::~ParticleBatch()
+{
+    Particle::particleCount -= size();
+
+    if (mImage)
+        mImage->decRef();
+}
+
+void ParticleBatch::add(const Spawn &spawn)
+{
+    mParticleX.push_back(spawn.position.x);
+    mParticleY.push_back(spawn.position.y);
+    mParticleZ.push_back(spawn.position.z);
+    mParticleVelX.push_back(spawn.velocity.x);
+    mParticleVelY.push_back(spawn.velocity.y);
+    mParticleVelZ.push_back(spawn.velocity.z);
+    mParticleLifetimeLeft.push_back(spawn.lifetime);
+    mParticleLifetimePast.push_back(0);
+    mParticleDead.push_back(0);
+
+    mParticleGravity.push_back(spawn.gravity);
+    mParticleRandomness.push_back(spawn.randomness);
+    mParticleBounce.push_back(spawn.bounce);
+    mParticleAcceleration.push_back(spawn.acceleration);
+    mParticleMomentum.push_back(spawn.momentum);
+    mParticleInvDieDistance.push_back(1.0f / spawn.dieDistance);
+    mParticleFadeOut.push_back(spawn.fadeOut);
+    mParticleFadeIn.push_back(spawn.fadeIn);
+    mParticleAlpha.push_back(spawn.alpha);
+
+    Particle::particleCount++;
+}
+
+void ParticleBatch::remove(int i)
+{
+    const int last = size() - 1;
+
+    if (i != last)
+    {
+        mParticleX[i] = mParticleX[last];
+        mParticleY[i] = mParticleY[last];
+        mParticleZ[i] = mParticleZ[last];
+        mParticleVelX[i] = mParticleVelX[last];
+        mParticleVelY[i] = mParticleVelY[last];
+        mParticleVelZ[i] = mParticleVelZ[last];
+        mParticleLifetimeLeft[i] = mParticleLifetimeLeft[last];
+        mParticleLifetimePast[i] = mParticleLifetimePast[last];
+        mParticleDead[i] = mParticleDead[last];
+
+        mParticleGravity[i] = mParticleGravity[last];
+        mParticleRandomness[i] = mParticleRandomness[last];
+        mParticleBounce[i] = mParticleBounce[last];
+        mParticleAcceleration[i] = mParticleAcceleration[last];
+        mParticleMomentum[i] = mParticleMomentum[last];
+        mParticleInvDieDistance[i] = mParticleInvDieDistance[last];
+        mParticleFadeOut[i] = mParticleFadeOut[last];
+        mParticleFadeIn[i] = mParticleFadeIn[last];
+        mParticleAlpha[i] = mParticleAlpha[last];
+    }
+
+    // Shrinking keeps the capacity, so the slot is reused by the next spawn
+    mParticleX.pop_back();
+    mParticleY.pop_back();
+    mParticleZ.pop_back();
+    mParticleVelX.pop_back();
+    mParticleVelY.pop_back();
+    mParticleVelZ.pop_back();
+    mParticleLifetimeLeft.pop_back();
+    mParticleLifetimePast.pop_back();
+    mParticleDead.pop_back();
+
+    mParticleGravity.pop_back();
+    mParticleRandomness.pop_back();
+    mParticleBounce.pop_back();
+    mParticleAcceleration.pop_back();
+    mParticleMomentum.pop_back();
+    mParticleInvDieDistance.pop_back();
+    mParticleFadeOut.pop_back();
+    mParticleFadeIn.pop_back();
+    mParticleAlpha.pop_back();
+
+    Particle::particleCount--;
+}
+
+bool ParticleBatch::update()
+{
+    if (!mMap)
+        return false;
+
+    const int count = size();
+
+    if (count > 0)
+    {
+        float *x = &mParticleX[0];
+        float *y = &mParticleY[0];
+        float *z = &mParticleZ[0];
+        float *vx = &mParticleVelX[0];
+        float *vy = &mParticleVelY[0];
+        float *vz = &mParticleVelZ[0];
+        int *left = &mParticleLifetimeLeft[0];
+        int *past = &mParticleLifetimePast[0];
+        char *dead = &mParticleDead[0];
+
+        // Particles die at the start of the tick their lifetime runs out
+        for (int i = 0; i < count; ++i)
+            dead[i] = (left[i] == 0);
+
+        const float *momentum = &mParticleMomentum[0];
+        for (int i = 0; i < count; ++i)
+        {
+            vx[i] *= momentum[i];
+            vy[i] *= momentum[i];
+            vz[i] *= momentum[i];
+        }
+
+        if (mParticleTarget)
+        {
+            const Vector &target = mParticleTarget->getPosition();
+            const float *acceleration = &mParticleAcceleration[0];
+            const float *invDieDistance = &mParticleInvDieDistance[0];
+
+            for (int i = 0; i < count; ++i)
+            {
+                if (acceleration[i] == 0.0f)
+                    continue;
+
+                const float dx = (mPos.x + x[i] - target.x) * SIN45;
+                const float dy = mPos.y + y[i] - target.y;
+                const float dz = mPos.z + z[i] - target.z;
+                float invHypotenuse;
+
+                switch (Particle::fastPhysics)
+                {
+                    case 1:
+                        invHypotenuse = fastInvSqrt(dx * dx + dy * dy + dz * dz);
+                        break;
+                    case 2:
+                        invHypotenuse = 2.0f / fabs(dx) + fabs(dy) + fabs(dz);
+                        break;
+                    default:
+                        invHypotenuse = 1.0f / sqrt(dx * dx + dy * dy + dz * dz);
+                        break;
+                }
+
+                if (invHypotenuse)
+                {
+                    if (invDieDistance[i] > 0.0f &&
+                        invHypotenuse > invDieDistance[i])
+                        dead[i] = 1;
+
+                    const float accFactor = invHypotenuse * acceleration[i];
+                    vx[i] -= dx * accFactor;
+                    vy[i] -= dy * accFactor;
+                    vz[i] -= dz * accFactor;
+                }
+            }
+        }
+
+        const int *randomness = &mParticleRandomness[0];
+        for (int i = 0; i < count; ++i)
+        {
+            const int r = randomness[i];
+            if (r > 0)
+            {
+                vx[i] += (rand() % r - rand() % r) / 1000.0f;
+                vy[i] += (rand() % r - rand() % r) / 1000.0f;
+                vz[i] += (rand() % r - rand() % r) / 1000.0f;
+            }
+        }
+
+        const float *gravity = &mParticleGravity[0];
+        for (int i = 0; i < count; ++i)
+        {
+            vz[i] -= gravity[i];
+
+            x[i] += vx[i];
+            y[i] += vy[i] * SIN45;
+            z[i] += vz[i] * SIN45;
+
+            left[i] -= (left[i] > 0);
+            past[i]++;
+        }
+
+        // Bounce off the ground or die when leaving the vertical range
+        const float *bounce = &mParticleBounce[0];
+        for (int i = 0; i < count; ++i)
+        {
+            const float absoluteZ = mPos.z + z[i];
+            if (absoluteZ <= PARTICLE_SKY && absoluteZ >= 0.0f)
+                continue;
+
+            if (bounce[i] > 0.0f)
+            {
+                z[i] = -absoluteZ * bounce[i] - mPos.z;
+                vx[i] *= bounce[i];
+                vy[i] *= bounce[i];
+                vz[i] *= -bounce[i];
+            }
+            else
+            {
+                dead[i] = 1;
+            }
+        }
+
+        // Recycle the slots of dead particles, back to front so that moved
+        // particles have already been looked at
+        for (int i = count - 1; i >= 0; --i)
+        {
+            if (mParticleDead[i])
+                remove(i);
+        }
+    }
+
+    // Keep the batch as long as the emitter may still add particles
+    return size() > 0 || mParent->isAlive();
+}
+
+bool ParticleBatch::draw(Graphics *graphics, int offsetX, int offsetY) const
+{
+    if (!mImage)
+        return false;
+
+    const int width = mImage->getWidth();
+    const int height = mImage->getHeight();
+    const int screenWidth = graphics->getWidth();
+    const int screenHeight = graphics->getHeight();
+
+    const int count = size();
+    for (int i = 0; i < count; ++i)
+    {
+        const float x = mPos.x + mParticleX[i];
+        const float y = mPos.y + mParticleY[i];
+        const float z = mPos.z + mParticleZ[i];
+
+        const int screenX = (int) x + offsetX - width / 2;
+        const int screenY = (int) y - (int) z + offsetY - height / 2;
+
+        // Check if on screen
+        if (screenX + width < 0 || screenX > screenWidth ||
+            screenY + height < 0 || screenY > screenHeight)
+            continue;
+
+        const int lifetimeLeft = mParticleLifetimeLeft[i];
+        const int lifetimePast = mParticleLifetimePast[i];
+        const int fadeOut = mParticleFadeOut[i];
+        const int fadeIn = mParticleFadeIn[i];
+
+        float alphafactor = mParticleAlpha[i];
+
+        if (lifetimeLeft > -1 && lifetimeLeft < fadeOut)
+            alphafactor *= (float) lifetimeLeft / (float) fadeOut;
+
+        if (lifetimePast < fadeIn)
+            alphafactor *= (float) lifetimePast / (float) fadeIn;
+
+        mImage->setAlpha(alphafactor);
+        graphics->drawImage(mImage, screenX, screenY);
+    }
+
+    return true;
+}
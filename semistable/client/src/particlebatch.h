@@ -0,0 +1,131 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARTICLEBATCH_H
+#define PARTICLEBATCH_H
+
+#include "particle.h"
+
+#include <vector>
+
+class Image;
+class Map;
+
+/**
+ * The image particles spawned by a single ParticleEmitter. Instead of being
+ * separate objects, the particles are stored as arrays of their properties,
+ * which are updated together in tight loops. The slots of dead particles are
+ * reused without any memory allocation.
+ *
+ * Only particles without child emitters are batched, since nothing else
+ * refers to them individually. Their positions are stored relative to the
+ * batch, which follows its parent when the particles are supposed to.
+ */
+class ParticleBatch : public Particle
+{
+    public:
+        /**
+         * Properties of a particle that is added to the batch.
+         */
+        struct Spawn
+        {
+            Vector position;        /**< Relative to the batch. */
+            Vector velocity;
+            float gravity;
+            int randomness;
+            float bounce;
+            float acceleration;
+            float momentum;
+            float dieDistance;
+            int lifetime;
+            int fadeOut;
+            int fadeIn;
+            float alpha;
+        };
+
+        /**
+         * Constructor. The image is reference counted by this batch.
+         *
+         * @param map    the map the particles appear on
+         * @param image  the image drawn for each particle
+         * @param parent the particle owning the emitter of this batch
+         * @param target the particle attracting the particles, may be NULL
+         */
+        ParticleBatch(Map *map, Image *image,
+                      Particle *parent, Particle *target);
+
+        /**
+         * Destructor.
+         */
+        ~ParticleBatch();
+
+        /**
+         * Adds a particle to the batch.
+         */
+        void add(const Spawn &spawn);
+
+        /**
+         * Returns the number of live particles in the batch.
+         */
+        int size() const
+        { return mParticleX.size(); }
+
+        /**
+         * Updates all particles of the batch. Returns false once the batch
+         * is empty and its parent no longer spawns particles.
+         */
+        bool update();
+
+        /**
+         * Draws all particles of the batch.
+         */
+        bool draw(Graphics *graphics, int offsetX, int offsetY) const;
+
+    private:
+        /**
+         * Removes the particle in the given slot, by moving the last
+         * particle into it.
+         */
+        void remove(int i);
+
+        Image *mImage;
+        Particle *mParent;
+        Particle *mParticleTarget;
+
+        // Current state of the particles
+        std::vector<float> mParticleX, mParticleY, mParticleZ;
+        std::vector<float> mParticleVelX, mParticleVelY, mParticleVelZ;
+        std::vector<int> mParticleLifetimeLeft;
+        std::vector<int> mParticleLifetimePast;
+        std::vector<char> mParticleDead;
+
+        // Properties of the particles that don't change
+        std::vector<float> mParticleGravity;
+        std::vector<int> mParticleRandomness;
+        std::vector<float> mParticleBounce;
+        std::vector<float> mParticleAcceleration;
+        std::vector<float> mParticleMomentum;
+        std::vector<float> mParticleInvDieDistance;
+        std::vector<int> mParticleFadeOut;
+        std::vector<int> mParticleFadeIn;
+        std::vector<float> mParticleAlpha;
+};
+
+#endif // PARTICLEBATCH_H
@@ -23,6 +23,7 @@
 #include "imageparticle.h"
 #include "log.h"
 #include "particle.h"
+#include "particlebatch.h"
 #include "particleemitter.h"
 #include "rotationalparticle.h"
 
@@ -37,7 +38,8 @@
 
 ParticleEmitter::ParticleEmitter(xmlNodePtr emitterNode, Particle *target, Map *map, int rotation):
     mOutputPauseLeft(0),
-    mParticleImage(0)
+    mParticleImage(0),
+    mBatch(0)
 {
     mMap = map;
     mParticleTarget = target;
@@ -47,6 +49,7 @@ ParticleEmitter::ParticleEmitter(xmlNodePtr emitterNode, Particle *target, Map *
     mParticlePosY.set(0.0f);
     mParticlePosZ.set(0.0f);
     mParticleAngleHorizontal.set(0.0f);
+    mHasAngleHorizontal = false;
     mParticleAngleVertical.set(0.0f);
     mParticlePower.set(0.0f);
     mParticleGravity.set(0.0f);
@@ -106,6 +109,7 @@ ParticleEmitter::ParticleEmitter(xmlNodePtr emitterNode, Particle *target, Map *
                 mParticleAngleHorizontal.maxVal += rotation;
                 mParticleAngleHorizontal.maxVal *= DEG_RAD_FACTOR;
                 mParticleAngleHorizontal.changeAmplitude *= DEG_RAD_FACTOR;
+                mHasAngleHorizontal = true;
             }
             else if (name == "vertical-angle")
             {
@@ -335,6 +339,7 @@ ParticleEmitter & ParticleEmitter::operator=(const ParticleEmitter &o)
     mParticlePosY = o.mParticlePosY;
     mParticlePosZ = o.mParticlePosZ;
     mParticleAngleHorizontal = o.mParticleAngleHorizontal;
+    mHasAngleHorizontal = o.mHasAngleHorizontal;
     mParticleAngleVertical = o.mParticleAngleVertical;
     mParticlePower = o.mParticlePower;
     mParticleGravity = o.mParticleGravity;
@@ -358,6 +363,7 @@ ParticleEmitter & ParticleEmitter::operator=(const ParticleEmitter &o)
     mParticleChildEmitters = o.mParticleChildEmitters;
 
     mOutputPauseLeft = 0;
+    mBatch = 0;
 
     if (mParticleImage) mParticleImage->incRef();
 
@@ -371,6 +377,36 @@ ParticleEmitter::~ParticleEmitter()
 }
 
 
+void ParticleEmitter::instantiate(Particle *target, Map *map, int rotation)
+{
+    bind(target, map);
+
+    // Emitters without a horizontal angle keep emitting the same way
+    if (mHasAngleHorizontal)
+    {
+        const float angle = rotation * DEG_RAD_FACTOR;
+        mParticleAngleHorizontal.minVal += angle;
+        mParticleAngleHorizontal.maxVal += angle;
+    }
+
+    // The copy constructor doesn't keep the initial pause
+    mOutputPauseLeft = mOutputPause.value(0);
+}
+
+void ParticleEmitter::bind(Particle *target, Map *map)
+{
+    mParticleTarget = target;
+    mMap = map;
+
+    for (std::list<ParticleEmitter>::iterator i = mParticleChildEmitters.begin();
+         i != mParticleChildEmitters.end();
+         i++)
+    {
+        i->bind(target, map);
+    }
+}
+
+
 template <typename T> ParticleEmitterProp<T>
 ParticleEmitter::readParticleEmitterProp(xmlNodePtr propertyNode, T def)
 {
@@ -397,7 +433,8 @@ ParticleEmitter::readParticleEmitterProp(xmlNodePtr propertyNode, T def)
 }
 
 
-std::list<Particle *> ParticleEmitter::createParticles(int tick)
+std::list<Particle *> ParticleEmitter::createParticles(int tick,
+                                                      Particle *parent)
 {
     std::list<Particle *> newParticles;
 
@@ -408,6 +445,13 @@ std::list<Particle *> ParticleEmitter::createParticles(int tick)
     }
     mOutputPauseLeft = mOutputPause.value(tick);
 
+    // Plain image particles don't need to be separate objects
+    if (Particle::batching && mParticleImage && mParticleChildEmitters.empty())
+    {
+        createBatchedParticles(tick, parent, newParticles);
+        return newParticles;
+    }
+
     for (int i = mOutput.value(tick); i > 0; i--)
     {
         // Limit maximum particles
@@ -475,6 +519,57 @@ std::list<Particle *> ParticleEmitter::createParticles(int tick)
     return newParticles;
 }
 
+void ParticleEmitter::createBatchedParticles(int tick, Particle *parent,
+                                        std::list<Particle *> &newParticles)
+{
+    // Particles are positioned relative to the batch. A newly created batch
+    // is moved to the position of the parent by the parent itself.
+    Vector offset;
+    if (!mBatch)
+    {
+        mBatch = new ParticleBatch(mMap, mParticleImage, parent,
+                                   mParticleTarget);
+        mBatch->setFollow(mParticleFollow);
+        newParticles.push_back(mBatch);
+    }
+    else
+    {
+        offset = parent->getPosition() - mBatch->getPosition();
+    }
+
+    ParticleBatch::Spawn spawn;
+
+    for (int i = mOutput.value(tick); i > 0; i--)
+    {
+        // Limit maximum particles
+        if (Particle::particleCount > Particle::maxCount) break;
+
+        spawn.position = Vector(mParticlePosX.value(tick),
+                                mParticlePosY.value(tick),
+                                mParticlePosZ.value(tick)) + offset;
+
+        float angleH = mParticleAngleHorizontal.value(tick);
+        float angleV = mParticleAngleVertical.value(tick);
+        float power = mParticlePower.value(tick);
+        spawn.velocity = Vector(cos(angleH) * cos(angleV) * power,
+                                sin(angleH) * cos(angleV) * power,
+                                sin(angleV) * power);
+
+        spawn.randomness = mParticleRandomness.value(tick);
+        spawn.gravity = mParticleGravity.value(tick);
+        spawn.bounce = mParticleBounce.value(tick);
+        spawn.acceleration = mParticleAcceleration.value(tick);
+        spawn.momentum = mParticleMomentum.value(tick);
+        spawn.dieDistance = mParticleDieDistance.value(tick);
+        spawn.lifetime = mParticleLifetime.value(tick);
+        spawn.fadeOut = mParticleFadeOut.value(tick);
+        spawn.fadeIn = mParticleFadeIn.value(tick);
+        spawn.alpha = mParticleAlpha.value(tick);
+
+        mBatch->add(spawn);
+    }
+}
+
 void ParticleEmitter::adjustSize(int w, int h)
 {
     if (w == 0 || h == 0) return; // new dimensions are illegal
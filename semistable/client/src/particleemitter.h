@@ -33,6 +33,7 @@
 class Image;
 class Map;
 class Particle;
+class ParticleBatch;
 
 /**
  * Every Particle can have one or more particle emitters that create new
@@ -63,9 +64,11 @@ class ParticleEmitter
 
         /**
          * Spawns new particles
+         * @param tick   the age of the parent particle
+         * @param parent the particle that owns this emitter
          * @return: a list of created particles
          */
-        std::list<Particle *> createParticles(int tick);
+        std::list<Particle *> createParticles(int tick, Particle *parent);
 
         /**
          * Sets the target of the particles that are created
@@ -79,9 +82,30 @@ class ParticleEmitter
          */
         void adjustSize(int w, int h);
 
+        /**
+         * Prepares a copy of an emitter from a particle effect definition
+         * for use by a newly spawned particle. Sets the map and target of
+         * this emitter and its child emitters, and rotates the directions in
+         * which particles are emitted by this emitter when it has a
+         * horizontal angle.
+         */
+        void instantiate(Particle *target, Map *map, int rotation);
+
     private:
         template <typename T> ParticleEmitterProp<T> readParticleEmitterProp(xmlNodePtr propertyNode, T def);
 
+        /**
+         * Sets the map and target of this emitter and its child emitters.
+         */
+        void bind(Particle *target, Map *map);
+
+        /**
+         * Spawns image particles into a ParticleBatch instead of creating
+         * them one by one.
+         */
+        void createBatchedParticles(int tick, Particle *parent,
+                                    std::list<Particle *> &newParticles);
+
         /**
          * initial position of particles:
          */
@@ -91,6 +115,7 @@ class ParticleEmitter
          * initial vector of particles:
          */
         ParticleEmitterProp<float> mParticleAngleHorizontal, mParticleAngleVertical;
+        bool mHasAngleHorizontal; /**< Whether the effect defines a horizontal angle */
 
         /**
          * Initial velocity of particles
@@ -136,5 +161,8 @@ class ParticleEmitter
 
         /** List of emitters the spawned particles are equipped with */
         std::list<ParticleEmitter> mParticleChildEmitters;
+
+        /** Holds the spawned particles when they can be batched */
+        ParticleBatch *mBatch;
 };
 #endif
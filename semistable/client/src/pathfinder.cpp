@@ -0,0 +1,448 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathfinder.h"
+
+#include "map.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int basicCost = 100;
+
+/** Size of a tile in pixels. */
+static const int TILE_SIZE = 32;
+
+PathFinder::PathFinder(const MetaTile *tiles, int width, int height):
+    mTiles(tiles),
+    mWidth(width),
+    mHeight(height),
+    mNodes(width * height),
+    mGeneration(0)
+{
+    for (std::vector<Node>::iterator it = mNodes.begin(),
+         it_end = mNodes.end(); it != it_end; ++it)
+    {
+        it->generation = 0;
+        it->heapIndex = -1;
+        it->closed = false;
+    }
+}
+
+PathFinder::Node &PathFinder::getNode(int index)
+{
+    Node &node = mNodes[index];
+    if (node.generation != mGeneration)
+    {
+        node.generation = mGeneration;
+        node.heapIndex = -1;
+        node.closed = false;
+        node.occupied = false;
+    }
+    return node;
+}
+
+bool PathFinder::isWalkable(int x, int y, unsigned char walkmask) const
+{
+    return x >= 0 && y >= 0 && x < mWidth && y < mHeight &&
+           !(mTiles[x + y * mWidth].blockmask & walkmask);
+}
+
+bool PathFinder::isWalkableLine(int x0, int y0, int x1, int y1,
+                                unsigned char walkmask) const
+{
+    if (x0 < 0 || y0 < 0 || x1 < 0 || y1 < 0)
+        return false;
+
+    int tileX = x0 / TILE_SIZE;
+    int tileY = y0 / TILE_SIZE;
+    const int endTileX = x1 / TILE_SIZE;
+    const int endTileY = y1 / TILE_SIZE;
+
+    // All tiles in between are on the map when both ends are
+    if (!isWalkable(tileX, tileY, walkmask) ||
+        !isWalkable(endTileX, endTileY, walkmask))
+        return false;
+
+    const int stepX = x1 > x0 ? 1 : -1;
+    const int stepY = y1 > y0 ? 1 : -1;
+    const long dx = std::abs(x1 - x0);
+    const long dy = std::abs(y1 - y0);
+
+    // The tile borders the line crosses next. Going left or up, the line
+    // leaves a tile once it passes the border of the tile itself.
+    int borderX = (tileX + (stepX > 0 ? 1 : 0)) * TILE_SIZE;
+    int borderY = (tileY + (stepY > 0 ? 1 : 0)) * TILE_SIZE;
+
+    // Visit the tiles in the order the line enters them
+    while (tileX != endTileX || tileY != endTileY)
+    {
+        // Compare the distances to the next borders, scaled by the length of
+        // the line along the other axis, to see which is crossed first
+        const long distX = tileX == endTileX ? -1 : std::abs(borderX - x0) * dy;
+        const long distY = tileY == endTileY ? -1 : std::abs(borderY - y0) * dx;
+
+        if (distY == -1 || (distX != -1 && distX < distY))
+        {
+            tileX += stepX;
+            borderX += stepX * TILE_SIZE;
+        }
+        else if (distX == -1 || distY < distX)
+        {
+            tileY += stepY;
+            borderY += stepY * TILE_SIZE;
+        }
+        else
+        {
+            // The line goes through the corner of the tile. Like findPath,
+            // don't squeeze between walls touching at their corners.
+            const MetaTile &t1 = mTiles[tileX + stepX + tileY * mWidth];
+            const MetaTile &t2 = mTiles[tileX + (tileY + stepY) * mWidth];
+            if ((t1.blockmask | t2.blockmask) & Map::BLOCKMASK_WALL)
+                return false;
+
+            tileX += stepX;
+            tileY += stepY;
+            borderX += stepX * TILE_SIZE;
+            borderY += stepY * TILE_SIZE;
+        }
+
+        if (!isWalkable(tileX, tileY, walkmask))
+            return false;
+    }
+
+    return true;
+}
+
+Path PathFinder::findPath(int startX, int startY, int destX, int destY,
+                          unsigned char walkmask, int maxCost,
+                          const std::vector<Position> &occupied)
+{
+    // Path to be built up (empty by default)
+    Path path;
+
+    // Return when destination not walkable
+    if (!isWalkable(destX, destY, walkmask) ||
+        startX < 0 || startY < 0 || startX >= mWidth || startY >= mHeight)
+        return path;
+
+    // A new generation invalidates the state of the previous search. When
+    // the counter wraps, start over from a clean arena.
+    if (++mGeneration == 0)
+    {
+        for (std::vector<Node>::iterator it = mNodes.begin(),
+             it_end = mNodes.end(); it != it_end; ++it)
+        {
+            it->generation = 0;
+        }
+        mGeneration = 1;
+    }
+
+    mOpen.clear();
+
+    for (std::vector<Position>::const_iterator it = occupied.begin(),
+         it_end = occupied.end(); it != it_end; ++it)
+    {
+        if (it->x >= 0 && it->y >= 0 && it->x < mWidth && it->y < mHeight)
+            getNode(it->x + it->y * mWidth).occupied = true;
+    }
+
+    const int startIndex = startX + startY * mWidth;
+    const int destIndex = destX + destY * mWidth;
+
+    Node &startNode = getNode(startIndex);
+    startNode.Gcost = 0;
+    startNode.Hcost = 0;
+    startNode.Fcost = 0;
+    pushOpen(startIndex);
+
+    bool foundPath = false;
+
+    // Keep trying new open tiles until no more tiles to try or target found
+    while (!mOpen.empty() && !foundPath)
+    {
+        // Take the tile with the lowest F cost from the open list and put it
+        // on the closed list
+        const int currIndex = popOpen();
+        Node &curr = mNodes[currIndex];
+        curr.closed = true;
+
+        const int currX = currIndex % mWidth;
+        const int currY = currIndex / mWidth;
+
+        // Check the adjacent tiles
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                // Calculate location of tile to check
+                const int x = currX + dx;
+                const int y = currY + dy;
+
+                // Skip if if we're checking the same tile we're leaving from,
+                // or if the new location falls outside of the map boundaries
+                if ((dx == 0 && dy == 0) ||
+                    x < 0 || y < 0 || x >= mWidth || y >= mHeight)
+                {
+                    continue;
+                }
+
+                const int index = x + y * mWidth;
+                Node &node = getNode(index);
+
+                // Skip if the tile is on the closed list or is not walkable
+                // unless its the destination tile
+                if (node.closed ||
+                    ((mTiles[index].blockmask & walkmask) && index != destIndex))
+                {
+                    continue;
+                }
+
+                // When taking a diagonal step, verify that we can skip the
+                // corner.
+                if (dx != 0 && dy != 0)
+                {
+                    const MetaTile &t1 = mTiles[currX + y * mWidth];
+                    const MetaTile &t2 = mTiles[x + currY * mWidth];
+
+                    if ((t1.blockmask | t2.blockmask) & Map::BLOCKMASK_WALL)
+                        continue;
+                }
+
+                // Calculate G cost for this route, ~sqrt(2) for moving diagonal
+                int Gcost = curr.Gcost +
+                    (dx == 0 || dy == 0 ? basicCost : basicCost * 362 / 256);
+
+                /* Demote an arbitrary direction to speed pathfinding by
+                   adding a defect.
+                   Important: as long as the total defect along any path is
+                   less than the basicCost, the pathfinder will still find one
+                   of the shortest paths! */
+                if (dx == 0 || dy == 0)
+                {
+                    // Demote horizontal and vertical directions, so that two
+                    // consecutive directions cannot have the same Fcost.
+                    ++Gcost;
+                }
+
+                // It costs extra to walk through a being (needs to be enough
+                // to make it more attractive to walk around).
+                if (node.occupied)
+                {
+                    Gcost += 3 * basicCost;
+                }
+
+                // Skip if Gcost becomes too much
+                // Warning: probably not entirely accurate
+                if (Gcost > maxCost * basicCost)
+                {
+                    continue;
+                }
+
+                if (node.heapIndex == -1)
+                {
+                    // Found a new tile (not on open nor on closed list)
+
+                    /* Update Hcost of the new tile. The pathfinder does not
+                       work reliably if the heuristic cost is higher than the
+                       real cost. In particular, using Manhattan distance is
+                       forbidden here. */
+                    const int hx = std::abs(x - destX);
+                    const int hy = std::abs(y - destY);
+                    node.Hcost = std::abs(hx - hy) * basicCost +
+                        std::min(hx, hy) * (basicCost * 362 / 256);
+
+                    node.parent = currIndex;
+                    node.Gcost = Gcost;
+                    node.Fcost = Gcost + node.Hcost;
+
+                    if (index != destIndex)
+                    {
+                        pushOpen(index);
+                    }
+                    else
+                    {
+                        node.closed = true;
+                        foundPath = true;
+                    }
+                }
+                else if (Gcost < node.Gcost)
+                {
+                    // Found a shorter route, so move the tile up in the
+                    // open list
+                    node.parent = currIndex;
+                    node.Gcost = Gcost;
+                    node.Fcost = Gcost + node.Hcost;
+                    siftUp(node.heapIndex);
+                }
+            }
+        }
+    }
+
+    // If a path has been found, iterate backwards using the parent locations
+    // to extract it.
+    if (foundPath)
+    {
+        for (int index = destIndex; index != startIndex;
+             index = mNodes[index].parent)
+        {
+            path.push_front(Position(index % mWidth, index / mWidth));
+        }
+    }
+
+    return path;
+}
+
+void PathFinder::smoothPixelPath(Path &path, int startPixelX, int startPixelY,
+                                 int radius, unsigned char walkmask) const
+{
+    Position from(startPixelX, startPixelY);
+
+    Path::iterator it = path.begin();
+    while (it != path.end())
+    {
+        Path::iterator next = it;
+        ++next;
+
+        // The destination is always kept
+        if (next == path.end())
+            break;
+
+        if (lineOfSight(from, *next, radius, walkmask))
+        {
+            it = path.erase(it);
+        }
+        else
+        {
+            from = *it;
+            ++it;
+        }
+    }
+}
+
+bool PathFinder::lineOfSight(const Position &from, const Position &to,
+                             int radius, unsigned char walkmask) const
+{
+    // Check every tile crossed by the corners of the square the being
+    // covers. As long as the square is no larger than a tile, any tile it
+    // touches on the way contains the line of one of its corners.
+    for (int cornerY = -1; cornerY <= 1; cornerY += 2)
+    {
+        for (int cornerX = -1; cornerX <= 1; cornerX += 2)
+        {
+            const int offsetX = cornerX * radius;
+            const int offsetY = cornerY * radius;
+
+            if (!isWalkableLine(from.x + offsetX, from.y + offsetY,
+                                to.x + offsetX, to.y + offsetY, walkmask))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int PathFinder::getCost(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= mWidth || y >= mHeight)
+        return -1;
+
+    const Node &node = mNodes[x + y * mWidth];
+    if (node.generation != mGeneration ||
+        (node.heapIndex == -1 && !node.closed))
+        return -1;
+
+    return node.Gcost;
+}
+
+void PathFinder::pushOpen(int index)
+{
+    mNodes[index].heapIndex = mOpen.size();
+    mOpen.push_back(index);
+    siftUp(mOpen.size() - 1);
+}
+
+int PathFinder::popOpen()
+{
+    const int index = mOpen.front();
+
+    mOpen.front() = mOpen.back();
+    mNodes[mOpen.front()].heapIndex = 0;
+    mOpen.pop_back();
+
+    if (!mOpen.empty())
+        siftDown(0);
+
+    // Closed tiles don't go back to the open list, but they aren't new
+    mNodes[index].heapIndex = -2;
+    return index;
+}
+
+void PathFinder::siftUp(int heapIndex)
+{
+    const int index = mOpen[heapIndex];
+    const int Fcost = mNodes[index].Fcost;
+
+    while (heapIndex > 0)
+    {
+        const int parent = (heapIndex - 1) / 2;
+        if (mNodes[mOpen[parent]].Fcost <= Fcost)
+            break;
+
+        mOpen[heapIndex] = mOpen[parent];
+        mNodes[mOpen[heapIndex]].heapIndex = heapIndex;
+        heapIndex = parent;
+    }
+
+    mOpen[heapIndex] = index;
+    mNodes[index].heapIndex = heapIndex;
+}
+
+void PathFinder::siftDown(int heapIndex)
+{
+    const int size = mOpen.size();
+    const int index = mOpen[heapIndex];
+    const int Fcost = mNodes[index].Fcost;
+
+    for (;;)
+    {
+        int child = heapIndex * 2 + 1;
+        if (child >= size)
+            break;
+
+        if (child + 1 < size &&
+            mNodes[mOpen[child + 1]].Fcost < mNodes[mOpen[child]].Fcost)
+        {
+            ++child;
+        }
+
+        if (mNodes[mOpen[child]].Fcost >= Fcost)
+            break;
+
+        mOpen[heapIndex] = mOpen[child];
+        mNodes[mOpen[heapIndex]].heapIndex = heapIndex;
+        heapIndex = child;
+    }
+
+    mOpen[heapIndex] = index;
+    mNodes[index].heapIndex = heapIndex;
+}
@@ -0,0 +1,128 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include "position.h"
+
+#include <vector>
+
+struct MetaTile;
+
+/**
+ * Finds paths over the tiles of a map with A*.
+ *
+ * The search state of all tiles is kept in an arena that lives as long as the
+ * path finder. Each search starts a new generation, and the state of a tile
+ * only counts when it was written in the current generation, so nothing needs
+ * to be cleared between searches. The open list is a binary heap that knows
+ * where each tile is in it, so a shorter route to a tile moves it up instead
+ * of adding another copy.
+ */
+class PathFinder
+{
+    public:
+        /**
+         * Constructor.
+         *
+         * @param tiles  the blocking properties of the tiles, which need to
+         *               outlive the path finder
+         * @param width  the width of the map in tiles
+         * @param height the height of the map in tiles
+         */
+        PathFinder(const MetaTile *tiles, int width, int height);
+
+        /**
+         * Finds a path from one tile to another. The path doesn't include the
+         * start tile.
+         *
+         * @param occupied tiles with beings on them, which are avoided when
+         *                 walking around them isn't too far
+         * @param maxCost  the maximum length of the path, in tiles
+         */
+        Path findPath(int startX, int startY, int destX, int destY,
+                      unsigned char walkmask, int maxCost,
+                      const std::vector<Position> &occupied);
+
+        /**
+         * Removes the nodes of a pixel path that can be skipped by walking
+         * straight from the previous node to the next, without touching a
+         * blocked tile with the given radius.
+         */
+        void smoothPixelPath(Path &path, int startPixelX, int startPixelY,
+                             int radius, unsigned char walkmask) const;
+
+        /**
+         * Returns whether a being with the given radius can walk in a straight
+         * line between two pixel positions.
+         */
+        bool lineOfSight(const Position &from, const Position &to,
+                         int radius, unsigned char walkmask) const;
+
+        /**
+         * Returns the cost of the route to the given tile in the last search,
+         * or -1 when the last search didn't reach it.
+         */
+        int getCost(int x, int y) const;
+
+    private:
+        struct Node
+        {
+            unsigned int generation;    /**< Search this node is valid for. */
+            int Gcost;                  /**< Cost from start to this tile. */
+            int Hcost;                  /**< Estimated cost to goal. */
+            int Fcost;                  /**< Estimation of total path cost. */
+            int parent;                 /**< Index of the parent tile. */
+            int heapIndex;              /**< Position in the open list, -1
+                                             when not visited yet. */
+            bool closed;
+            bool occupied;
+        };
+
+        /**
+         * Returns the node of the given tile, reset when it wasn't used in
+         * the current search yet.
+         */
+        Node &getNode(int index);
+
+        bool isWalkable(int x, int y, unsigned char walkmask) const;
+        /**
+         * Returns whether all tiles crossed by the line between two pixel
+         * positions are walkable, and it doesn't pass between walls that
+         * touch at their corners.
+         */
+        bool isWalkableLine(int x0, int y0, int x1, int y1,
+                            unsigned char walkmask) const;
+
+        void pushOpen(int index);
+        int popOpen();
+        void siftUp(int heapIndex);
+        void siftDown(int heapIndex);
+
+        const MetaTile *mTiles;
+        int mWidth, mHeight;
+
+        std::vector<Node> mNodes;
+        std::vector<int> mOpen;         /**< Heap of tile indexes by Fcost. */
+        unsigned int mGeneration;
+};
+
+#endif // PATHFINDER_H
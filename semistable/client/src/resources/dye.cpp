@@ -23,6 +23,7 @@
 
 #include "log.h"
 
+#include <algorithm>
 #include <math.h>
 #include <sstream>
 
@@ -179,7 +180,8 @@ void DyePalette::getColor(double intensity, int color[3]) const
     color[2] = (rest * b1 + intensity * b2);
 }
 
-Dye::Dye(const std::string &description)
+Dye::Dye(const std::string &description):
+    mDescription(description)
 {
     for (int i = 0; i < 7; ++i)
         mDyePalettes[i] = 0;
@@ -252,6 +254,64 @@ void Dye::update(int color[3]) const
         mDyePalettes[i - 1]->getColor(cmax, color);
 }
 
+void Dye::updatePixels(unsigned int *pixels, int count) const
+{
+    // The result for a pure color only depends on its hue and its maximum
+    // component, so it can be looked up instead of interpolated per pixel
+    unsigned int table[7][256];
+    bool used[7];
+
+    for (int i = 0; i < 7; ++i)
+    {
+        used[i] = mDyePalettes[i] != 0;
+        if (!used[i])
+            continue;
+
+        for (int intensity = 1; intensity < 256; ++intensity)
+        {
+            // An empty palette leaves the color alone
+            int v[3] = { -1, -1, -1 };
+            mDyePalettes[i]->getColor(intensity, v);
+            if (v[0] < 0)
+            {
+                used[i] = false;
+                break;
+            }
+            table[i][intensity] = (v[0] << 24) | (v[1] << 16) | (v[2] << 8);
+        }
+    }
+
+    for (unsigned int *p_end = pixels + count; pixels != p_end; ++pixels)
+    {
+        const unsigned int pixel = *pixels;
+        const unsigned int alpha = pixel & 255;
+        if (!alpha)
+            continue;
+
+        const int r = (pixel >> 24) & 255;
+        const int g = (pixel >> 16) & 255;
+        const int b = (pixel >> 8) & 255;
+
+        const int cmax = std::max(r, std::max(g, b));
+        if (cmax == 0)
+            continue;
+
+        const int cmin = std::min(r, std::min(g, b));
+        const int intensity = r + g + b;
+
+        if (cmin != cmax &&
+            (cmin != 0 || (intensity != cmax && intensity != 2 * cmax)))
+        {
+            // not pure
+            continue;
+        }
+
+        const int i = (r != 0) | ((g != 0) << 1) | ((b != 0) << 2);
+        if (used[i - 1])
+            *pixels = table[i - 1][cmax] | alpha;
+    }
+}
+
 void Dye::instantiate(std::string &target, const std::string &palettes)
 {
     std::string::size_type next_pos = target.find('|');
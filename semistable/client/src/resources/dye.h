@@ -86,6 +86,20 @@ class Dye
          */
         void update(int color[3]) const;
 
+        /**
+         * Modifies the colors of a run of 32-bit pixels, with red in the
+         * most significant byte and alpha in the least significant one.
+         * Gives the same result as calling update() for each visible pixel,
+         * but looks the colors up in a table built once for all pixels.
+         */
+        void updatePixels(unsigned int *pixels, int count) const;
+
+        /**
+         * Returns the description the dye was created from.
+         */
+        const std::string &getDescription() const
+        { return mDescription; }
+
         /**
          * Fills the blank in a dye placeholder with some palette names.
          */
@@ -100,6 +114,8 @@ class Dye
          * Red, Green, Yellow, Blue, Magenta, White (or rather gray).
          */
         DyePalette *mDyePalettes[7];
+
+        std::string mDescription;
 };
 
 #endif
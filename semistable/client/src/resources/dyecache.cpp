@@ -0,0 +1,161 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resources/dyecache.h"
+
+#include "resources/dye.h"
+
+#include "utils/stringutils.h"
+
+#include <physfs.h>
+#include <zlib.h>
+
+static const char *const CACHE_DIR = "cache/dye";
+
+/**
+ * The cache is written in native byte order. Since the magic is written the
+ * same way, a cache from a machine with another byte order is just rebuilt.
+ */
+static const int CACHE_MAGIC = 0x44594543; // "DYEC"
+
+/**
+ * Increase this whenever the layout of the cache files or the way images
+ * are dyed changes.
+ */
+static const int CACHE_VERSION = 1;
+
+/** Images larger than this in either direction are taken to be corrupt. */
+static const int MAX_SIZE = 8192;
+
+static unsigned long checksum(const void *buffer, unsigned size)
+{
+    const unsigned long crc = crc32(0L, Z_NULL, 0);
+    return crc32(crc, (const Bytef*) buffer, size);
+}
+
+static bool readInt(PHYSFS_file *file, int &value)
+{
+    return PHYSFS_read(file, &value, sizeof(value), 1) == 1;
+}
+
+static bool writeInt(PHYSFS_file *file, int value)
+{
+    return PHYSFS_write(file, &value, sizeof(value), 1) == 1;
+}
+
+std::string DyeCache::cacheFile(const void *buffer, unsigned size,
+                                const Dye &dye)
+{
+    const std::string &description = dye.getDescription();
+    return strprintf("%s/%08lx-%08lx.bin", CACHE_DIR,
+                     checksum(buffer, size) & 0xffffffffUL,
+                     checksum(description.data(), description.size())
+                     & 0xffffffffUL);
+}
+
+SDL_Surface *DyeCache::read(const std::string &cacheFile, const Dye &dye)
+{
+    PHYSFS_file *file = PHYSFS_openRead(cacheFile.c_str());
+    if (!file)
+        return NULL;
+
+    const std::string &description = dye.getDescription();
+
+    int magic, version, length, width, height;
+    bool valid = readInt(file, magic) && magic == CACHE_MAGIC &&
+                 readInt(file, version) && version == CACHE_VERSION &&
+                 readInt(file, length) &&
+                 length == (int) description.size();
+
+    // Different dyes may end up with the same file name
+    if (valid && length > 0)
+    {
+        std::string storedDescription(length, '\0');
+        valid = PHYSFS_read(file, &storedDescription[0], length, 1) == 1 &&
+                storedDescription == description;
+    }
+
+    valid = valid &&
+            readInt(file, width) && width > 0 && width <= MAX_SIZE &&
+            readInt(file, height) && height > 0 && height <= MAX_SIZE;
+
+    SDL_Surface *surface = NULL;
+
+    if (valid)
+    {
+        surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32,
+                                       0xFF000000, 0x00FF0000,
+                                       0x0000FF00, 0x000000FF);
+    }
+
+    if (surface)
+    {
+        char *row = static_cast<char*>(surface->pixels);
+        for (int y = 0; y < height; ++y, row += surface->pitch)
+        {
+            if (PHYSFS_read(file, row, width * 4, 1) != 1)
+            {
+                SDL_FreeSurface(surface);
+                surface = NULL;
+                break;
+            }
+        }
+    }
+
+    PHYSFS_close(file);
+    return surface;
+}
+
+void DyeCache::write(const std::string &cacheFile, const Dye &dye,
+                     SDL_Surface *surface)
+{
+    if (!PHYSFS_getWriteDir() || !PHYSFS_mkdir(CACHE_DIR))
+        return;
+
+    PHYSFS_file *file = PHYSFS_openWrite(cacheFile.c_str());
+    if (!file)
+        return;
+
+    const std::string &description = dye.getDescription();
+
+    bool written = writeInt(file, CACHE_MAGIC) &&
+                   writeInt(file, CACHE_VERSION) &&
+                   writeInt(file, description.size());
+
+    if (written && !description.empty())
+    {
+        written = PHYSFS_write(file, description.data(),
+                               description.size(), 1) == 1;
+    }
+
+    written = written &&
+              writeInt(file, surface->w) &&
+              writeInt(file, surface->h);
+
+    const char *row = static_cast<const char*>(surface->pixels);
+    for (int y = 0; written && y < surface->h; ++y, row += surface->pitch)
+        written = PHYSFS_write(file, row, surface->w * 4, 1) == 1;
+
+    PHYSFS_close(file);
+
+    // Don't leave a truncated file behind, it would only be rejected
+    if (!written)
+        PHYSFS_delete(cacheFile.c_str());
+}
@@ -0,0 +1,61 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DYECACHE_H
+#define DYECACHE_H
+
+#include <SDL.h>
+
+#include <string>
+
+class Dye;
+
+/**
+ * Cache of dyed images in the write directory, so that an image dyed once
+ * doesn't need to be decoded and recolored again in later sessions. Entries
+ * are keyed by the checksum of the source image and the dye, so changed
+ * images simply miss.
+ *
+ * Since images are decoded on the loader threads, nothing here logs.
+ */
+namespace DyeCache
+{
+    /**
+     * Returns the name of the cache file for the given source image
+     * contents and dye.
+     */
+    std::string cacheFile(const void *buffer, unsigned size, const Dye &dye);
+
+    /**
+     * Reads a cached dyed image.
+     *
+     * @return the dyed image as a 32-bit RGBA surface, or <code>NULL</code>
+     *         when it isn't cached
+     */
+    SDL_Surface *read(const std::string &cacheFile, const Dye &dye);
+
+    /**
+     * Stores a dyed image, which has to be a 32-bit RGBA surface.
+     */
+    void write(const std::string &cacheFile, const Dye &dye,
+               SDL_Surface *surface);
+}
+
+#endif // DYECACHE_H
@@ -22,6 +22,7 @@
 #include "resources/image.h"
 
 #include "resources/dye.h"
+#include "resources/dyecache.h"
 
 #ifdef USE_OPENGL
 #include "openglgraphics.h"
@@ -98,9 +99,7 @@ Image::~Image()
 
 Resource *Image::load(void *buffer, unsigned bufferSize)
 {
-    // Load the raw file data from the buffer in an RWops structure
-    SDL_RWops *rw = SDL_RWFromMem(buffer, bufferSize);
-    SDL_Surface *tmpImage = IMG_Load_RW(rw, 1);
+    SDL_Surface *tmpImage = decode(buffer, bufferSize, NULL);
 
     if (!tmpImage)
     {
@@ -116,15 +115,36 @@ Resource *Image::load(void *buffer, unsigned bufferSize)
 
 Resource *Image::load(void *buffer, unsigned bufferSize, Dye const &dye)
 {
-    SDL_RWops *rw = SDL_RWFromMem(buffer, bufferSize);
-    SDL_Surface *tmpImage = IMG_Load_RW(rw, 1);
+    SDL_Surface *surf = decode(buffer, bufferSize, &dye);
 
-    if (!tmpImage)
+    if (!surf)
     {
         logger->log("Error, image load failed: %s", IMG_GetError());
         return NULL;
     }
 
+    Image *image = load(surf);
+    SDL_FreeSurface(surf);
+    return image;
+}
+
+SDL_Surface *Image::decode(void *buffer, unsigned bufferSize, Dye const *dye)
+{
+    std::string cacheFile;
+    if (dye)
+    {
+        cacheFile = DyeCache::cacheFile(buffer, bufferSize, *dye);
+        if (SDL_Surface *cached = DyeCache::read(cacheFile, *dye))
+            return cached;
+    }
+
+    // Load the raw file data from the buffer in an RWops structure
+    SDL_RWops *rw = SDL_RWFromMem(buffer, bufferSize);
+    SDL_Surface *tmpImage = IMG_Load_RW(rw, 1);
+
+    if (!tmpImage || !dye)
+        return tmpImage;
+
     SDL_PixelFormat rgba;
     rgba.palette = NULL;
     rgba.BitsPerPixel = 32;
@@ -139,22 +159,15 @@ Resource *Image::load(void *buffer, unsigned bufferSize, Dye const &dye)
     SDL_Surface *surf = SDL_ConvertSurface(tmpImage, &rgba, SDL_SWSURFACE);
     SDL_FreeSurface(tmpImage);
 
-    Uint32 *pixels = static_cast< Uint32 * >(surf->pixels);
-    for (Uint32 *p_end = pixels + surf->w * surf->h; pixels != p_end; ++pixels)
-    {
-        int alpha = *pixels & 255;
-        if (!alpha) continue;
-        int v[3];
-        v[0] = (*pixels >> 24) & 255;
-        v[1] = (*pixels >> 16) & 255;
-        v[2] = (*pixels >> 8 ) & 255;
-        dye.update(v);
-        *pixels = (v[0] << 24) | (v[1] << 16) | (v[2] << 8) | alpha;
-    }
+    if (!surf)
+        return NULL;
 
-    Image *image = load(surf);
-    SDL_FreeSurface(surf);
-    return image;
+    dye->updatePixels(static_cast< Uint32 * >(surf->pixels),
+                      surf->w * surf->h);
+
+    DyeCache::write(cacheFile, *dye, surf);
+
+    return surf;
 }
 
 Image *Image::load(SDL_Surface *tmpImage)
@@ -189,6 +202,85 @@ void Image::unload()
 #endif
 }
 
+bool Image::update(SDL_Surface *surface, const SDL_Rect &area)
+{
+    if (!mLoaded)
+        return false;
+
+#ifdef USE_OPENGL
+    if (mGLImage)
+    {
+        if (surface->format->BitsPerPixel != 32)
+            return false;
+
+        // Parts of the surface that didn't fit the texture were cropped
+        const int width = std::min((int) area.w, mTexWidth - area.x);
+        const int height = std::min((int) area.h, mTexHeight - area.y);
+        if (width <= 0 || height <= 0)
+            return true;
+
+        OpenGLGraphics::bindTexture(mTextureType, mGLImage);
+
+        if (SDL_MUSTLOCK(surface))
+            SDL_LockSurface(surface);
+
+        const Uint8 *pixels = (const Uint8*) surface->pixels +
+                              area.y * surface->pitch + area.x * 4;
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / 4);
+        glTexSubImage2D(mTextureType, 0, area.x, area.y, width, height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+
+        return true;
+    }
+#endif
+
+    // The alpha channel is needed to keep the alpha of the image
+    if (!mSDLSurface || !mAlphaChannel ||
+        mSDLSurface->format->BitsPerPixel != 32)
+        return false;
+
+    // Copy the pixels including their alpha instead of blending them
+    SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
+
+    SDL_Rect srcRect = area;
+    SDL_Rect dstRect = area;
+    SDL_BlitSurface(surface, &srcRect, mSDLSurface, &dstRect);
+
+    if (SDL_MUSTLOCK(mSDLSurface))
+        SDL_LockSurface(mSDLSurface);
+
+    const int maxHeight = std::min(area.y + area.h, mSDLSurface->h);
+    const int maxWidth = std::min(area.x + area.w, mSDLSurface->w);
+
+    for (int y = area.y; y < maxHeight; y++)
+        for (int x = area.x; x < maxWidth; x++)
+        {
+            const int i = y * mSDLSurface->w + x;
+            Uint8 r, g, b, a;
+            SDL_GetRGBA(((Uint32*) mSDLSurface->pixels)[i],
+                        mSDLSurface->format, &r, &g, &b, &a);
+
+            // Remember the alpha for setAlpha() and apply the current one
+            mAlphaChannel[i] = a;
+            if (a > 0 && mAlpha < 1.0f)
+            {
+                a = (Uint8) (a * mAlpha);
+                ((Uint32 *)(mSDLSurface->pixels))[i] =
+                    SDL_MapRGBA(mSDLSurface->format, r, g, b, a);
+            }
+        }
+
+    if (SDL_MUSTLOCK(mSDLSurface))
+        SDL_UnlockSurface(mSDLSurface);
+
+    return true;
+}
+
 bool Image::isAnOpenGLOne() const
 {
 #ifdef USE_OPENGL
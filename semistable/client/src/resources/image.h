@@ -87,6 +87,28 @@ class Image : public Resource
          */
         static Image *load(SDL_Surface *);
 
+        /**
+         * Decodes an image from a buffer in memory into an SDL surface,
+         * recoloring it when a dye is given. Unlike load(), this doesn't
+         * create any textures or log anything, so it can be used from other
+         * threads than the main one.
+         *
+         * @return the decoded surface, to be freed by the caller, or
+         *         <code>NULL</code> if an error occurred.
+         */
+        static SDL_Surface *decode(void *buffer, unsigned bufferSize,
+                                   Dye const *dye);
+
+        /**
+         * Copies an area of the given surface into the image, at the same
+         * position. The surface should be the one the image was loaded from,
+         * with later changes in that area.
+         *
+         * @return <code>false</code> if the image can't be changed in place
+         *         and should be loaded anew.
+         */
+        bool update(SDL_Surface *surface, const SDL_Rect &area);
+
         /**
          * Frees the resources created by SDL.
          */
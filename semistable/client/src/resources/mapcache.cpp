@@ -0,0 +1,368 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resources/mapcache.h"
+
+#include "log.h"
+
+#include "resources/resourcemanager.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+
+/**
+ * The cache is written in native byte order. Since the magic is written the
+ * same way, a cache from a machine with another byte order is just rebuilt.
+ */
+static const int CACHE_MAGIC = 0x4D415043; // "MAPC"
+
+/**
+ * Increase this whenever the layout of the cache or the meaning of its
+ * contents changes.
+ */
+static const int CACHE_VERSION = 1;
+
+namespace
+{
+    class CacheWriter
+    {
+        public:
+            void writeInt(int value)
+            { mData.append((const char*) &value, sizeof(value)); }
+
+            void writeString(const std::string &value)
+            {
+                writeInt(value.size());
+                mData.append(value);
+            }
+
+            void writeInts(const std::vector<int> &values)
+            {
+                writeInt(values.size());
+                if (!values.empty())
+                    mData.append((const char*) &values[0],
+                                 values.size() * sizeof(int));
+            }
+
+            const std::string &data() const
+            { return mData; }
+
+        private:
+            std::string mData;
+    };
+
+    /**
+     * Reads the cache, guarding against truncated or corrupt files. Once
+     * anything fails to read, all further reads return empty values.
+     */
+    class CacheReader
+    {
+        public:
+            CacheReader(const char *data, int size):
+                mPos(data), mEnd(data + size), mValid(true)
+            {}
+
+            bool isValid() const
+            { return mValid; }
+
+            int readInt()
+            {
+                int value = 0;
+                if (check(sizeof(value)))
+                {
+                    memcpy(&value, mPos, sizeof(value));
+                    mPos += sizeof(value);
+                }
+                return value;
+            }
+
+            std::string readString()
+            {
+                const int length = readInt();
+                if (length < 0 || !check(length))
+                    return std::string();
+
+                std::string value(mPos, length);
+                mPos += length;
+                return value;
+            }
+
+            void readInts(std::vector<int> &values)
+            {
+                const int count = readInt();
+                if (count < 0 || !check(count * sizeof(int)))
+                    return;
+
+                values.resize(count);
+                if (count > 0)
+                    memcpy(&values[0], mPos, count * sizeof(int));
+                mPos += count * sizeof(int);
+            }
+
+            /**
+             * Reads an element count, which is sane only when each element
+             * takes at least a few bytes.
+             */
+            int readCount()
+            {
+                const int count = readInt();
+                if (count < 0 || !check(count))
+                    return 0;
+                return count;
+            }
+
+        private:
+            bool check(unsigned size)
+            {
+                if (mValid && (unsigned) (mEnd - mPos) >= size)
+                    return true;
+
+                mValid = false;
+                return false;
+            }
+
+            const char *mPos;
+            const char *mEnd;
+            bool mValid;
+    };
+}
+
+std::string MapCache::cacheFile(const std::string &mapFile)
+{
+    return "cache/" + mapFile + ".bin";
+}
+
+bool MapCache::read(const std::string &mapFile, unsigned long checksum,
+                    MapData &data)
+{
+    ResourceManager *resman = ResourceManager::getInstance();
+    const std::string fileName = cacheFile(mapFile);
+
+    if (!resman->exists(fileName))
+        return false;
+
+    int fileSize;
+    char *buffer = (char*) resman->loadFile(fileName, fileSize);
+    if (!buffer)
+        return false;
+
+    CacheReader reader(buffer, fileSize);
+
+    if (reader.readInt() != CACHE_MAGIC ||
+        reader.readInt() != CACHE_VERSION ||
+        (unsigned) reader.readInt() != (unsigned) checksum)
+    {
+        free(buffer);
+        return false;
+    }
+
+    data.width = reader.readInt();
+    data.height = reader.readInt();
+    data.tileWidth = reader.readInt();
+    data.tileHeight = reader.readInt();
+
+    data.dependencies.resize(reader.readCount());
+    for (unsigned i = 0; i < data.dependencies.size(); ++i)
+    {
+        MapData::Dependency &dependency = data.dependencies[i];
+        dependency.file = reader.readString();
+        dependency.checksum = (unsigned) reader.readInt();
+    }
+
+    data.tilesets.resize(reader.readCount());
+    for (unsigned i = 0; i < data.tilesets.size(); ++i)
+    {
+        MapData::Tileset &tileset = data.tilesets[i];
+        tileset.firstGid = reader.readInt();
+        tileset.image = reader.readString();
+        tileset.tileWidth = reader.readInt();
+        tileset.tileHeight = reader.readInt();
+
+        tileset.animations.resize(reader.readCount());
+        for (unsigned j = 0; j < tileset.animations.size(); ++j)
+        {
+            MapData::TileAnimation &animation = tileset.animations[j];
+            animation.gid = reader.readInt();
+
+            animation.frames.resize(reader.readCount());
+            for (unsigned k = 0; k < animation.frames.size(); ++k)
+            {
+                animation.frames[k].index = reader.readInt();
+                animation.frames[k].delay = reader.readInt();
+            }
+        }
+    }
+
+    data.layers.resize(reader.readCount());
+    for (unsigned i = 0; i < data.layers.size(); ++i)
+    {
+        MapData::Layer &layer = data.layers[i];
+        layer.name = reader.readString();
+        layer.offsetX = reader.readInt();
+        layer.offsetY = reader.readInt();
+        layer.width = reader.readInt();
+        layer.height = reader.readInt();
+        layer.fringe = reader.readInt() != 0;
+        layer.collision = reader.readInt() != 0;
+        layer.animated = reader.readInt() != 0;
+        reader.readInts(layer.tiles);
+    }
+
+    data.properties.resize(reader.readCount());
+    for (unsigned i = 0; i < data.properties.size(); ++i)
+    {
+        data.properties[i].first = reader.readString();
+        data.properties[i].second = reader.readString();
+    }
+
+    data.objects.resize(reader.readCount());
+    for (unsigned i = 0; i < data.objects.size(); ++i)
+    {
+        MapData::Object &object = data.objects[i];
+        object.type = reader.readInt();
+        object.name = reader.readString();
+        object.x = reader.readInt();
+        object.y = reader.readInt();
+        object.width = reader.readInt();
+        object.height = reader.readInt();
+    }
+
+    free(buffer);
+
+    if (!reader.isValid())
+    {
+        logger->log("Warning: Corrupt map cache (%s)", fileName.c_str());
+        return false;
+    }
+
+    // The map is only up to date when its tilesets are
+    for (unsigned i = 0; i < data.dependencies.size(); ++i)
+    {
+        const MapData::Dependency &dependency = data.dependencies[i];
+        if (fileChecksum(dependency.file) != dependency.checksum)
+            return false;
+    }
+
+    return true;
+}
+
+void MapCache::write(const std::string &mapFile, unsigned long checksum,
+                     const MapData &data)
+{
+    CacheWriter writer;
+
+    writer.writeInt(CACHE_MAGIC);
+    writer.writeInt(CACHE_VERSION);
+    writer.writeInt(checksum);
+
+    writer.writeInt(data.width);
+    writer.writeInt(data.height);
+    writer.writeInt(data.tileWidth);
+    writer.writeInt(data.tileHeight);
+
+    writer.writeInt(data.dependencies.size());
+    for (unsigned i = 0; i < data.dependencies.size(); ++i)
+    {
+        writer.writeString(data.dependencies[i].file);
+        writer.writeInt(data.dependencies[i].checksum);
+    }
+
+    writer.writeInt(data.tilesets.size());
+    for (unsigned i = 0; i < data.tilesets.size(); ++i)
+    {
+        const MapData::Tileset &tileset = data.tilesets[i];
+        writer.writeInt(tileset.firstGid);
+        writer.writeString(tileset.image);
+        writer.writeInt(tileset.tileWidth);
+        writer.writeInt(tileset.tileHeight);
+
+        writer.writeInt(tileset.animations.size());
+        for (unsigned j = 0; j < tileset.animations.size(); ++j)
+        {
+            const MapData::TileAnimation &animation = tileset.animations[j];
+            writer.writeInt(animation.gid);
+
+            writer.writeInt(animation.frames.size());
+            for (unsigned k = 0; k < animation.frames.size(); ++k)
+            {
+                writer.writeInt(animation.frames[k].index);
+                writer.writeInt(animation.frames[k].delay);
+            }
+        }
+    }
+
+    writer.writeInt(data.layers.size());
+    for (unsigned i = 0; i < data.layers.size(); ++i)
+    {
+        const MapData::Layer &layer = data.layers[i];
+        writer.writeString(layer.name);
+        writer.writeInt(layer.offsetX);
+        writer.writeInt(layer.offsetY);
+        writer.writeInt(layer.width);
+        writer.writeInt(layer.height);
+        writer.writeInt(layer.fringe);
+        writer.writeInt(layer.collision);
+        writer.writeInt(layer.animated);
+        writer.writeInts(layer.tiles);
+    }
+
+    writer.writeInt(data.properties.size());
+    for (unsigned i = 0; i < data.properties.size(); ++i)
+    {
+        writer.writeString(data.properties[i].first);
+        writer.writeString(data.properties[i].second);
+    }
+
+    writer.writeInt(data.objects.size());
+    for (unsigned i = 0; i < data.objects.size(); ++i)
+    {
+        const MapData::Object &object = data.objects[i];
+        writer.writeInt(object.type);
+        writer.writeString(object.name);
+        writer.writeInt(object.x);
+        writer.writeInt(object.y);
+        writer.writeInt(object.width);
+        writer.writeInt(object.height);
+    }
+
+    ResourceManager *resman = ResourceManager::getInstance();
+    const std::string &buffer = writer.data();
+    resman->writeFile(cacheFile(mapFile), buffer.data(), buffer.size());
+}
+
+unsigned long MapCache::checksum(const void *buffer, int size)
+{
+    const unsigned long crc = crc32(0L, Z_NULL, 0);
+    return crc32(crc, (const Bytef*) buffer, size);
+}
+
+unsigned long MapCache::fileChecksum(const std::string &fileName)
+{
+    ResourceManager *resman = ResourceManager::getInstance();
+    int fileSize;
+    void *buffer = resman->loadFile(fileName, fileSize);
+    if (!buffer)
+        return 0;
+
+    const unsigned long result = checksum(buffer, fileSize);
+    free(buffer);
+    return result;
+}
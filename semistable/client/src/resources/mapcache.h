@@ -0,0 +1,141 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Everything the client uses from a map file, with the paths of referenced
+ * files already resolved. This is what gets stored in the map cache, so that
+ * a map that didn't change doesn't need to be inflated and parsed again.
+ */
+struct MapData
+{
+    /**
+     * An external file the map was read from, like a TSX tileset.
+     */
+    struct Dependency
+    {
+        std::string file;
+        unsigned long checksum;
+    };
+
+    struct AnimationFrame
+    {
+        int index;
+        int delay;
+    };
+
+    struct TileAnimation
+    {
+        int gid;
+        std::vector<AnimationFrame> frames;
+    };
+
+    struct Tileset
+    {
+        int firstGid;
+        std::string image;
+        int tileWidth;
+        int tileHeight;
+        std::vector<TileAnimation> animations;
+    };
+
+    struct Layer
+    {
+        std::string name;
+        int offsetX, offsetY;
+        int width, height;
+        bool fringe;
+        bool collision;
+        bool animated;          /**< Whether tile animations apply. */
+        std::vector<int> tiles; /**< Tile gids, width * height of them. */
+    };
+
+    enum ObjectType
+    {
+        PARTICLE_EFFECT,
+        WARP
+    };
+
+    struct Object
+    {
+        int type;
+        std::string name;
+        int x, y;
+        int width, height;
+    };
+
+    int width;
+    int height;
+    int tileWidth;
+    int tileHeight;
+
+    std::vector<Dependency> dependencies;
+    std::vector<Tileset> tilesets;
+    std::vector<Layer> layers;
+    std::vector<std::pair<std::string, std::string> > properties;
+    std::vector<Object> objects;
+};
+
+/**
+ * Compiled map cache. Cache files live in the write directory and are only
+ * used as long as the checksums of the map and its dependencies match.
+ */
+namespace MapCache
+{
+    /**
+     * Returns the name of the cache file for the given map file.
+     */
+    std::string cacheFile(const std::string &mapFile);
+
+    /**
+     * Reads the cached data of a map.
+     *
+     * @param mapFile  the map file the cache was compiled from
+     * @param checksum the checksum of the current contents of the map file
+     * @param data     the map data to fill
+     * @return <code>true</code> when the cache was present and up to date
+     */
+    bool read(const std::string &mapFile, unsigned long checksum,
+              MapData &data);
+
+    /**
+     * Writes the data of a map to its cache file.
+     */
+    void write(const std::string &mapFile, unsigned long checksum,
+               const MapData &data);
+
+    /**
+     * Returns the checksum of the given file contents.
+     */
+    unsigned long checksum(const void *buffer, int size);
+
+    /**
+     * Returns the checksum of the given file, or 0 when it can't be read.
+     */
+    unsigned long fileChecksum(const std::string &fileName);
+}
+
+#endif // MAPCACHE_H
@@ -34,6 +34,7 @@
 #include "utils/stringutils.h"
 #include "utils/xml.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <zlib.h>
@@ -184,6 +185,20 @@ Map *MapReader::readMap(const std::string &filename)
         return NULL;
     }
 
+    // Skip inflating and parsing when the compiled map is up to date
+    const unsigned long checksum = MapCache::checksum(buffer, fileSize);
+    MapData data;
+
+    if (MapCache::read(filename, checksum, data))
+    {
+        logger->log("Using cached map %s", filename.c_str());
+        free(buffer);
+
+        map = createMap(data);
+        map->setProperty("_filename", filename);
+        return map;
+    }
+
     unsigned char *inflated;
     unsigned int inflatedSize;
 
@@ -219,9 +234,10 @@ Map *MapReader::readMap(const std::string &filename)
         {
             logger->log("Error: Not a map file (%s)!", filename.c_str());
         }
-        else
+        else if (readMapData(node, filename, data))
         {
-            map = readMap(node, filename);
+            MapCache::write(filename, checksum, data);
+            map = createMap(data);
         }
     }
     else
@@ -235,50 +251,54 @@ Map *MapReader::readMap(const std::string &filename)
 }
 
 Map *MapReader::readMap(xmlNodePtr node, const std::string &path)
+{
+    MapData data;
+    if (!readMapData(node, path, data))
+        return 0;
+
+    return createMap(data);
+}
+
+bool MapReader::readMapData(xmlNodePtr node, const std::string &path,
+                            MapData &data)
 {
     // Take the filename off the path
     const std::string pathDir = path.substr(0, path.rfind("/") + 1);
 
-    const int w = XML::getProperty(node, "width", 0);
-    const int h = XML::getProperty(node, "height", 0);
-    const int tilew = XML::getProperty(node, "tilewidth", -1);
-    const int tileh = XML::getProperty(node, "tileheight", -1);
+    data.width = XML::getProperty(node, "width", 0);
+    data.height = XML::getProperty(node, "height", 0);
+    data.tileWidth = XML::getProperty(node, "tilewidth", -1);
+    data.tileHeight = XML::getProperty(node, "tileheight", -1);
 
-    if (tilew < 0 || tileh < 0)
+    if (data.tileWidth < 0 || data.tileHeight < 0)
     {
         logger->log("MapReader: Warning: "
                     "Unitialized tile width or height value for map: %s",
                     path.c_str());
-        return 0;
+        return false;
     }
 
-    Map *map = new Map(w, h, tilew, tileh);
-
     for_each_xml_child_node(childNode, node)
     {
         if (xmlStrEqual(childNode->name, BAD_CAST "tileset"))
         {
-            Tileset *tileset = readTileset(childNode, pathDir, map);
-            if (tileset)
-            {
-                map->addTileset(tileset);
-            }
+            readTileset(childNode, pathDir, data);
         }
         else if (xmlStrEqual(childNode->name, BAD_CAST "layer"))
         {
-            readLayer(childNode, map);
+            readLayer(childNode, data);
         }
         else if (xmlStrEqual(childNode->name, BAD_CAST "properties"))
         {
-            readProperties(childNode, map);
+            readProperties(childNode, data);
         }
         else if (xmlStrEqual(childNode->name, BAD_CAST "objectgroup"))
         {
             // The object group offset is applied to each object individually
             const int tileOffsetX = XML::getProperty(childNode, "x", 0);
             const int tileOffsetY = XML::getProperty(childNode, "y", 0);
-            const int offsetX = tileOffsetX * tilew;
-            const int offsetY = tileOffsetY * tileh;
+            const int offsetX = tileOffsetX * data.tileWidth;
+            const int offsetY = tileOffsetY * data.tileHeight;
 
             for_each_xml_child_node(objectNode, childNode)
             {
@@ -295,38 +315,34 @@ Map *MapReader::readMap(xmlNodePtr node, const std::string &path)
                         continue;
                     }
 
-                    const std::string objName = XML::getProperty(objectNode, "name", "");
-                    const int objX = XML::getProperty(objectNode, "x", 0);
-                    const int objY = XML::getProperty(objectNode, "y", 0);
-                    const int objW = XML::getProperty(objectNode, "width", 0);
-                    const int objH = XML::getProperty(objectNode, "height", 0);
+                    MapData::Object object;
+                    object.name = XML::getProperty(objectNode, "name", "");
+                    object.x = XML::getProperty(objectNode, "x", 0);
+                    object.y = XML::getProperty(objectNode, "y", 0);
+                    object.width = XML::getProperty(objectNode, "width", 0);
+                    object.height = XML::getProperty(objectNode, "height", 0);
 
                     logger->log("- Loading object name: %s type: %s at %d:%d",
-                                objName.c_str(), objType.c_str(),
-                                objX, objY);
+                                object.name.c_str(), objType.c_str(),
+                                object.x, object.y);
 
                     if (objType == "PARTICLE_EFFECT")
                     {
-                        if (objName.empty())
+                        if (object.name.empty())
                         {
                             logger->log("   Warning: No particle file given");
                             continue;
                         }
 
-                        map->addParticleEffect(objName,
-                                               objX + offsetX,
-                                               objY + offsetY,
-                                               objW, objH);
+                        object.type = MapData::PARTICLE_EFFECT;
+                        object.x += offsetX;
+                        object.y += offsetY;
+                        data.objects.push_back(object);
                     }
                     else if (objType == "WARP")
                     {
-                        if (config.getValue("showWarps", 1))
-                        {
-                            map->addParticleEffect(
-                                     paths.getStringValue("particles")
-                                     + paths.getStringValue("portalEffectFile"),
-                                                   objX, objY, objW, objH);
-                        }
+                        object.type = MapData::WARP;
+                        data.objects.push_back(object);
                     }
                     else
                     {
@@ -337,12 +353,125 @@ Map *MapReader::readMap(xmlNodePtr node, const std::string &path)
         }
     }
 
+    return true;
+}
+
+static void setTile(Map *map, MapLayer *layer, int x, int y, int gid)
+{
+    const Tileset * const set = map->getTilesetWithGid(gid);
+    if (layer)
+    {
+        // Set regular tile on a layer
+        Image * const img = set ? set->get(gid - set->getFirstGid()) : 0;
+        layer->setTile(x, y, img);
+    }
+    else
+    {
+        // Set collision tile
+        if (set && (gid - set->getFirstGid() == 1))
+            map->blockTile(x, y, Map::BLOCKTYPE_WALL);
+    }
+}
+
+Map *MapReader::createMap(const MapData &data)
+{
+    ResourceManager *resman = ResourceManager::getInstance();
+    Map *map = new Map(data.width, data.height,
+                       data.tileWidth, data.tileHeight);
+
+    for (std::vector<MapData::Tileset>::const_iterator it =
+         data.tilesets.begin(), it_end = data.tilesets.end();
+         it != it_end; ++it)
+    {
+        Image *tilebmp = resman->getImage(it->image);
+        if (!tilebmp)
+        {
+            logger->log("Warning: Failed to load tileset (%s)",
+                        it->image.c_str());
+            continue;
+        }
+
+        Tileset *set = new Tileset(tilebmp, it->tileWidth, it->tileHeight,
+                                   it->firstGid);
+        tilebmp->decRef();
+        map->addTileset(set);
+
+        for (std::vector<MapData::TileAnimation>::const_iterator ani_it =
+             it->animations.begin(), ani_end = it->animations.end();
+             ani_it != ani_end; ++ani_it)
+        {
+            Animation *ani = new Animation;
+            for (std::vector<MapData::AnimationFrame>::const_iterator frame =
+                 ani_it->frames.begin(); frame != ani_it->frames.end();
+                 ++frame)
+            {
+                ani->addFrame(set->get(frame->index), frame->delay, 0, 0);
+            }
+
+            map->addAnimation(ani_it->gid, new TileAnimation(ani));
+        }
+    }
+
+    for (std::vector<MapData::Layer>::const_iterator it =
+         data.layers.begin(), it_end = data.layers.end(); it != it_end; ++it)
+    {
+        const int w = it->width;
+        const int h = it->height;
+        MapLayer *layer = 0;
+
+        if (!it->collision)
+        {
+            layer = new MapLayer(it->offsetX, it->offsetY, w, h, it->fringe);
+            map->addLayer(layer);
+        }
+
+        const int count = std::min<int>(it->tiles.size(), w * h);
+        for (int i = 0; i < count; ++i)
+        {
+            const int gid = it->tiles[i];
+            const int x = i % w;
+            const int y = i / w;
+
+            setTile(map, layer, x, y, gid);
+
+            if (it->animated && layer)
+            {
+                TileAnimation *ani = map->getAnimationForGid(gid);
+                if (ani)
+                    ani->addAffectedTile(layer, i);
+            }
+        }
+    }
+
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator
+         it = data.properties.begin(), it_end = data.properties.end();
+         it != it_end; ++it)
+    {
+        map->setProperty(it->first, it->second);
+    }
+
+    for (std::vector<MapData::Object>::const_iterator it =
+         data.objects.begin(), it_end = data.objects.end(); it != it_end; ++it)
+    {
+        if (it->type == MapData::PARTICLE_EFFECT)
+        {
+            map->addParticleEffect(it->name, it->x, it->y,
+                                   it->width, it->height);
+        }
+        else if (it->type == MapData::WARP && config.getValue("showWarps", 1))
+        {
+            map->addParticleEffect(paths.getStringValue("particles")
+                                   + paths.getStringValue("portalEffectFile"),
+                                   it->x, it->y, it->width, it->height);
+        }
+    }
+
     map->initializeAmbientLayers();
 
     return map;
 }
 
-void MapReader::readProperties(xmlNodePtr node, Properties *props)
+void MapReader::readProperties(xmlNodePtr node, MapData &data)
 {
     for_each_xml_child_node(childNode, node)
     {
@@ -354,47 +483,32 @@ void MapReader::readProperties(xmlNodePtr node, Properties *props)
         const std::string value = XML::getProperty(childNode, "value", "");
 
         if (!name.empty() && !value.empty())
-            props->setProperty(name, value);
+            data.properties.push_back(std::make_pair(name, value));
     }
 }
 
-static void setTile(Map *map, MapLayer *layer, int x, int y, int gid)
+void MapReader::readLayer(xmlNodePtr node, MapData &data)
 {
-    const Tileset * const set = map->getTilesetWithGid(gid);
-    if (layer)
-    {
-        // Set regular tile on a layer
-        Image * const img = set ? set->get(gid - set->getFirstGid()) : 0;
-        layer->setTile(x, y, img);
-    }
-    else
-    {
-        // Set collision tile
-        if (set && (gid - set->getFirstGid() == 1))
-            map->blockTile(x, y, Map::BLOCKTYPE_WALL);
-    }
-}
+    data.layers.push_back(MapData::Layer());
+    MapData::Layer &layer = data.layers.back();
 
-void MapReader::readLayer(xmlNodePtr node, Map *map)
-{
     // Layers are not necessarily the same size as the map
-    const int w = XML::getProperty(node, "width", map->getWidth());
-    const int h = XML::getProperty(node, "height", map->getHeight());
-    const int offsetX = XML::getProperty(node, "x", 0);
-    const int offsetY = XML::getProperty(node, "y", 0);
+    const int w = XML::getProperty(node, "width", data.width);
+    const int h = XML::getProperty(node, "height", data.height);
     std::string name = XML::getProperty(node, "name", "");
     name = toLower(name);
 
-    const bool isFringeLayer = (name.substr(0,6) == "fringe");
-    const bool isCollisionLayer = (name.substr(0,9) == "collision");
+    layer.name = name;
+    layer.offsetX = XML::getProperty(node, "x", 0);
+    layer.offsetY = XML::getProperty(node, "y", 0);
+    layer.width = w;
+    layer.height = h;
+    layer.fringe = (name.substr(0,6) == "fringe");
+    layer.collision = (name.substr(0,9) == "collision");
+    layer.animated = false;
 
-    MapLayer *layer = 0;
-
-    if (!isCollisionLayer)
-    {
-        layer = new MapLayer(offsetX, offsetY, w, h, isFringeLayer);
-        map->addLayer(layer);
-    }
+    // Tiles missing from the data are left empty
+    layer.tiles.assign(w * h, 0);
 
     logger->log("- Loading layer \"%s\"", name.c_str());
     int x = 0;
@@ -467,6 +581,9 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
                     }
                 }
 
+                // Only tiles from encoded data are animated
+                layer.animated = true;
+
                 for (int i = 0; i < binLen - 3; i += 4)
                 {
                     const int gid = binData[i] |
@@ -474,13 +591,7 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
                         binData[i + 2] << 16 |
                         binData[i + 3] << 24;
 
-                    setTile(map, layer, x, y, gid);
-
-                    TileAnimation* ani = map->getAnimationForGid(gid);
-                    if (ani)
-                    {
-                        ani->addAffectedTile(layer, x + y * w);
-                    }
+                    layer.tiles[x + y * w] = gid;
 
                     x++;
                     if (x == w)
@@ -504,7 +615,7 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
                     continue;
 
                 const int gid = XML::getProperty(childNode2, "gid", -1);
-                setTile(map, layer, x, y, gid);
+                layer.tiles[x + y * w] = gid;
 
                 x++;
                 if (x == w)
@@ -526,13 +637,14 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
     }
 }
 
-Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
-                                Map *map)
+void MapReader::readTileset(xmlNodePtr node, const std::string &path,
+                            MapData &data)
 {
-    int firstGid = XML::getProperty(node, "firstgid", 0);
+    MapData::Tileset set;
+    set.firstGid = XML::getProperty(node, "firstgid", 0);
     XML::Document* doc = NULL;
-    Tileset *set = NULL;
     std::string pathDir(path);
+    bool hasImage = false;
 
     if (xmlHasProp(node, BAD_CAST "source"))
     {
@@ -542,12 +654,18 @@ Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
         doc = new XML::Document(filename);
         node = doc->rootNode();
 
+        // The cached map is outdated when the tileset changes
+        MapData::Dependency dependency;
+        dependency.file = filename;
+        dependency.checksum = MapCache::fileChecksum(filename);
+        data.dependencies.push_back(dependency);
+
         // Reset path to be realtive to the tsx file
         pathDir = filename.substr(0, filename.rfind("/") + 1);
     }
 
-    const int tw = XML::getProperty(node, "tilewidth", map->getTileWidth());
-    const int th = XML::getProperty(node, "tileheight", map->getTileHeight());
+    set.tileWidth = XML::getProperty(node, "tilewidth", data.tileWidth);
+    set.tileHeight = XML::getProperty(node, "tileheight", data.tileHeight);
 
     for_each_xml_child_node(childNode, node)
     {
@@ -557,21 +675,8 @@ Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
 
             if (!source.empty())
             {
-                std::string sourceStr = resolveRelativePath(pathDir, source);
-
-                ResourceManager *resman = ResourceManager::getInstance();
-                Image* tilebmp = resman->getImage(sourceStr);
-
-                if (tilebmp)
-                {
-                    set = new Tileset(tilebmp, tw, th, firstGid);
-                    tilebmp->decRef();
-                }
-                else
-                {
-                    logger->log("Warning: Failed to load tileset (%s)",
-                            source.c_str());
-                }
+                set.image = resolveRelativePath(pathDir, source);
+                hasImage = true;
             }
         }
         else if (xmlStrEqual(childNode->name, BAD_CAST "tile"))
@@ -580,7 +685,7 @@ Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
             {
                 if (!xmlStrEqual(tileNode->name, BAD_CAST "properties")) continue;
 
-                int tileGID = firstGid + XML::getProperty(childNode, "id", 0);
+                int tileGID = set.firstGid + XML::getProperty(childNode, "id", 0);
 
                 // read tile properties to a map for simpler handling
                 std::map<std::string, int> tileProperties;
@@ -594,28 +699,30 @@ Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
                 }
 
                 // create animation
-                if (!set) continue;
+                if (!hasImage) continue;
 
-                Animation *ani = new Animation;
+                MapData::TileAnimation ani;
+                ani.gid = tileGID;
                 for (int i = 0; ;i++)
                 {
                     std::map<std::string, int>::iterator iFrame, iDelay;
                     iFrame = tileProperties.find("animation-frame" + toString(i));
                     iDelay = tileProperties.find("animation-delay" + toString(i));
                     if (iFrame != tileProperties.end() && iDelay != tileProperties.end())
-                        ani->addFrame(set->get(iFrame->second), iDelay->second, 0, 0);
+                    {
+                        MapData::AnimationFrame frame;
+                        frame.index = iFrame->second;
+                        frame.delay = iDelay->second;
+                        ani.frames.push_back(frame);
+                    }
                     else
                         break;
                 }
 
-                if (ani->getLength() > 0)
-                {
-                    map->addAnimation(tileGID, new TileAnimation(ani));
-                    logger->log("Animation length: %d", ani->getLength());
-                }
-                else
+                if (!ani.frames.empty())
                 {
-                    delete ani;
+                    set.animations.push_back(ani);
+                    logger->log("Animation length: %d", (int) ani.frames.size());
                 }
             }
         }
@@ -623,5 +730,6 @@ Tileset *MapReader::readTileset(xmlNodePtr node, const std::string &path,
 
     delete doc;
 
-    return set;
+    if (hasImage)
+        data.tilesets.push_back(set);
 }
@@ -22,16 +22,17 @@
 #ifndef MAPREADER_H
 #define MAPREADER_H
 
+#include "resources/mapcache.h"
+
 #include <libxml/tree.h>
 
 #include <string>
 
 class Map;
-class Properties;
-class Tileset;
 
 /**
- * Reader for XML map files (*.tmx)
+ * Reader for XML map files (*.tmx). Parsed maps are kept in a compiled
+ * cache, see MapCache.
  */
 class MapReader
 {
@@ -48,25 +49,37 @@ class MapReader
         static Map *readMap(xmlNodePtr node, const std::string &path);
 
     private:
+        /**
+         * Reads the map element into the given map data.
+         *
+         * @return <code>false</code> when the map is invalid
+         */
+        static bool readMapData(xmlNodePtr node, const std::string &path,
+                                MapData &data);
+
+        /**
+         * Creates a map from the given map data.
+         */
+        static Map *createMap(const MapData &data);
+
         /**
          * Reads the properties element.
          *
          * @param node  The <code>properties</code> element.
-         * @param props The Properties instance to which the properties will
-         *              be assigned.
+         * @param data  The map data to which the properties will be added.
          */
-        static void readProperties(xmlNodePtr node, Properties* props);
+        static void readProperties(xmlNodePtr node, MapData &data);
 
         /**
-         * Reads a map layer and adds it to the given map.
+         * Reads a map layer and adds it to the given map data.
          */
-        static void readLayer(xmlNodePtr node, Map *map);
+        static void readLayer(xmlNodePtr node, MapData &data);
 
         /**
-         * Reads a tile set.
+         * Reads a tile set and adds it to the given map data.
          */
-        static Tileset *readTileset(xmlNodePtr node, const std::string &path,
-                                    Map *map);
+        static void readTileset(xmlNodePtr node, const std::string &path,
+                                MapData &data);
 };
 
 #endif
@@ -171,3 +171,14 @@ BeingInfo *MonsterDB::get(int id)
         return i->second;
     }
 }
+
+std::vector<int> MonsterDB::getIds()
+{
+    std::vector<int> ids;
+    for (BeingInfoIterator i = mMonsterInfos.begin(),
+         i_end = mMonsterInfos.end(); i != i_end; ++i)
+    {
+        ids.push_back(i->first);
+    }
+    return ids;
+}
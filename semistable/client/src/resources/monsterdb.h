@@ -22,6 +22,8 @@
 #ifndef MONSTER_DB_H
 #define MONSTER_DB_H
 
+#include <vector>
+
 class BeingInfo;
 
 /**
@@ -34,6 +36,11 @@ namespace MonsterDB
     void unload();
 
     BeingInfo *get(int id);
+
+    /**
+     * Returns the ids of all known monsters, in ascending order.
+     */
+    std::vector<int> getIds();
 }
 
 #endif
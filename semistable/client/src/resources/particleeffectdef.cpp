@@ -0,0 +1,162 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resources/particleeffectdef.h"
+
+#include "animationparticle.h"
+#include "imageparticle.h"
+#include "log.h"
+#include "particle.h"
+#include "rotationalparticle.h"
+#include "simpleanimation.h"
+
+#include "resources/image.h"
+#include "resources/resourcemanager.h"
+
+#include "utils/xml.h"
+
+Resource *ParticleEffectDef::load(void *buffer, unsigned bufferSize)
+{
+    XML::Document doc(static_cast<const char *>(buffer), bufferSize);
+    xmlNodePtr rootNode = doc.rootNode();
+
+    if (!rootNode || !xmlStrEqual(rootNode->name, BAD_CAST "effect"))
+        return NULL;
+
+    ParticleEffectDef *def = new ParticleEffectDef;
+
+    for_each_xml_child_node(effectChildNode, rootNode)
+    {
+        // We're only interested in particles
+        if (xmlStrEqual(effectChildNode->name, BAD_CAST "particle"))
+            def->loadParticle(effectChildNode);
+    }
+
+    return def;
+}
+
+ParticleEffectDef::~ParticleEffectDef()
+{
+    for (std::vector<ParticleDef>::iterator i = mParticles.begin(),
+         i_end = mParticles.end(); i != i_end; ++i)
+    {
+        if (i->image)
+            i->image->decRef();
+    }
+}
+
+void ParticleEffectDef::loadParticle(xmlNodePtr particleNode)
+{
+    mParticles.push_back(ParticleDef());
+    ParticleDef &def = mParticles.back();
+
+    def.type = PARTICLE_PLAIN;
+    def.image = NULL;
+
+    // Determine the exact particle type
+    xmlNodePtr node;
+
+    // Animation
+    if ((node = XML::findFirstChildByName(particleNode, "animation")))
+    {
+        if (SimpleAnimation::initializeAnimation(&def.animation, node) &&
+            def.animation.getLength() > 0)
+            def.type = PARTICLE_ANIMATION;
+    }
+    // Rotational
+    else if ((node = XML::findFirstChildByName(particleNode, "rotation")))
+    {
+        if (SimpleAnimation::initializeAnimation(&def.animation, node) &&
+            def.animation.getLength() > 0)
+            def.type = PARTICLE_ROTATION;
+    }
+    // Image
+    else if ((node = XML::findFirstChildByName(particleNode, "image")))
+    {
+        ResourceManager *resman = ResourceManager::getInstance();
+        def.image = resman->getImage((const char*)
+                node->xmlChildrenNode->content);
+        if (def.image)
+            def.type = PARTICLE_IMAGE;
+    }
+
+    // Read the basic properties of the particle
+    def.offset.x = XML::getFloatProperty(particleNode, "position-x", 0);
+    def.offset.y = XML::getFloatProperty(particleNode, "position-y", 0);
+    def.offset.z = XML::getFloatProperty(particleNode, "position-z", 0);
+    def.lifetime = XML::getProperty(particleNode, "lifetime", -1);
+    def.sizeAdjustable =
+        "false" != XML::getProperty(particleNode, "size-adjustable", "false");
+
+    // Look for additional emitters for this particle
+    for_each_xml_child_node(emitterNode, particleNode)
+    {
+        if (!xmlStrEqual(emitterNode->name, BAD_CAST "emitter"))
+            continue;
+
+        def.emitters.push_back(ParticleEmitter(emitterNode, NULL, NULL));
+    }
+}
+
+Particle *ParticleEffectDef::instantiate(Map *map, const Vector &position,
+                                         int rotation,
+                                         std::list<Particle *> &particles) const
+{
+    Particle *newParticle = NULL;
+
+    for (std::vector<ParticleDef>::const_iterator i = mParticles.begin(),
+         i_end = mParticles.end(); i != i_end; ++i)
+    {
+        switch (i->type)
+        {
+            case PARTICLE_ANIMATION:
+                newParticle = new AnimationParticle(map,
+                                                    new Animation(i->animation));
+                break;
+            case PARTICLE_ROTATION:
+                newParticle = new RotationalParticle(map,
+                                                     new Animation(i->animation));
+                break;
+            case PARTICLE_IMAGE:
+                newParticle = new ImageParticle(map, i->image);
+                break;
+            default:
+                newParticle = new Particle(map);
+                break;
+        }
+
+        newParticle->moveTo(position + i->offset);
+        newParticle->setLifetime(i->lifetime);
+        newParticle->setAllowSizeAdjust(i->sizeAdjustable);
+
+        for (std::list<ParticleEmitter>::const_iterator
+             e = i->emitters.begin(), e_end = i->emitters.end();
+             e != e_end; ++e)
+        {
+            ParticleEmitter *newEmitter = new ParticleEmitter(*e);
+            newEmitter->instantiate(newParticle, map, rotation);
+            newParticle->addEmitter(newEmitter);
+        }
+
+        particles.push_back(newParticle);
+    }
+
+    return newParticle;
+}
@@ -0,0 +1,107 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARTICLEEFFECTDEF_H
+#define PARTICLEEFFECTDEF_H
+
+#include "particleemitter.h"
+#include "vector.h"
+
+#include "resources/animation.h"
+#include "resources/resource.h"
+
+#include <list>
+#include <vector>
+
+class Image;
+class Map;
+class Particle;
+
+/**
+ * A parsed particle effect file. The definition is immutable once loaded,
+ * and is turned into particles by instantiating it. This way the XML of an
+ * effect is only parsed once, no matter how often the effect is spawned.
+ */
+class ParticleEffectDef : public Resource
+{
+    public:
+        /**
+         * Loads a particle effect definition from a buffer in memory.
+         *
+         * @param buffer     The buffer containing the effect XML.
+         * @param bufferSize The size of the buffer in bytes.
+         *
+         * @return <code>NULL</code> if an error occurred, a valid pointer
+         *         otherwise.
+         */
+        static Resource *load(void *buffer, unsigned bufferSize);
+
+        /**
+         * Creates the particles described by this definition.
+         *
+         * @param map       the map the particles appear on
+         * @param position  the origin of the effect
+         * @param rotation  rotation of the emitters in degrees
+         * @param particles the list the created particles are appended to
+         * @return the last particle created, or <code>NULL</code> if the
+         *         effect defines no particles
+         */
+        Particle *instantiate(Map *map, const Vector &position, int rotation,
+                              std::list<Particle *> &particles) const;
+
+    private:
+        /**
+         * The kind of particle a definition creates.
+         */
+        enum ParticleType
+        {
+            PARTICLE_PLAIN,
+            PARTICLE_IMAGE,
+            PARTICLE_ANIMATION,
+            PARTICLE_ROTATION
+        };
+
+        /**
+         * Definition of a single particle of the effect.
+         */
+        struct ParticleDef
+        {
+            ParticleType type;
+            Image *image;
+            Animation animation;
+            Vector offset;
+            int lifetime;
+            bool sizeAdjustable;
+            std::list<ParticleEmitter> emitters;
+        };
+
+        ParticleEffectDef() {}
+
+        ~ParticleEffectDef();
+
+        /**
+         * Parses a particle node of the effect.
+         */
+        void loadParticle(xmlNodePtr particleNode);
+
+        std::vector<ParticleDef> mParticles;
+};
+
+#endif // PARTICLEEFFECTDEF_H
@@ -22,12 +22,14 @@
 #include "resources/resourcemanager.h"
 
 #include "client.h"
+#include "configuration.h"
 #include "log.h"
 
 #include "resources/dye.h"
 #include "resources/image.h"
 #include "resources/imageset.h"
 #include "resources/music.h"
+#include "resources/particleeffectdef.h"
 #include "resources/soundeffect.h"
 #include "resources/spritedef.h"
 
@@ -40,21 +42,48 @@
 
 #include <sys/time.h>
 
+/** Number of threads decoding images in the background. */
+static const int LOADER_THREADS = 2;
+
 ResourceManager *ResourceManager::instance = NULL;
 
 ResourceManager::ResourceManager()
-  : mOldestOrphan(0)
+  : mOldestOrphan(0),
+    mLastCacheClear(0),
+    mLoaderSemaphore(SDL_CreateSemaphore(0)),
+    mLoaderQuit(false)
 {
     logger->log("Initializing resource manager...");
 }
 
 ResourceManager::~ResourceManager()
 {
+    stopLoaderThreads();
+    SDL_DestroySemaphore(mLoaderSemaphore);
+
     mResources.insert(mOrphanedResources.begin(), mOrphanedResources.end());
 
-    // Release any remaining spritedefs first because they depend on image sets
+    // Release any remaining particle effects first because they depend on
+    // images
     ResourceIterator iter = mResources.begin();
     while (iter != mResources.end())
+    {
+        if (dynamic_cast<ParticleEffectDef*>(iter->second) != 0)
+        {
+            cleanUp(iter->second);
+            ResourceIterator toErase = iter;
+            ++iter;
+            mResources.erase(toErase);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    // Release any remaining spritedefs first because they depend on image sets
+    iter = mResources.begin();
+    while (iter != mResources.end())
     {
         if (dynamic_cast<SpriteDef*>(iter->second) != 0)
         {
@@ -116,6 +145,13 @@ void ResourceManager::cleanOrphans()
     // Delete orphaned resources after 30 seconds.
     time_t oldest = tv.tv_sec, threshold = oldest - 30;
 
+    if (mLastCacheClear < threshold)
+    {
+        mFailedImages.clear();
+        mSpriteImages.clear();
+        mLastCacheClear = tv.tv_sec;
+    }
+
     if (mOrphanedResources.empty() || mOldestOrphan >= threshold) return;
 
     ResourceIterator iter = mOrphanedResources.begin();
@@ -306,6 +342,15 @@ struct DyedImageLoader
     static Resource *load(void *v)
     {
         DyedImageLoader *l = static_cast< DyedImageLoader * >(v);
+
+        // Use the result of a background decode when there is one
+        if (SDL_Surface *surface = l->manager->takeDecodedImage(l->path))
+        {
+            Image *image = Image::load(surface);
+            SDL_FreeSurface(surface);
+            return image;
+        }
+
         std::string path = l->path;
         std::string::size_type p = path.find('|');
         Dye *d = NULL;
@@ -314,6 +359,7 @@ struct DyedImageLoader
             d = new Dye(path.substr(p + 1));
             path = path.substr(0, p);
         }
+
         int fileSize;
         void *buffer = l->manager->loadFile(path, fileSize);
         if (!buffer)
@@ -379,6 +425,345 @@ SpriteDef *ResourceManager::getSprite(const std::string &path, int variant)
     return static_cast<SpriteDef*>(get(ss.str(), SpriteDefLoader::load, &l));
 }
 
+ParticleEffectDef *ResourceManager::getParticleEffect(const std::string &idPath)
+{
+    return static_cast<ParticleEffectDef*>(load(idPath,
+                                                ParticleEffectDef::load));
+}
+
+bool ResourceManager::requestImage(const std::string &idPath)
+{
+    if (mResources.find(idPath) != mResources.end() ||
+        mOrphanedResources.find(idPath) != mOrphanedResources.end() ||
+        mFailedImages.find(idPath) != mFailedImages.end())
+        return true;
+
+    if (mImageRequests.find(idPath) != mImageRequests.end())
+        return false;
+
+    // Without loader threads, images are only loaded on demand
+    if (!startLoaderThreads())
+        return true;
+
+    // The dye is parsed here, since it may log errors
+    ImageRequest *request = new ImageRequest;
+    std::string::size_type p = idPath.find('|');
+    if (p != std::string::npos)
+    {
+        request->path = idPath.substr(0, p);
+        request->dye = new Dye(idPath.substr(p + 1));
+    }
+    else
+    {
+        request->path = idPath;
+        request->dye = NULL;
+    }
+    request->state = ImageRequest::QUEUED;
+    request->surface = NULL;
+
+    mImageRequests[idPath] = request;
+
+    mLoaderMutex.lock();
+    mRequestQueue.push_back(request);
+    mLoaderMutex.unlock();
+    SDL_SemPost(mLoaderSemaphore);
+
+    return false;
+}
+
+bool ResourceManager::requestSprite(const std::string &path)
+{
+    if (mResources.find(path + "[0]") != mResources.end() ||
+        mOrphanedResources.find(path + "[0]") != mOrphanedResources.end())
+        return true;
+
+    std::map<std::string, std::vector<std::string> >::iterator it =
+        mSpriteImages.find(path);
+
+    if (it == mSpriteImages.end())
+    {
+        // Without loader threads, sprites are only loaded on demand
+        if (!startLoaderThreads())
+            return true;
+
+        // The sprite definition is parsed by a loader thread
+        SpriteRequests::iterator r = mSpriteRequests.find(path);
+        if (r == mSpriteRequests.end())
+        {
+            SpriteRequest *request = new SpriteRequest;
+            request->path = path;
+            request->spritesDir = paths.getStringValue("sprites");
+            request->done = false;
+            mSpriteRequests[path] = request;
+
+            mLoaderMutex.lock();
+            mSpriteQueue.push_back(request);
+            mLoaderMutex.unlock();
+            SDL_SemPost(mLoaderSemaphore);
+            return false;
+        }
+
+        SpriteRequest *request = r->second;
+
+        mLoaderMutex.lock();
+        const bool done = request->done;
+        mLoaderMutex.unlock();
+
+        if (!done)
+            return false;
+
+        it = mSpriteImages.insert(
+                std::make_pair(path, std::vector<std::string>())).first;
+        it->second.swap(request->images);
+        delete request;
+        mSpriteRequests.erase(r);
+    }
+
+    // Request all images, so that they are decoded in parallel
+    bool ready = true;
+    for (std::vector<std::string>::const_iterator i = it->second.begin(),
+         i_end = it->second.end(); i != i_end; ++i)
+    {
+        if (!requestImage(*i))
+            ready = false;
+    }
+
+    return ready;
+}
+
+void ResourceManager::processDecodedImages()
+{
+    if (mImageRequests.empty())
+        return;
+
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    const time_t timestamp = tv.tv_sec;
+
+    ImageRequests::iterator it = mImageRequests.begin();
+    while (it != mImageRequests.end())
+    {
+        ImageRequest *request = it->second;
+
+        mLoaderMutex.lock();
+        const bool done = request->state == ImageRequest::DONE;
+        mLoaderMutex.unlock();
+
+        if (!done)
+        {
+            ++it;
+            continue;
+        }
+
+        const std::string &idPath = it->first;
+        Image *image = NULL;
+
+        if (request->surface)
+        {
+            image = Image::load(request->surface);
+            SDL_FreeSurface(request->surface);
+        }
+
+        if (!image)
+        {
+            mFailedImages.insert(idPath);
+        }
+        else if (mResources.find(idPath) == mResources.end() &&
+                 mOrphanedResources.find(idPath) == mOrphanedResources.end())
+        {
+            // Nobody uses the image yet, so it starts out as an orphan
+            image->mIdPath = idPath;
+            image->mTimeStamp = timestamp;
+            if (mOrphanedResources.empty()) mOldestOrphan = timestamp;
+            mOrphanedResources[idPath] = image;
+        }
+        else
+        {
+            delete image;
+        }
+
+        delete request->dye;
+        delete request;
+
+        ImageRequests::iterator toErase = it;
+        ++it;
+        mImageRequests.erase(toErase);
+    }
+}
+
+SDL_Surface *ResourceManager::takeDecodedImage(const std::string &idPath)
+{
+    ImageRequests::iterator it = mImageRequests.find(idPath);
+    if (it == mImageRequests.end())
+        return NULL;
+
+    ImageRequest *request = it->second;
+
+    mLoaderMutex.lock();
+
+    if (request->state == ImageRequest::QUEUED)
+        mRequestQueue.remove(request);
+
+    // The image is being decoded right now
+    while (request->state == ImageRequest::DECODING)
+        mDecodedCondition.wait(&mLoaderMutex);
+
+    mLoaderMutex.unlock();
+
+    SDL_Surface *surface = request->surface;
+
+    delete request->dye;
+    delete request;
+    mImageRequests.erase(it);
+
+    return surface;
+}
+
+int ResourceManager::loaderThread(void *data)
+{
+    ResourceManager *resman = static_cast<ResourceManager*>(data);
+
+    for (;;)
+    {
+        SDL_SemWait(resman->mLoaderSemaphore);
+
+        resman->mLoaderMutex.lock();
+
+        if (resman->mLoaderQuit)
+        {
+            resman->mLoaderMutex.unlock();
+            break;
+        }
+
+        // Sprite definitions first, since their images are requested next
+        if (!resman->mSpriteQueue.empty())
+        {
+            SpriteRequest *request = resman->mSpriteQueue.front();
+            resman->mSpriteQueue.pop_front();
+            resman->mLoaderMutex.unlock();
+
+            std::vector<std::string> images;
+            SpriteDef::getImageFiles(request->path, request->spritesDir,
+                                     images);
+
+            resman->mLoaderMutex.lock();
+            request->images.swap(images);
+            request->done = true;
+            resman->mLoaderMutex.unlock();
+            continue;
+        }
+
+        // The request may have been taken over by the main thread
+        if (resman->mRequestQueue.empty())
+        {
+            resman->mLoaderMutex.unlock();
+            continue;
+        }
+
+        ImageRequest *request = resman->mRequestQueue.front();
+        resman->mRequestQueue.pop_front();
+        request->state = ImageRequest::DECODING;
+
+        resman->mLoaderMutex.unlock();
+
+        // Nothing is logged here, since the logger is not thread safe
+        SDL_Surface *surface = NULL;
+        PHYSFS_file *file = PHYSFS_openRead(request->path.c_str());
+
+        if (file)
+        {
+            const int fileSize = PHYSFS_fileLength(file);
+            void *buffer = malloc(fileSize);
+            const int read = PHYSFS_read(file, buffer, 1, fileSize);
+            PHYSFS_close(file);
+
+            if (read == fileSize)
+                surface = Image::decode(buffer, fileSize, request->dye);
+
+            free(buffer);
+        }
+
+        resman->mLoaderMutex.lock();
+        request->surface = surface;
+        request->state = ImageRequest::DONE;
+        resman->mDecodedCondition.broadcast();
+        resman->mLoaderMutex.unlock();
+    }
+
+    return 0;
+}
+
+bool ResourceManager::startLoaderThreads()
+{
+    if (!mLoaderThreads.empty())
+        return true;
+
+    // Initialize the decoders before the loader threads would do so at the
+    // same time
+#if SDL_IMAGE_MAJOR_VERSION > 1 || SDL_IMAGE_MINOR_VERSION > 2 || \
+    SDL_IMAGE_PATCHLEVEL >= 10
+    const int formats = IMG_INIT_PNG | IMG_INIT_JPG;
+    if (!(IMG_Init(formats) & IMG_INIT_PNG))
+        logger->log("Warning: Unable to initialize PNG decoding: %s",
+                    IMG_GetError());
+#endif
+
+    for (int i = 0; i < LOADER_THREADS; ++i)
+    {
+        SDL_Thread *thread = SDL_CreateThread(loaderThread, this);
+        if (thread)
+            mLoaderThreads.push_back(thread);
+    }
+
+    if (mLoaderThreads.empty())
+    {
+        logger->log("Error: Unable to start loader threads: %s",
+                    SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void ResourceManager::stopLoaderThreads()
+{
+    mLoaderMutex.lock();
+    mLoaderQuit = true;
+    mLoaderMutex.unlock();
+
+    for (unsigned int i = 0; i < mLoaderThreads.size(); ++i)
+        SDL_SemPost(mLoaderSemaphore);
+
+    for (std::vector<SDL_Thread*>::iterator i = mLoaderThreads.begin(),
+         i_end = mLoaderThreads.end(); i != i_end; ++i)
+    {
+        SDL_WaitThread(*i, NULL);
+    }
+    mLoaderThreads.clear();
+
+    for (ImageRequests::iterator i = mImageRequests.begin(),
+         i_end = mImageRequests.end(); i != i_end; ++i)
+    {
+        if (i->second->surface)
+            SDL_FreeSurface(i->second->surface);
+        delete i->second->dye;
+        delete i->second;
+    }
+    mImageRequests.clear();
+    mRequestQueue.clear();
+
+    for (SpriteRequests::iterator i = mSpriteRequests.begin(),
+         i_end = mSpriteRequests.end(); i != i_end; ++i)
+    {
+        delete i->second;
+    }
+    mSpriteRequests.clear();
+    mSpriteQueue.clear();
+
+    mFailedImages.clear();
+    mSpriteImages.clear();
+}
+
 void ResourceManager::release(Resource *res)
 {
     ResourceIterator resIter = mResources.find(res->mIdPath);
@@ -468,6 +853,31 @@ bool ResourceManager::copyFile(const std::string &src, const std::string &dst)
     return true;
 }
 
+bool ResourceManager::writeFile(const std::string &fileName,
+                                const void *data, int size)
+{
+    const std::string::size_type pos = fileName.rfind('/');
+    if (pos != std::string::npos && !mkdir(fileName.substr(0, pos)))
+    {
+        logger->log("Write error: %s", PHYSFS_getLastError());
+        return false;
+    }
+
+    PHYSFS_file *file = PHYSFS_openWrite(fileName.c_str());
+    if (!file)
+    {
+        logger->log("Write error: %s", PHYSFS_getLastError());
+        return false;
+    }
+
+    const bool written = PHYSFS_write(file, data, 1, size) == size;
+    if (!written)
+        logger->log("Write error: %s", PHYSFS_getLastError());
+
+    PHYSFS_close(file);
+    return written;
+}
+
 std::vector<std::string> ResourceManager::loadTextFile(
         const std::string &fileName)
 {
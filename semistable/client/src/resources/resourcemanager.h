@@ -22,14 +22,20 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include "utils/mutex.h"
+
 #include <ctime>
+#include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
+class Dye;
 class Image;
 class ImageSet;
 class Music;
+class ParticleEffectDef;
 class Resource;
 class SoundEffect;
 class SpriteDef;
@@ -144,6 +150,19 @@ class ResourceManager
         */
         bool copyFile(const std::string &src, const std::string &dst);
 
+        /**
+         * Writes data to a file in the write directory, creating the
+         * directories leading to it as needed.
+         *
+         * @param fileName The name of the file relative to the write directory.
+         * @param data     The data to write.
+         * @param size     The size of the data in bytes.
+         * @return true on success, false on failure. An error message should
+         *         be in the log file.
+         */
+        bool writeFile(const std::string &fileName,
+                       const void *data, int size);
+
         /**
          * Convenience wrapper around ResourceManager::get for loading
          * images.
@@ -174,6 +193,49 @@ class ResourceManager
          */
         SpriteDef *getSprite(const std::string &path, int variant = 0);
 
+        /**
+         * Convenience wrapper around ResourceManager::get for loading
+         * particle effect definitions.
+         */
+        ParticleEffectDef *getParticleEffect(const std::string &idPath);
+
+        /**
+         * Starts decoding the given image on a loader thread, unless it is
+         * already loaded or being decoded. Accepts the same dye syntax as
+         * getImage.
+         *
+         * @return <code>true</code> if the image can be retrieved with
+         *         getImage without having to decode it first.
+         */
+        bool requestImage(const std::string &idPath);
+
+        /**
+         * Starts looking up and decoding the images of the given sprite
+         * definition on the loader threads.
+         *
+         * @return <code>true</code> if the sprite can be retrieved with
+         *         getSprite without having to decode any images first.
+         */
+        bool requestSprite(const std::string &path);
+
+        /**
+         * Finishes loading the images that were decoded by the loader
+         * threads, by converting them to the display format or uploading
+         * them as textures. They are kept as orphaned resources until they
+         * are used. Needs to be called regularly from the main thread.
+         */
+        void processDecodedImages();
+
+        /**
+         * Returns the surface decoded by a loader thread for the given
+         * image, waiting for it if it is being decoded right now. Requests
+         * that were not picked up by a loader thread yet are cancelled.
+         *
+         * @return the decoded surface, to be freed by the caller, or
+         *         <code>NULL</code> if the image was not decoded.
+         */
+        SDL_Surface *takeDecodedImage(const std::string &idPath);
+
         /**
          * Releases a resource, placing it in the set of orphaned resources.
          */
@@ -221,12 +283,81 @@ class ResourceManager
 
         void cleanOrphans();
 
+        /**
+         * Main function of the loader threads.
+         */
+        static int loaderThread(void *data);
+
+        /**
+         * Starts the loader threads, unless they are running already.
+         *
+         * @return whether there are loader threads.
+         */
+        bool startLoaderThreads();
+
+        /**
+         * Stops the loader threads and drops the requests that were not
+         * finished.
+         */
+        void stopLoaderThreads();
+
         static ResourceManager *instance;
         typedef std::map<std::string, Resource*> Resources;
         typedef Resources::iterator ResourceIterator;
         Resources mResources;
         Resources mOrphanedResources;
         time_t mOldestOrphan;
+
+        /**
+         * An image to be decoded by a loader thread. The state and surface
+         * are protected by the loader mutex.
+         */
+        struct ImageRequest
+        {
+            enum State {
+                QUEUED,
+                DECODING,
+                DONE
+            };
+
+            std::string path;       /**< File name without the dye. */
+            Dye *dye;
+            State state;
+            SDL_Surface *surface;   /**< Result, NULL on failure. */
+        };
+
+        typedef std::map<std::string, ImageRequest*> ImageRequests;
+
+        /**
+         * A sprite definition whose image files are looked up by a loader
+         * thread. The state and images are protected by the loader mutex.
+         */
+        struct SpriteRequest
+        {
+            std::string path;
+            std::string spritesDir; /**< Where included sprites are found. */
+            bool done;
+            std::vector<std::string> images;
+        };
+
+        typedef std::map<std::string, SpriteRequest*> SpriteRequests;
+
+        ImageRequests mImageRequests;       /**< Only used by main thread. */
+        SpriteRequests mSpriteRequests;     /**< Only used by main thread. */
+
+        // Forgotten along with the orphaned resources, so that images that
+        // failed to load are tried again
+        std::set<std::string> mFailedImages;
+        std::map<std::string, std::vector<std::string> > mSpriteImages;
+        time_t mLastCacheClear;
+
+        std::vector<SDL_Thread*> mLoaderThreads;
+        SDL_sem *mLoaderSemaphore;          /**< Counts queued requests. */
+        Mutex mLoaderMutex;
+        Condition mDecodedCondition;        /**< Signalled when decoded. */
+        std::list<ImageRequest*> mRequestQueue;
+        std::list<SpriteRequest*> mSpriteQueue;
+        bool mLoaderQuit;
 };
 
 #endif
@@ -34,6 +34,9 @@
 
 #include "utils/xml.h"
 
+#include <physfs.h>
+
+#include <cstdlib>
 #include <set>
 
 SpriteReference *SpriteReference::Empty = new SpriteReference(
@@ -84,6 +87,62 @@ SpriteDef *SpriteDef::load(const std::string &animationFile, int variant)
     return def;
 }
 
+void SpriteDef::getImageFiles(const std::string &animationFile,
+                              const std::string &spritesDir,
+                              std::vector<std::string> &files)
+{
+    std::string::size_type pos = animationFile.find('|');
+    std::string palettes;
+    if (pos != std::string::npos)
+        palettes = animationFile.substr(pos + 1);
+
+    // Read without the resource manager, which logs
+    PHYSFS_file *file = PHYSFS_openRead(animationFile.substr(0, pos).c_str());
+    if (!file)
+        return;
+
+    const int fileSize = PHYSFS_fileLength(file);
+    char *buffer = (char*) malloc(fileSize);
+    const int read = PHYSFS_read(file, buffer, 1, fileSize);
+    PHYSFS_close(file);
+
+    if (read == fileSize)
+    {
+        XML::Document doc(buffer, fileSize);
+        xmlNodePtr rootNode = doc.rootNode();
+
+        if (rootNode && xmlStrEqual(rootNode->name, BAD_CAST "sprite"))
+            getImageFiles(rootNode, palettes, spritesDir, files);
+    }
+
+    free(buffer);
+}
+
+void SpriteDef::getImageFiles(xmlNodePtr spriteNode,
+                              const std::string &palettes,
+                              const std::string &spritesDir,
+                              std::vector<std::string> &files)
+{
+    for_each_xml_child_node(node, spriteNode)
+    {
+        if (xmlStrEqual(node->name, BAD_CAST "imageset"))
+        {
+            std::string imageSrc = XML::getProperty(node, "src", "");
+            Dye::instantiate(imageSrc, palettes);
+            files.push_back(imageSrc);
+        }
+        else if (xmlStrEqual(node->name, BAD_CAST "include"))
+        {
+            const std::string filename = XML::getProperty(node, "file", "");
+            if (!filename.empty())
+            {
+                // Included sprites are loaded without palettes
+                getImageFiles(spritesDir + filename, spritesDir, files);
+            }
+        }
+    }
+}
+
 void SpriteDef::substituteAction(std::string complete, std::string with)
 {
     if (mActions.find(complete) == mActions.end())
@@ -29,6 +29,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 class Action;
 class ImageSet;
@@ -101,6 +102,18 @@ class SpriteDef : public Resource
          */
         static SpriteDef *load(const std::string &file, int variant);
 
+        /**
+         * Collects the image files used by a sprite definition file,
+         * including those of included sprites, without loading any of them.
+         * Nothing is logged and no configuration is read, so that this can
+         * be called from the loader threads.
+         *
+         * @param spritesDir the directory included sprites are found in
+         */
+        static void getImageFiles(const std::string &file,
+                                  const std::string &spritesDir,
+                                  std::vector<std::string> &files);
+
         /**
          * Returns the specified action.
          */
@@ -123,6 +136,15 @@ class SpriteDef : public Resource
          */
         ~SpriteDef();
 
+        /**
+         * Collects the image files used by the image sets of a sprite
+         * element.
+         */
+        static void getImageFiles(xmlNodePtr spriteNode,
+                                  const std::string &palettes,
+                                  const std::string &spritesDir,
+                                  std::vector<std::string> &files);
+
         /**
          * Loads a sprite element.
          */
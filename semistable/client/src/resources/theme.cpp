@@ -107,6 +107,7 @@ int Skin::getMinHeight() const
 Theme::Theme():
     Palette(THEME_COLORS_END),
     mMinimumOpacity(-1.0f),
+    mGuiAlpha(config, "guialpha"),
     mProgressColors(ProgressColors(THEME_PROG_END))
 {
     initDefaultThemePath();
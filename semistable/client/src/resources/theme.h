@@ -24,7 +24,7 @@
 #ifndef SKIN_H
 #define SKIN_H
 
-#include "configlistener.h"
+#include "configuration.h"
 #include "graphics.h"
 
 #include "gui/palette.h"
@@ -216,6 +216,13 @@ class Theme : public Palette, public ConfigListener
          */
         void setMinimumOpacity(float minimumOpacity);
 
+        /**
+         * Returns the value of the guialpha option, without needing to look
+         * it up in the configuration.
+         */
+        float getGuiAlpha() const
+        { return mGuiAlpha; }
+
         void optionChanged(const std::string &);
 
     private:
@@ -243,6 +250,8 @@ class Theme : public Palette, public ConfigListener
          */
         float mMinimumOpacity;
 
+        FloatOption mGuiAlpha;
+
         typedef std::vector<DyePalette*> ProgressColors;
         ProgressColors mProgressColors;
 };
@@ -44,7 +44,7 @@ SimpleAnimation::SimpleAnimation(xmlNodePtr animationNode):
     mAnimationPhase(0),
     mInitialized(false)
 {
-    initializeAnimation(animationNode);
+    mInitialized = initializeAnimation(mAnimation, animationNode);
     mCurrentFrame = mAnimation->getFrame(0);
 }
 
@@ -115,12 +115,11 @@ Image *SimpleAnimation::getCurrentImage() const
         return NULL;
 }
 
-void SimpleAnimation::initializeAnimation(xmlNodePtr animationNode)
+bool SimpleAnimation::initializeAnimation(Animation *animation,
+                                          xmlNodePtr animationNode)
 {
-    mInitialized = false;
-
     if (!animationNode)
-        return;
+        return false;
 
     ImageSet *imageset = ResourceManager::getInstance()->getImageSet(
         XML::getProperty(animationNode, "imageset", ""),
@@ -129,7 +128,7 @@ void SimpleAnimation::initializeAnimation(xmlNodePtr animationNode)
     );
 
     if (!imageset)
-        return;
+        return false;
 
     // Get animation frames
     for (   xmlNodePtr frameNode = animationNode->xmlChildrenNode;
@@ -160,7 +159,7 @@ void SimpleAnimation::initializeAnimation(xmlNodePtr animationNode)
                 continue;
             }
 
-            mAnimation->addFrame(img, delay, offsetX, offsetY);
+            animation->addFrame(img, delay, offsetX, offsetY);
         }
         else if (xmlStrEqual(frameNode->name, BAD_CAST "sequence"))
         {
@@ -183,15 +182,15 @@ void SimpleAnimation::initializeAnimation(xmlNodePtr animationNode)
                     continue;
                 }
 
-                mAnimation->addFrame(img, delay, offsetX, offsetY);
+                animation->addFrame(img, delay, offsetX, offsetY);
                 start++;
             }
         }
         else if (xmlStrEqual(frameNode->name, BAD_CAST "end"))
         {
-            mAnimation->addTerminator();
+            animation->addTerminator();
         }
     }
 
-    mInitialized = true;
+    return true;
 }
@@ -64,8 +64,14 @@ class SimpleAnimation
 
         Image *getCurrentImage() const;
 
+        /**
+         * Appends the frames described by the given XML node to the given
+         * animation. Returns false when the image set could not be loaded.
+         */
+        static bool initializeAnimation(Animation *animation,
+                                        xmlNodePtr animationNode);
+
     private:
-        void initializeAnimation(xmlNodePtr animationNode);
 
         /** The hosted animation. */
         Animation *mAnimation;
@@ -41,8 +41,9 @@ bool TextParticle::draw(Graphics *graphics, int offsetX, int offsetY) const
     if (!mAlive)
         return false;
 
-    int screenX = (int) mPos.x + offsetX;
-    int screenY = (int) mPos.y - (int) mPos.z + offsetY;
+    const Vector pos = getDrawPosition();
+    int screenX = (int) pos.x + offsetX;
+    int screenY = (int) pos.y - (int) pos.z + offsetY;
 
     float alpha = mAlpha * 255.0f;
 
@@ -43,9 +43,39 @@ private:
     Mutex(const Mutex&);  // prevent copying
     Mutex& operator=(const Mutex&);
 
+    friend class Condition;
+
     SDL_mutex *mMutex;
 };
 
+/**
+ * A condition lets threads wait until another thread signals that something
+ * they wait for has happened.
+ */
+class Condition
+{
+public:
+    Condition();
+    ~Condition();
+
+    /**
+     * Unlocks the given mutex, which has to be locked, and waits until the
+     * condition is signalled. The mutex is locked again on return.
+     */
+    void wait(Mutex *mutex);
+
+    /**
+     * Wakes up all threads waiting for the condition.
+     */
+    void broadcast();
+
+private:
+    Condition(const Condition&);  // prevent copying
+    Condition& operator=(const Condition&);
+
+    SDL_cond *mCondition;
+};
+
 /**
  * A convenience class for locking a mutex.
  */
@@ -83,6 +113,29 @@ inline void Mutex::unlock()
 }
 
 
+inline Condition::Condition()
+{
+    mCondition = SDL_CreateCond();
+}
+
+inline Condition::~Condition()
+{
+    SDL_DestroyCond(mCondition);
+}
+
+inline void Condition::wait(Mutex *mutex)
+{
+    if (SDL_CondWait(mCondition, mutex->mMutex) == -1)
+        logger->log("Condition waiting failed: %s", SDL_GetError());
+}
+
+inline void Condition::broadcast()
+{
+    if (SDL_CondBroadcast(mCondition) == -1)
+        logger->log("Condition signalling failed: %s", SDL_GetError());
+}
+
+
 inline MutexLocker::MutexLocker(Mutex *mutex):
     mMutex(mutex)
 {
@@ -0,0 +1,200 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/profiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <sys/time.h>
+
+/** Number of frames the statistics are calculated over. */
+static const int HISTORY_FRAMES = 120;
+
+/** Number of frames of which the events are kept for a trace. */
+static const int TRACE_FRAMES = 300;
+
+std::vector<Profiler::Section> Profiler::mSections;
+std::deque<Profiler::Event> Profiler::mEvents;
+std::deque<int> Profiler::mFrameEventCounts;
+int Profiler::mCurrentFrameEvents = 0;
+int Profiler::mHistoryPos = 0;
+int Profiler::mHistorySize = 0;
+int Profiler::mUsers = 0;
+bool Profiler::mEnabled = false;
+
+int Profiler::section(const std::string &name)
+{
+    for (unsigned i = 0; i < mSections.size(); ++i)
+    {
+        if (mSections[i].name == name)
+            return i;
+    }
+
+    Section section;
+    section.name = name;
+    section.frameTotal = 0;
+    section.history.resize(HISTORY_FRAMES, 0);
+    mSections.push_back(section);
+
+    return mSections.size() - 1;
+}
+
+void Profiler::acquire()
+{
+    if (mUsers++ > 0)
+        return;
+
+    mEnabled = true;
+
+    // Start over, so that old measurements don't mix with new ones
+    for (std::vector<Section>::iterator it = mSections.begin(),
+         it_end = mSections.end(); it != it_end; ++it)
+    {
+        it->frameTotal = 0;
+        std::fill(it->history.begin(), it->history.end(), 0);
+    }
+
+    mEvents.clear();
+    mFrameEventCounts.clear();
+    mCurrentFrameEvents = 0;
+    mHistoryPos = 0;
+    mHistorySize = 0;
+}
+
+void Profiler::release()
+{
+    if (mUsers > 0 && --mUsers == 0)
+        mEnabled = false;
+}
+
+int64_t Profiler::now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void Profiler::record(int section, int64_t start)
+{
+    if (!mEnabled)
+        return;
+
+    Event event;
+    event.section = section;
+    event.start = start;
+    event.duration = (int) (now() - start);
+
+    mSections[section].frameTotal += event.duration;
+    mEvents.push_back(event);
+    ++mCurrentFrameEvents;
+}
+
+void Profiler::endFrame()
+{
+    if (!mEnabled)
+        return;
+
+    for (std::vector<Section>::iterator it = mSections.begin(),
+         it_end = mSections.end(); it != it_end; ++it)
+    {
+        it->history[mHistoryPos] = (int) it->frameTotal;
+        it->frameTotal = 0;
+    }
+
+    mHistoryPos = (mHistoryPos + 1) % HISTORY_FRAMES;
+    mHistorySize = std::min(mHistorySize + 1, HISTORY_FRAMES);
+
+    // Drop the events of frames that are too old to be traced
+    mFrameEventCounts.push_back(mCurrentFrameEvents);
+    mCurrentFrameEvents = 0;
+
+    while ((int) mFrameEventCounts.size() > TRACE_FRAMES)
+    {
+        mEvents.erase(mEvents.begin(),
+                      mEvents.begin() + mFrameEventCounts.front());
+        mFrameEventCounts.pop_front();
+    }
+}
+
+Profiler::Stats Profiler::getStats(int section)
+{
+    Stats stats = { 0.0f, 0.0f, 0.0f };
+    if (mHistorySize == 0)
+        return stats;
+
+    const std::vector<int> &history = mSections[section].history;
+    std::vector<int> sorted(history.begin(), history.begin() + mHistorySize);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.median = sorted[mHistorySize / 2] / 1000.0f;
+    stats.p95 = sorted[mHistorySize * 95 / 100] / 1000.0f;
+    stats.max = sorted.back() / 1000.0f;
+    return stats;
+}
+
+/**
+ * Escapes the given string for use in a JSON string.
+ */
+static std::string escapeJson(const std::string &text)
+{
+    std::string result;
+    for (std::string::const_iterator it = text.begin(), it_end = text.end();
+         it != it_end; ++it)
+    {
+        if (*it == '"' || *it == '\\')
+            result += '\\';
+        result += *it;
+    }
+    return result;
+}
+
+bool Profiler::exportTrace(const std::string &fileName)
+{
+    std::ofstream file(fileName.c_str(), std::ios_base::trunc);
+    if (!file.is_open())
+        return false;
+
+    // Events are recorded when they end, so outer sections come later
+    int64_t base = mEvents.empty() ? 0 : mEvents.front().start;
+    for (std::deque<Event>::const_iterator it = mEvents.begin(),
+         it_end = mEvents.end(); it != it_end; ++it)
+    {
+        base = std::min(base, it->start);
+    }
+
+    file << "{\"traceEvents\":[\n";
+
+    for (std::deque<Event>::const_iterator it = mEvents.begin(),
+         it_end = mEvents.end(); it != it_end; ++it)
+    {
+        if (it != mEvents.begin())
+            file << ",\n";
+
+        file << "{\"name\":\"" << escapeJson(mSections[it->section].name)
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << (long) (it->start - base)
+             << ",\"dur\":" << it->duration << "}";
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return file.good();
+}
@@ -0,0 +1,160 @@
+/*
+ *  The Mana Client
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * Measures how long the parts of each frame take. The measurements feed
+ * rolling statistics, which are shown by the debug window, and can be
+ * exported as a trace file in the Chrome trace event format.
+ *
+ * Measuring only happens while the profiler is enabled, which is as long as
+ * any of its users (the debug window, a trace being recorded) holds on to
+ * it. Otherwise a ProfileScope costs a single branch.
+ */
+class Profiler
+{
+    public:
+        /**
+         * Statistics of a section over the recent frames, in milliseconds.
+         */
+        struct Stats
+        {
+            float median;
+            float p95;
+            float max;
+        };
+
+        /**
+         * Returns the id of the section with the given name, registering it
+         * when it is new. Ids stay valid for the lifetime of the client.
+         */
+        static int section(const std::string &name);
+
+        static int getSectionCount()
+        { return mSections.size(); }
+
+        static const std::string &getSectionName(int section)
+        { return mSections[section].name; }
+
+        /**
+         * Enables the profiler for another user. Measurements start over
+         * when the profiler was disabled before.
+         */
+        static void acquire();
+
+        /**
+         * Disables the profiler when no other user holds on to it.
+         */
+        static void release();
+
+        static bool isEnabled()
+        { return mEnabled; }
+
+        /**
+         * Returns the current time in microseconds.
+         */
+        static int64_t now();
+
+        /**
+         * Records that the given section ran from start until now.
+         */
+        static void record(int section, int64_t start);
+
+        /**
+         * Finishes the current frame, adding the time spent in each section
+         * during the frame to its history.
+         */
+        static void endFrame();
+
+        /**
+         * Returns the statistics of the given section over the recent
+         * frames. Sections that didn't run in a frame count as 0 ms.
+         */
+        static Stats getStats(int section);
+
+        /**
+         * Writes the recorded events of the recent frames to the given file,
+         * in the Chrome trace event format.
+         *
+         * @return <code>true</code> on success
+         */
+        static bool exportTrace(const std::string &fileName);
+
+    private:
+        struct Section
+        {
+            std::string name;
+            int64_t frameTotal;             /**< Time spent this frame. */
+            std::vector<int> history;       /**< Per frame, in microseconds. */
+        };
+
+        struct Event
+        {
+            int section;
+            int64_t start;
+            int duration;
+        };
+
+        static std::vector<Section> mSections;
+        static std::deque<Event> mEvents;
+        static std::deque<int> mFrameEventCounts;
+        static int mCurrentFrameEvents;
+        static int mHistoryPos;
+        static int mHistorySize;
+        static int mUsers;
+        static bool mEnabled;
+};
+
+/**
+ * Measures the time until it goes out of scope. Use it like:
+ *
+ * <pre>
+ *     static const int section = Profiler::section("Map::draw");
+ *     ProfileScope scope(section);
+ * </pre>
+ */
+class ProfileScope
+{
+    public:
+        explicit ProfileScope(int section):
+            mSection(section),
+            mStart(Profiler::isEnabled() ? Profiler::now() : -1)
+        {}
+
+        ~ProfileScope()
+        {
+            if (mStart >= 0)
+                Profiler::record(mSection, mStart);
+        }
+
+    private:
+        int mSection;
+        int64_t mStart;
+};
+
+#endif // PROFILER_H
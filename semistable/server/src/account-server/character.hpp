@@ -163,10 +163,12 @@ class Character
         int getSpecialSize() const
         { return mSpecials.size(); }
 
-        const std::map<int, Special*>::const_iterator getSpecialBegin() const
+        typedef std::map<int, Special*> Specials;
+
+        const Specials::const_iterator getSpecialBegin() const
         { return mSpecials.begin(); }
 
-        const std::map<int, Special*>::const_iterator getSpecialEnd() const
+        const Specials::const_iterator getSpecialEnd() const
         { return mSpecials.end(); }
 
         void clearSpecials()
@@ -233,7 +235,7 @@ class Character
         std::map<int, int> mExperience; //!< Skill Experience.
         std::map<int, int> mStatusEffects; //!< Status Effects
         std::map<int, int> mKillCount; //!< Kill Count
-        std::map<int, Special*>  mSpecials;
+        Specials mSpecials;
         unsigned short mMapId;    //!< Map the being is on.
         unsigned char mGender;    //!< Gender of the being.
         unsigned char mHairStyle; //!< Hair style of the being.
@@ -27,6 +27,7 @@
 #include "account-server/storage.hpp"
 #include "chat-server/chatchannelmanager.hpp"
 #include "chat-server/chathandler.hpp"
+#include "chat-server/chatjournal.hpp"
 #include "chat-server/guildmanager.hpp"
 #include "chat-server/post.hpp"
 #include "common/configuration.hpp"
@@ -52,6 +53,7 @@ using utils::Logger;
 // Default options that automake should be able to override.
 #define DEFAULT_LOG_FILE        "manaserv-account.log"
 #define DEFAULT_STATS_FILE      "manaserv.stats"
+#define DEFAULT_CHAT_JOURNAL    "manaserv-chat"
 #define DEFAULT_CONFIG_FILE     "manaserv.xml"
 
 static bool running = true;        /**< Determines if server keeps running */
@@ -65,6 +67,7 @@ Storage *storage;
 ChatHandler *chatHandler;
 
 ChatChannelManager *chatChannelManager;
+ChatJournal *chatJournal;
 GuildManager *guildManager;
 PostManager *postalManager;
 BandwidthMonitor *gBandwidth;
@@ -142,6 +145,22 @@ static void initialize()
 
 #endif // defined LOG_FILE
 
+    // The chat journal path
+#if defined CHAT_JOURNAL
+    std::string journalPath = CHAT_JOURNAL;
+#else
+
+#if (defined __USE_UNIX98 || defined __FreeBSD__)
+    std::string journalPath = getenv("HOME");
+    journalPath += "/.";
+    journalPath += DEFAULT_CHAT_JOURNAL;
+#else // Win32, ...
+    std::string journalPath = DEFAULT_CHAT_JOURNAL;
+#endif
+
+#endif // defined CHAT_JOURNAL
+    journalPath = Configuration::getValue("chat_journalPath", journalPath);
+
     // Initialize PhysicsFS
     PHYSFS_init("");
 
@@ -154,6 +173,26 @@ static void initialize()
 
     LOG_INFO("Using log file: " << logPath);
 
+    const std::string binaryLogPath =
+        Configuration::getValue("log_accountBinaryFile", std::string());
+    if (!binaryLogPath.empty())
+    {
+        Logger::setBinaryFile(binaryLogPath);
+        LOG_INFO("Using binary log file: " << binaryLogPath);
+    }
+
+    // Write the messages from a background thread, so that logging doesn't
+    // hold up the server
+    if (Configuration::getValue("log_async", 1))
+    {
+        const Logger::OverflowPolicy policy =
+            Configuration::getValue("log_asyncOverflow", "drop") == "block" ?
+            Logger::Block : Logger::Drop;
+        if (!Logger::startAsync(Configuration::getValue("log_asyncBufferSize",
+                                                        4096), policy))
+            LOG_WARN("Unable to start the log writer thread");
+    }
+
     ResourceManager::initialize();
 
     // Open database
@@ -168,6 +207,14 @@ static void initialize()
     // --- Initialize the managers
     stringFilter = new StringFilter;  // The slang's and double quotes filter.
     chatChannelManager = new ChatChannelManager;
+    chatJournal = new ChatJournal(journalPath);
+    if (Configuration::getValue("chat_journal", 1))
+    {
+        if (chatJournal->start())
+            LOG_INFO("Using chat journal: " << journalPath);
+        else
+            LOG_WARN("Unable to start the chat journal in " << journalPath);
+    }
     guildManager = new GuildManager;
     postalManager = new PostManager;
     gBandwidth = new BandwidthMonitor;
@@ -211,6 +258,7 @@ static void deinitialize()
     // Destroy Managers
     delete stringFilter;
     delete chatChannelManager;
+    delete chatJournal;
     delete guildManager;
     delete postalManager;
     delete gBandwidth;
@@ -243,6 +291,11 @@ static void dumpStatistics()
     std::ofstream os(path.c_str());
     os << "<statistics>\n";
     GameServerHandler::dumpStatistics(os);
+    chatChannelManager->dumpStatistics(os);
+    chatJournal->dumpStatistics(os);
+    gBandwidth->dumpStatistics(os);
+    os << "<logger nb_dropped=\"" << utils::Logger::getDroppedCount()
+       << "\"/>\n";
     os << "</statistics>\n";
 }
 
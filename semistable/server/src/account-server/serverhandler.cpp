@@ -19,6 +19,7 @@
  */
 
 #include <cassert>
+#include <ctime>
 #include <sstream>
 #include <list>
 
@@ -28,6 +29,7 @@
 #include "account-server/accounthandler.hpp"
 #include "account-server/character.hpp"
 #include "account-server/storage.hpp"
+#include "chat-server/chatjournal.hpp"
 #include "chat-server/post.hpp"
 #include "common/transaction.hpp"
 #include "common/configuration.hpp"
@@ -61,7 +63,24 @@ struct GameServer: NetComputer
     short port;
 };
 
+/**
+ * A request for the chat journal, waiting for the journal thread to look up
+ * the messages.
+ */
+struct JournalRequest
+{
+    GameServer *server;
+    int requesterId;        /**< Character the response goes to. */
+    std::string name;
+    int minutes;
+};
+
+typedef std::map< int, JournalRequest > JournalRequests;
+static JournalRequests journalRequests;   /**< By lookup id. */
+static int nextJournalLookup = 0;
+
 static GameServer *getGameServerFromMap(int);
+static void sendChatJournals();
 
 /**
  * Manages communications with all the game servers.
@@ -107,6 +126,7 @@ void GameServerHandler::deinitialize()
 void GameServerHandler::process()
 {
     serverHandler->process(50);
+    sendChatJournals();
 }
 
 NetComputer *ServerHandler::computerConnected(ENetPeer *peer)
@@ -116,6 +136,16 @@ NetComputer *ServerHandler::computerConnected(ENetPeer *peer)
 
 void ServerHandler::computerDisconnected(NetComputer *comp)
 {
+    // Drop the chat journal requests of the server
+    JournalRequests::iterator it = journalRequests.begin();
+    while (it != journalRequests.end())
+    {
+        if (it->second.server == comp)
+            journalRequests.erase(it++);
+        else
+            ++it;
+    }
+
     delete comp;
 }
 
@@ -157,6 +187,120 @@ static void registerGameClient(GameServer *s, const std::string &token,
     s->send(msg);
 }
 
+/** Number of messages sent back at most when the chat journal is read. */
+static const unsigned int MAX_JOURNAL_LINES = 30;
+
+/**
+ * Writes the messages a character sent in the last minutes as lines of text,
+ * the most recent ones last.
+ */
+static void writeChatJournal(MessageOut &msg, const std::string &name,
+                             int minutes,
+                             const std::vector<ChatJournal::Entry> &entries)
+{
+    std::ostringstream header;
+    header << name << " sent " << entries.size()
+           << " messages in the last " << minutes << " minutes";
+    if (entries.size() > MAX_JOURNAL_LINES)
+        header << ", showing the last " << MAX_JOURNAL_LINES;
+    header << '.';
+    msg.writeString(header.str());
+
+    const size_t first = entries.size() > MAX_JOURNAL_LINES ?
+                         entries.size() - MAX_JOURNAL_LINES : 0;
+    for (size_t i = first; i < entries.size(); ++i)
+    {
+        const ChatJournal::Entry &entry = entries[i];
+
+        char time[32];
+        strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S",
+                 gmtime(&entry.time));
+
+        std::string line = time;
+        switch (entry.type)
+        {
+            case ChatJournal::CHANNEL:
+                line += " in " + entry.target + ": ";
+                break;
+            case ChatJournal::PRIVATE:
+                line += " to " + entry.target + ": ";
+                break;
+            default:
+                line += " announced: ";
+        }
+        msg.writeString(line + entry.text);
+    }
+}
+
+/**
+ * Asks the journal thread for the messages a character sent in the last
+ * minutes. The response is sent by sendChatJournals() once they are found,
+ * so that reading the journal doesn't hold up the server.
+ *
+ * @return whether the lookup was queued
+ */
+static bool requestChatJournal(GameServer *server, int requesterId,
+                               const std::string &name, int minutes,
+                               MessageOut &error)
+{
+    Character *c = storage->getCharacter(name);
+    if (!c)
+    {
+        error.writeString("Unknown character " + name + ".");
+        return false;
+    }
+
+    const time_t now = time(NULL);
+    ChatJournal::Lookup lookup;
+    lookup.id = nextJournalLookup++;
+    lookup.characterId = c->getDatabaseID();
+    lookup.from = now - minutes * 60;
+    lookup.to = now;
+    delete c;
+
+    if (!chatJournal->requestLookup(lookup))
+    {
+        error.writeString("The chat journal is not running.");
+        return false;
+    }
+
+    JournalRequest &request = journalRequests[lookup.id];
+    request.server = server;
+    request.requesterId = requesterId;
+    request.name = name;
+    request.minutes = minutes;
+    return true;
+}
+
+/**
+ * Sends the results of the chat journal lookups that were finished.
+ */
+static void sendChatJournals()
+{
+    if (journalRequests.empty())
+        return;
+
+    std::vector<ChatJournal::Lookup> lookups;
+    chatJournal->takeFinishedLookups(lookups);
+
+    for (std::vector<ChatJournal::Lookup>::const_iterator i = lookups.begin(),
+         i_end = lookups.end(); i != i_end; ++i)
+    {
+        // The game server may have disconnected in the meantime
+        JournalRequests::iterator it = journalRequests.find(i->id);
+        if (it == journalRequests.end())
+            continue;
+
+        const JournalRequest &request = it->second;
+        MessageOut msg(AGMSG_CHAT_JOURNAL_RESPONSE);
+        msg.writeLong(request.requesterId);
+        writeChatJournal(msg, request.name, request.minutes, i->entries);
+        request.server->send(msg);
+
+        journalRequests.erase(it);
+    }
+}
+
 void GameServerHandler::registerClient(const std::string &token,
                                        Character *ptr)
 {
@@ -323,6 +467,19 @@ void ServerHandler::processMessage(NetComputer *comp, MessageIn &msg)
             result.writeString(value);
         } break;
 
+        case GAMSG_GET_CHAT_JOURNAL:
+        {
+            int id = msg.readLong();
+            std::string name = msg.readString();
+            int minutes = msg.readLong();
+
+            // Errors are answered right away, messages once they are found
+            MessageOut error(AGMSG_CHAT_JOURNAL_RESPONSE);
+            error.writeLong(id);
+            if (!requestChatJournal(server, id, name, minutes, error))
+                server->send(error);
+        } break;
+
         case GAMSG_SET_QUEST:
         {
             int id = msg.readLong();
@@ -33,7 +33,10 @@ ChatChannel::ChatChannel(int id,
     mName(name),
     mAnnouncement(announcement),
     mPassword(password),
-    mJoinable(joinable)
+    mJoinable(joinable),
+    mMessageCount(0),
+    mDeliveryCount(0),
+    mByteCount(0)
 {
 }
 
@@ -122,3 +125,10 @@ std::string ChatChannel::getUserMode(ChatClient *user) const
 
     return 0;
 }
+
+void ChatChannel::countMessage(unsigned int length)
+{
+    ++mMessageCount;
+    mDeliveryCount += mRegisteredUsers.size();
+    mByteCount += (unsigned long) length * mRegisteredUsers.size();
+}
@@ -138,6 +138,31 @@ class ChatChannel
          */
         std::string getUserMode(ChatClient *) const;
 
+        /**
+         * Records a message sent to all users of the channel.
+         *
+         * @param length the length of the message in bytes
+         */
+        void countMessage(unsigned int length);
+
+        /**
+         * Get the number of messages sent in the channel.
+         */
+        unsigned int getMessageCount() const
+        { return mMessageCount; }
+
+        /**
+         * Get the number of times a message was sent to a user.
+         */
+        unsigned int getDeliveryCount() const
+        { return mDeliveryCount; }
+
+        /**
+         * Get the number of bytes sent to the users of the channel.
+         */
+        unsigned long getByteCount() const
+        { return mByteCount; }
+
     private:
         unsigned short mId;            /**< The ID of the channel. */
         std::string mName;             /**< The name of the channel. */
@@ -146,6 +171,9 @@ class ChatChannel
         bool mJoinable;                /**< Whether anyone can join. */
         ChannelUsers mRegisteredUsers; /**< Users in this channel. */
         std::string mOwner;             /**< Channel owner character name */
+        unsigned int mMessageCount;    /**< Messages sent in the channel. */
+        unsigned int mDeliveryCount;   /**< Messages sent to single users. */
+        unsigned long mByteCount;      /**< Bytes sent to all users. */
 };
 
 #endif
@@ -19,6 +19,7 @@
  */
 
 #include <list>
+#include <ostream>
 
 #include "chat-server/chatchannelmanager.hpp"
 
@@ -206,3 +207,40 @@ int ChatChannelManager::nextUsable()
 
     return channelId;
 }
+
+/**
+ * Escapes the characters of a channel name that can't appear in an XML
+ * attribute.
+ */
+static std::string escapeAttribute(const std::string &value)
+{
+    std::string result;
+    for (std::string::const_iterator i = value.begin(), i_end = value.end();
+         i != i_end; ++i)
+    {
+        switch (*i)
+        {
+            case '&': result += "&amp;"; break;
+            case '<': result += "&lt;"; break;
+            case '>': result += "&gt;"; break;
+            case '"': result += "&quot;"; break;
+            default: result += *i;
+        }
+    }
+    return result;
+}
+
+void ChatChannelManager::dumpStatistics(std::ostream &os) const
+{
+    for (ChatChannels::const_iterator i = mChatChannels.begin(),
+         i_end = mChatChannels.end(); i != i_end; ++i)
+    {
+        const ChatChannel &channel = i->second;
+        os << "<chatchannel id=\"" << channel.getId()
+           << "\" name=\"" << escapeAttribute(channel.getName())
+           << "\" nb_users=\"" << channel.getUserList().size()
+           << "\" nb_messages=\"" << channel.getMessageCount()
+           << "\" nb_deliveries=\"" << channel.getDeliveryCount()
+           << "\" nb_bytes=\"" << channel.getByteCount() << "\"/>\n";
+    }
+}
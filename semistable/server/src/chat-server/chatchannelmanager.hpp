@@ -24,6 +24,7 @@
 #include <list>
 #include <map>
 #include <deque>
+#include <iosfwd>
 
 #include "chat-server/chatchannel.hpp"
 
@@ -114,6 +115,11 @@ class ChatChannelManager
          */
         int nextUsable();
 
+        /**
+         * Dumps the traffic of each channel into given stream
+         */
+        void dumpStatistics(std::ostream &) const;
+
     private:
         typedef std::map<unsigned short, ChatChannel> ChatChannels;
 
@@ -30,6 +30,7 @@
 #include "chat-server/chatchannelmanager.hpp"
 #include "chat-server/chatclient.hpp"
 #include "chat-server/chathandler.hpp"
+#include "chat-server/chatjournal.hpp"
 #include "common/transaction.hpp"
 #include "net/connectionhandler.hpp"
 #include "net/messagein.hpp"
@@ -97,6 +98,7 @@ void ChatHandler::tokenMatched(ChatClient *client, Pending *p)
 
         // Add chat client to player map
         mPlayerMap.insert(std::pair<std::string, ChatClient*>(client->characterName, client));
+        mPlayerIdMap.insert(std::make_pair(client->characterId, client));
     }
 
     client->send(msg);
@@ -129,6 +131,11 @@ void ChatHandler::computerDisconnected(NetComputer *comp)
         // need to do this after removing them from party
         // as that uses the player map
         mPlayerMap.erase(computer->characterName);
+
+        std::map<unsigned int, ChatClient*>::iterator itr =
+                mPlayerIdMap.find(computer->characterId);
+        if (itr != mPlayerIdMap.end() && itr->second == computer)
+            mPlayerIdMap.erase(itr);
     }
 
     delete computer;
@@ -296,6 +303,9 @@ void ChatHandler::handleChatMessage(ChatClient &client, MessageIn &msg)
         result.writeString(client.characterName);
         result.writeString(text);
         sendInChannel(channel, result);
+
+        chatJournal->record(ChatJournal::CHANNEL, client.characterId,
+                            client.characterName, channel->getName(), text);
     }
 
     // log transaction
@@ -327,6 +337,9 @@ void ChatHandler::handleAnnounceMessage(ChatClient &client, MessageIn &msg)
         // an announcement.
         sendToEveryone(result);
 
+        chatJournal->record(ChatJournal::ANNOUNCEMENT, client.characterId,
+                            client.characterName, std::string(), text);
+
         // log transaction
         Transaction trans;
         trans.mCharacterId = client.characterId;
@@ -359,6 +372,9 @@ void ChatHandler::handlePrivMsgMessage(ChatClient &client, MessageIn &msg)
     // We seek the player to whom the message is told and send it to her/him.
     sayToPlayer(client, user, text);
 
+    chatJournal->record(ChatJournal::PRIVATE, client.characterId,
+                        client.characterName, user, text);
+
     // log transaction
     Transaction trans;
     trans.mCharacterId = client.characterId;
@@ -698,12 +714,22 @@ void ChatHandler::warnUsersAboutPlayerEventInChat(ChatChannel *channel,
 void ChatHandler::sendInChannel(ChatChannel *channel, MessageOut &msg)
 {
     const ChatChannel::ChannelUsers &users = channel->getUserList();
+    if (users.empty())
+        return;
+
+    // All users get the same packet
+    ENetPacket *packet = NetComputer::createPacket(msg);
+    if (!packet)
+        return;
 
     for (ChatChannel::ChannelUsers::const_iterator
          i = users.begin(), i_end = users.end(); i != i_end; ++i)
     {
-        (*i)->send(msg);
+        (*i)->send(msg, packet);
     }
+
+    NetComputer::releasePacket(packet);
+    channel->countMessage(msg.getLength());
 }
 
 ChatClient *ChatHandler::getClient(const std::string &name) const
@@ -716,3 +742,14 @@ ChatClient *ChatHandler::getClient(const std::string &name) const
     else
         return 0;
 }
+
+ChatClient *ChatHandler::getClientById(unsigned int characterId) const
+{
+    std::map<unsigned int, ChatClient*>::const_iterator itr
+            = mPlayerIdMap.find(characterId);
+
+    if (itr != mPlayerIdMap.end())
+        return itr->second;
+    else
+        return 0;
+}
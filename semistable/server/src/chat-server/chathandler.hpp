@@ -59,6 +59,7 @@ class ChatHandler : public ConnectionHandler
         };
 
         std::map<std::string, ChatClient*> mPlayerMap;
+        std::map<unsigned int, ChatClient*> mPlayerIdMap;
         std::vector<PartyInvite> mPartyInvitedUsers;
 
     public:
@@ -320,6 +321,13 @@ class ChatHandler : public ConnectionHandler
          */
         ChatClient *getClient(const std::string &name) const;
 
+        /**
+         * Returns ChatClient of an online character
+         * @param The database id of the character
+         * @return The Chat Client, or NULL when the character is offline
+         */
+        ChatClient *getClientById(unsigned int characterId) const;
+
         /**
          * Set the topic of a guild channel
          */
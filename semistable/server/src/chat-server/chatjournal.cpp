@@ -0,0 +1,415 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "chat-server/chatjournal.hpp"
+
+/** Time between two writes of the journal, in milliseconds. */
+static const unsigned int FLUSH_INTERVAL = 5000;
+
+/** Number of waiting messages that makes the journal write early. */
+static const unsigned int FLUSH_THRESHOLD = 1000;
+
+/** Number of waiting messages above which new ones are dropped. */
+static const unsigned int MAX_PENDING = 100000;
+
+/** Length of the time range covered by a segment, in seconds. */
+static const time_t SEGMENT_LENGTH = 3600;
+
+/**
+ * First and last time a character spoke in a segment.
+ */
+struct IndexEntry
+{
+    time_t first;
+    time_t last;
+    int count;
+};
+
+/**
+ * Escapes the characters that separate the fields and lines of a segment.
+ */
+static void appendEscaped(std::string &line, const std::string &field)
+{
+    for (std::string::const_iterator i = field.begin(), i_end = field.end();
+         i != i_end; ++i)
+    {
+        switch (*i)
+        {
+            case '\\': line += "\\\\"; break;
+            case '\t': line += "\\t"; break;
+            case '\n': line += "\\n"; break;
+            case '\r': line += "\\r"; break;
+            default: line += *i;
+        }
+    }
+}
+
+static std::string unescape(const std::string &field)
+{
+    std::string result;
+    for (std::string::size_type i = 0; i < field.size(); ++i)
+    {
+        if (field[i] != '\\' || i + 1 == field.size())
+        {
+            result += field[i];
+            continue;
+        }
+
+        switch (field[++i])
+        {
+            case 't': result += '\t'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            default: result += field[i];
+        }
+    }
+    return result;
+}
+
+/**
+ * Parses a line of a segment.
+ *
+ * @return whether the line was valid
+ */
+static bool parseEntry(const std::string &line, ChatJournal::Entry &entry)
+{
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    for (;;)
+    {
+        std::string::size_type end = line.find('\t', start);
+        if (end == std::string::npos)
+        {
+            fields.push_back(line.substr(start));
+            break;
+        }
+        fields.push_back(line.substr(start, end - start));
+        start = end + 1;
+    }
+
+    if (fields.size() != 6 || fields[2].size() != 1)
+        return false;
+
+    entry.time = (time_t) strtol(fields[0].c_str(), NULL, 10);
+    entry.characterId = atoi(fields[1].c_str());
+    entry.type = fields[2][0];
+    entry.sender = unescape(fields[3]);
+    entry.target = unescape(fields[4]);
+    entry.text = unescape(fields[5]);
+    return true;
+}
+
+ChatJournal::ChatJournal(const std::string &directory):
+    mDirectory(directory),
+    mStopping(false),
+    mWritten(0),
+    mDropped(0),
+    mFailed(0)
+{
+}
+
+ChatJournal::~ChatJournal()
+{
+    stop();
+}
+
+bool ChatJournal::start()
+{
+#ifdef _WIN32
+    _mkdir(mDirectory.c_str());
+#else
+    mkdir(mDirectory.c_str(), 0755);
+#endif
+
+    struct stat info;
+    if (stat(mDirectory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR))
+        return false;
+
+    mStopping = false;
+    return utils::Thread::start();
+}
+
+void ChatJournal::stop()
+{
+    if (!isRunning())
+        return;
+
+    mMutex.lock();
+    mStopping = true;
+    mCondition.signal();
+    mMutex.unlock();
+
+    join();
+}
+
+void ChatJournal::record(Type type, int characterId,
+                         const std::string &sender,
+                         const std::string &target,
+                         const std::string &text)
+{
+    if (!isRunning())
+        return;
+
+    utils::MutexLock lock(mMutex);
+
+    if (mPending.size() >= MAX_PENDING)
+    {
+        ++mDropped;
+        return;
+    }
+
+    mPending.push_back(Entry());
+    Entry &entry = mPending.back();
+    entry.time = time(NULL);
+    entry.characterId = characterId;
+    entry.type = type;
+    entry.sender = sender;
+    entry.target = target;
+    entry.text = text;
+
+    if (mPending.size() == FLUSH_THRESHOLD)
+        mCondition.signal();
+}
+
+bool ChatJournal::requestLookup(const Lookup &lookup)
+{
+    if (!isRunning())
+        return false;
+
+    utils::MutexLock lock(mMutex);
+    mLookups.push_back(lookup);
+    mCondition.signal();
+    return true;
+}
+
+void ChatJournal::takeFinishedLookups(std::vector<Lookup> &lookups)
+{
+    utils::MutexLock lock(mMutex);
+    lookups.insert(lookups.end(),
+                   mFinishedLookups.begin(), mFinishedLookups.end());
+    mFinishedLookups.clear();
+}
+
+void ChatJournal::run()
+{
+    std::vector<Entry> entries;
+    std::vector<Lookup> lookups;
+
+    mMutex.lock();
+    for (;;)
+    {
+        if (!mStopping && mPending.size() < FLUSH_THRESHOLD &&
+            mLookups.empty())
+            mCondition.wait(mMutex, FLUSH_INTERVAL);
+
+        // Take the waiting messages and lookups, so that the chat can go on
+        // while they are handled
+        entries.clear();
+        entries.swap(mPending);
+        lookups.clear();
+        lookups.swap(mLookups);
+        const bool stopping = mStopping;
+
+        mMutex.unlock();
+        const bool written = write(entries);
+
+        // Looked up after writing, so that the latest messages are found
+        for (std::vector<Lookup>::iterator i = lookups.begin(),
+             i_end = lookups.end(); i != i_end; ++i)
+        {
+            find(i->characterId, i->from, i->to, i->entries);
+        }
+        mMutex.lock();
+
+        if (written)
+            mWritten += entries.size();
+        else
+            mFailed += entries.size();
+
+        mFinishedLookups.insert(mFinishedLookups.end(),
+                                lookups.begin(), lookups.end());
+
+        if (stopping)
+            break;
+    }
+    mMutex.unlock();
+}
+
+std::string ChatJournal::getSegmentPath(time_t hour) const
+{
+    struct tm date;
+#ifdef _WIN32
+    date = *gmtime(&hour);
+#else
+    gmtime_r(&hour, &date);
+#endif
+
+    char name[32];
+    strftime(name, sizeof(name), "%Y%m%d-%H", &date);
+    return mDirectory + "/" + name;
+}
+
+bool ChatJournal::write(const std::vector<Entry> &entries) const
+{
+    bool success = true;
+
+    std::vector<Entry>::const_iterator i = entries.begin();
+    while (i != entries.end())
+    {
+        // Write the messages of the same hour together
+        const time_t hour = i->time - i->time % SEGMENT_LENGTH;
+        const std::string path = getSegmentPath(hour);
+
+        std::string lines;
+        std::map<int, IndexEntry> index;
+
+        for (; i != entries.end() &&
+               i->time - i->time % SEGMENT_LENGTH == hour; ++i)
+        {
+            std::ostringstream prefix;
+            prefix << i->time << '\t' << i->characterId << '\t'
+                   << i->type << '\t';
+            lines += prefix.str();
+            appendEscaped(lines, i->sender);
+            lines += '\t';
+            appendEscaped(lines, i->target);
+            lines += '\t';
+            appendEscaped(lines, i->text);
+            lines += '\n';
+
+            std::map<int, IndexEntry>::iterator it = index.find(i->characterId);
+            if (it == index.end())
+            {
+                IndexEntry indexEntry = { i->time, i->time, 1 };
+                index[i->characterId] = indexEntry;
+            }
+            else
+            {
+                it->second.last = i->time;
+                ++it->second.count;
+            }
+        }
+
+        // gzip files may consist of several members, so appending a member
+        // for each write keeps the segment readable as a whole
+        gzFile segment = gzopen((path + ".log.gz").c_str(), "ab");
+        if (!segment)
+        {
+            success = false;
+            continue;
+        }
+        const int length = lines.size();
+        if (gzwrite(segment, lines.data(), length) != length)
+            success = false;
+        gzclose(segment);
+
+        FILE *indexFile = fopen((path + ".idx").c_str(), "a");
+        if (!indexFile)
+        {
+            success = false;
+            continue;
+        }
+        for (std::map<int, IndexEntry>::const_iterator it = index.begin(),
+             it_end = index.end(); it != it_end; ++it)
+        {
+            fprintf(indexFile, "%d %ld %ld %d\n", it->first,
+                    (long) it->second.first, (long) it->second.last,
+                    it->second.count);
+        }
+        fclose(indexFile);
+    }
+
+    return success;
+}
+
+void ChatJournal::find(int characterId, time_t from, time_t to,
+                       std::vector<Entry> &entries) const
+{
+    for (time_t hour = from - from % SEGMENT_LENGTH; hour <= to;
+         hour += SEGMENT_LENGTH)
+    {
+        const std::string path = getSegmentPath(hour);
+
+        // Check the index whether the character spoke in the range
+        FILE *indexFile = fopen((path + ".idx").c_str(), "r");
+        if (!indexFile)
+            continue;
+
+        bool found = false;
+        int id, count;
+        long first, last;
+        while (!found && fscanf(indexFile, "%d %ld %ld %d",
+                                &id, &first, &last, &count) == 4)
+        {
+            found = id == characterId && first <= to && last >= from;
+        }
+        fclose(indexFile);
+
+        if (!found)
+            continue;
+
+        gzFile segment = gzopen((path + ".log.gz").c_str(), "rb");
+        if (!segment)
+            continue;
+
+        std::string line;
+        char buffer[1024];
+        while (gzgets(segment, buffer, sizeof(buffer)))
+        {
+            line += buffer;
+            if (line.empty() || line[line.size() - 1] != '\n')
+                continue;
+
+            line.erase(line.size() - 1);
+
+            Entry entry;
+            if (parseEntry(line, entry) &&
+                entry.characterId == characterId &&
+                entry.time >= from && entry.time <= to)
+            {
+                entries.push_back(entry);
+            }
+            line.clear();
+        }
+        gzclose(segment);
+    }
+}
+
+void ChatJournal::dumpStatistics(std::ostream &os)
+{
+    utils::MutexLock lock(mMutex);
+    os << "<chatjournal nb_pending=\"" << mPending.size()
+       << "\" nb_written=\"" << mWritten
+       << "\" nb_dropped=\"" << mDropped
+       << "\" nb_failed=\"" << mFailed << "\"/>\n";
+}
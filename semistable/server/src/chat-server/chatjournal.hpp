@@ -0,0 +1,169 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHATJOURNAL_H
+#define CHATJOURNAL_H
+
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "utils/thread.hpp"
+
+/**
+ * An append-only journal of the chat, so that moderators can look back at
+ * what was said.
+ *
+ * Recording a message only copies it into a memory buffer. A background
+ * thread writes the buffer every few seconds, so the chat server never waits
+ * for the disk. When the disk can't keep up, the buffer stops growing at a
+ * fixed size and further messages are dropped and counted.
+ *
+ * The messages go to gzip compressed segments, one for each hour (UTC),
+ * named after that hour. Next to each segment, an index file lists which
+ * characters spoke in it and when, so looking up a character over a time
+ * range only opens the segments the character appears in. Lookups requested
+ * by the server are done by the same background thread.
+ */
+class ChatJournal : private utils::Thread
+{
+    public:
+        /**
+         * The kinds of messages in the journal.
+         */
+        enum Type
+        {
+            CHANNEL = 'C',
+            PRIVATE = 'P',
+            ANNOUNCEMENT = 'A'
+        };
+
+        struct Entry
+        {
+            time_t time;
+            int characterId;
+            char type;
+            std::string sender;
+            std::string target;  /**< Channel or character spoken to. */
+            std::string text;
+        };
+
+        /**
+         * A lookup of the messages a character sent in a time range.
+         */
+        struct Lookup
+        {
+            int id;                 /**< Chosen by the requester. */
+            int characterId;
+            time_t from;
+            time_t to;
+            std::vector<Entry> entries;  /**< The result. */
+        };
+
+        /**
+         * Constructor.
+         *
+         * @param directory the directory the segments are written to
+         */
+        ChatJournal(const std::string &directory);
+
+        /**
+         * Destructor. Writes the remaining messages.
+         */
+        ~ChatJournal();
+
+        /**
+         * Creates the directory and starts the thread writing the journal.
+         *
+         * @return whether the journal could be started
+         */
+        bool start();
+
+        /**
+         * Writes the remaining messages and stops the thread.
+         */
+        void stop();
+
+        /**
+         * Adds a message to the journal. Does nothing when the journal isn't
+         * started.
+         */
+        void record(Type type, int characterId, const std::string &sender,
+                    const std::string &target, const std::string &text);
+
+        /**
+         * Looks up the messages a character sent in a time range. Reads the
+         * segments on the calling thread.
+         */
+        void find(int characterId, time_t from, time_t to,
+                  std::vector<Entry> &entries) const;
+
+        /**
+         * Queues a lookup for the journal thread. The messages written so far
+         * are included in the result.
+         *
+         * @return whether the lookup was queued, which fails when the journal
+         *         isn't started
+         */
+        bool requestLookup(const Lookup &lookup);
+
+        /**
+         * Moves the lookups that were finished since the last call to the
+         * given vector.
+         */
+        void takeFinishedLookups(std::vector<Lookup> &lookups);
+
+        /**
+         * Dumps the number of written and dropped messages into given stream
+         */
+        void dumpStatistics(std::ostream &);
+
+    private:
+        void run();
+
+        /**
+         * Writes messages to their segments and updates the indexes.
+         *
+         * @return whether all messages could be written
+         */
+        bool write(const std::vector<Entry> &entries) const;
+
+        /**
+         * Returns the path of a segment or its index, without extension.
+         */
+        std::string getSegmentPath(time_t hour) const;
+
+        std::string mDirectory;
+
+        utils::Mutex mMutex;          /**< Guards the members below. */
+        utils::Condition mCondition;  /**< Wakes the writing thread. */
+        std::vector<Entry> mPending;  /**< Messages not written yet. */
+        std::vector<Lookup> mLookups; /**< Lookups not started yet. */
+        std::vector<Lookup> mFinishedLookups;
+        bool mStopping;
+        unsigned long mWritten;       /**< Messages written. */
+        unsigned long mDropped;       /**< Messages lost to a full buffer. */
+        unsigned long mFailed;        /**< Messages that couldn't be written. */
+};
+
+extern ChatJournal *chatJournal;
+
+#endif // CHATJOURNAL_H
@@ -30,10 +30,18 @@ Guild::Guild(const std::string &name) :
 
 Guild::~Guild()
 {
+    for (std::list<GuildMember*>::iterator itr = mMembers.begin(),
+         itr_end = mMembers.end(); itr != itr_end; ++itr)
+    {
+        delete *itr;
+    }
 }
 
 void Guild::addMember(int playerId, int permissions)
 {
+    if (checkInGuild(playerId))
+        return;
+
     // create new guild member
     GuildMember *member = new GuildMember;
     member->mId = playerId;
@@ -41,6 +49,7 @@ void Guild::addMember(int playerId, int permissions)
 
     // add new guild member to guild
     mMembers.push_back(member);
+    mMemberIndex[playerId] = member;
 
     if (checkInvited(playerId))
     {
@@ -60,7 +69,11 @@ void Guild::removeMember(int playerId)
     }
     GuildMember *member = getMember(playerId);
     if (member)
+    {
         mMembers.remove(member);
+        mMemberIndex.erase(playerId);
+        delete member;
+    }
 }
 
 int Guild::getOwner() const
@@ -104,16 +117,9 @@ bool Guild::checkInGuild(int playerId) const
 
 GuildMember *Guild::getMember(int playerId) const
 {
-    std::list<GuildMember*>::const_iterator itr = mMembers.begin(),
-                                            itr_end = mMembers.end();
-    while (itr != itr_end)
-    {
-        if ((*itr)->mId == playerId)
-            return (*itr);
-        ++itr;
-    }
-
-    return 0;
+    std::map<int, GuildMember*>::const_iterator itr =
+            mMemberIndex.find(playerId);
+    return itr != mMemberIndex.end() ? itr->second : 0;
 }
 
 bool Guild::canInvite(int playerId) const
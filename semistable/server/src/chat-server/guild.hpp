@@ -23,6 +23,7 @@
 
 #include <string>
 #include <list>
+#include <map>
 
 /**
  * Guild members
@@ -104,7 +105,7 @@ class Guild
         /**
          * Returns a list of the members in this guild.
          */
-        std::list<GuildMember*> getMembers() const
+        const std::list<GuildMember*> &getMembers() const
         { return mMembers; }
 
         /**
@@ -143,6 +144,7 @@ class Guild
         short mId;
         std::string mName;
         std::list<GuildMember*> mMembers;
+        std::map<int, GuildMember*> mMemberIndex; /**< Members by id. */
         std::list<int> mInvited;
 };
 
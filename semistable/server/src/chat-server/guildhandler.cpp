@@ -114,17 +114,14 @@ void ChatHandler::sendGuildListUpdate(const std::string &guildName,
         msg.writeShort(guild->getId());
         msg.writeString(characterName);
         msg.writeByte(eventId);
-        std::map<std::string, ChatClient*>::const_iterator chr;
-        std::list<GuildMember*> members = guild->getMembers();
+        const std::list<GuildMember*> &members = guild->getMembers();
 
         for (std::list<GuildMember*>::const_iterator itr = members.begin();
              itr != members.end(); ++itr)
         {
-            Character *c = storage->getCharacter((*itr)->mId, NULL);
-            chr = mPlayerMap.find(c->getName());
-            if (chr != mPlayerMap.end())
+            if (ChatClient *client = getClientById((*itr)->mId))
             {
-                chr->second->send(msg);
+                client->send(msg);
             }
         }
     }
@@ -270,15 +267,14 @@ void ChatHandler::handleGuildRetrieveMembers(ChatClient &client,
         {
             reply.writeByte(ERRMSG_OK);
             reply.writeShort(guildId);
-            std::list<GuildMember*> memberList = guild->getMembers();
+            const std::list<GuildMember*> &memberList = guild->getMembers();
             std::list<GuildMember*>::const_iterator itr_end = memberList.end();
-            for (std::list<GuildMember*>::iterator itr = memberList.begin();
+            for (std::list<GuildMember*>::const_iterator itr = memberList.begin();
                  itr != itr_end; ++itr)
             {
                 Character *c = storage->getCharacter((*itr)->mId, NULL);
-                std::string memberName = c->getName();
-                reply.writeString(memberName);
-                reply.writeByte(mPlayerMap.find(memberName) != mPlayerMap.end());
+                reply.writeString(c->getName());
+                reply.writeByte(getClientById((*itr)->mId) != 0);
             }
         }
     }
@@ -26,22 +26,63 @@
 #include "chat-server/chatclient.hpp"
 #include "chat-server/chathandler.hpp"
 
+#include <algorithm>
+#include <list>
+
 GuildManager::GuildManager()
 {
     // Load stored guilds from db
-    mGuilds = storage->getGuildList();
+    std::list<Guild*> guilds = storage->getGuildList();
+    for (std::list<Guild*>::iterator itr = guilds.begin();
+            itr != guilds.end(); ++itr)
+    {
+        addToIndex(*itr);
+    }
 }
 
 GuildManager::~GuildManager()
 {
-    for (std::list<Guild*>::iterator itr = mGuilds.begin();
+    for (Guilds::iterator itr = mGuilds.begin();
             itr != mGuilds.end(); ++itr)
     {
-        delete *itr;
+        delete itr->second;
     }
     mGuilds.clear();
 }
 
+void GuildManager::addToIndex(Guild *guild)
+{
+    mGuilds[guild->getId()] = guild;
+    mGuildsByName[guild->getName()] = guild;
+
+    const std::list<GuildMember*> &members = guild->getMembers();
+    for (std::list<GuildMember*>::const_iterator itr = members.begin();
+            itr != members.end(); ++itr)
+    {
+        addPlayerGuild((*itr)->mId, guild);
+    }
+}
+
+void GuildManager::addPlayerGuild(int playerId, Guild *guild)
+{
+    std::vector<Guild*> &guilds = mPlayerGuilds[playerId];
+    if (std::find(guilds.begin(), guilds.end(), guild) == guilds.end())
+        guilds.push_back(guild);
+}
+
+void GuildManager::removePlayerGuild(int playerId, Guild *guild)
+{
+    PlayerGuilds::iterator itr = mPlayerGuilds.find(playerId);
+    if (itr == mPlayerGuilds.end())
+        return;
+
+    std::vector<Guild*> &guilds = itr->second;
+    guilds.erase(std::remove(guilds.begin(), guilds.end(), guild),
+                 guilds.end());
+    if (guilds.empty())
+        mPlayerGuilds.erase(itr);
+}
+
 Guild* GuildManager::createGuild(const std::string &name, int playerId)
 {
     Guild *guild = new Guild(name);
@@ -49,8 +90,9 @@ Guild* GuildManager::createGuild(const std::string &name, int playerId)
     storage->addGuild(guild);
 
     // Add guild, and add owner
-    mGuilds.push_back(guild);
-    mOwners.push_back(playerId);
+    mGuilds[guild->getId()] = guild;
+    mGuildsByName[name] = guild;
+    mOwners.insert(playerId);
 
     // put the owner in the guild
     addGuildMember(guild, playerId);
@@ -66,8 +108,17 @@ Guild* GuildManager::createGuild(const std::string &name, int playerId)
 void GuildManager::removeGuild(Guild *guild)
 {
     storage->removeGuild(guild);
-    mOwners.remove(guild->getOwner());
-    mGuilds.remove(guild);
+    mOwners.erase(guild->getOwner());
+
+    const std::list<GuildMember*> &members = guild->getMembers();
+    for (std::list<GuildMember*>::const_iterator itr = members.begin();
+            itr != members.end(); ++itr)
+    {
+        removePlayerGuild((*itr)->mId, guild);
+    }
+
+    mGuilds.erase(guild->getId());
+    mGuildsByName.erase(guild->getName());
     delete guild;
 }
 
@@ -75,6 +126,7 @@ void GuildManager::addGuildMember(Guild *guild, int playerId)
 {
     storage->addGuildMember(guild->getId(), playerId);
     guild->addMember(playerId);
+    addPlayerGuild(playerId, guild);
 }
 
 void GuildManager::removeGuildMember(Guild *guild, int playerId)
@@ -82,47 +134,26 @@ void GuildManager::removeGuildMember(Guild *guild, int playerId)
     // remove the user from the guild
     storage->removeGuildMember(guild->getId(), playerId);
     guild->removeMember(playerId);
+    removePlayerGuild(playerId, guild);
+
+    // remove the user from owners list
+    mOwners.erase(playerId);
 
     // if theres no more members left delete the guild
     if (guild->memberCount() == 0)
         removeGuild(guild);
-
-    // remove the user from owners list
-    std::list<int>::iterator itr = mOwners.begin();
-    std::list<int>::iterator itr_end = mOwners.end();
-    while (itr != itr_end)
-    {
-        if ((*itr) == playerId)
-            mOwners.remove(playerId);
-
-        ++itr;
-    }
 }
 
 Guild *GuildManager::findById(short id) const
 {
-    for (std::list<Guild*>::const_iterator itr = mGuilds.begin(),
-            itr_end = mGuilds.end();
-            itr != itr_end; ++itr)
-    {
-        Guild *guild = (*itr);
-        if (guild->getId() == id)
-            return guild;
-    }
-    return 0;
+    Guilds::const_iterator itr = mGuilds.find(id);
+    return itr != mGuilds.end() ? itr->second : 0;
 }
 
 Guild *GuildManager::findByName(const std::string &name) const
 {
-    for (std::list<Guild*>::const_iterator itr = mGuilds.begin(),
-            itr_end = mGuilds.end();
-            itr != itr_end; ++itr)
-    {
-        Guild *guild = (*itr);
-        if (guild->getName() == name)
-            return guild;
-    }
-    return 0;
+    GuildsByName::const_iterator itr = mGuildsByName.find(name);
+    return itr != mGuildsByName.end() ? itr->second : 0;
 }
 
 bool GuildManager::doesExist(const std::string &name) const
@@ -132,17 +163,10 @@ bool GuildManager::doesExist(const std::string &name) const
 
 std::vector<Guild*> GuildManager::getGuildsForPlayer(int playerId) const
 {
-    std::vector<Guild*> guildList;
-
-    for (std::list<Guild*>::const_iterator itr = mGuilds.begin();
-            itr != mGuilds.end(); ++itr)
-    {
-        if ((*itr)->checkInGuild(playerId))
-        {
-            guildList.push_back((*itr));
-        }
-    }
-    return guildList;
+    PlayerGuilds::const_iterator itr = mPlayerGuilds.find(playerId);
+    if (itr == mPlayerGuilds.end())
+        return std::vector<Guild*>();
+    return itr->second;
 }
 
 void GuildManager::disconnectPlayer(ChatClient *player)
@@ -178,17 +202,7 @@ int GuildManager::changeMemberLevel(ChatClient *player, Guild *guild,
 
 bool GuildManager::alreadyOwner(int playerId) const
 {
-    std::list<int>::const_iterator itr = mOwners.begin();
-    std::list<int>::const_iterator itr_end = mOwners.end();
-
-    while (itr != itr_end)
-    {
-        if ((*itr) == playerId)
-            return true;
-        ++itr;
-    }
-
-    return false;
+    return mOwners.find(playerId) != mOwners.end();
 }
 
 void GuildManager::setUserRights(Guild *guild, int playerId, int rights)
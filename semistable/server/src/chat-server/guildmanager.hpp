@@ -21,7 +21,8 @@
 #ifndef CHATSERVER_GUILDMANAGER_H
 #define CHATSERVER_GUILDMANAGER_H
 
-#include <list>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -58,18 +59,14 @@ class GuildManager
         void removeGuildMember(Guild *guild, int playerId);
 
         /**
-         * Returns the guild with the given id. O(n)
-         *
-         * @todo <b>b_lindeijer:</b> Since this method is used so often, its
-         *       efficiency should be improved, probably by storing the guilds
-         *       in a map<int,Guild*> instead of list<Guild*>.
+         * Returns the guild with the given id. O(log n)
          *
          * @return the guild with the given id, or NULL if it doesn't exist
          */
         Guild *findById(short id) const;
 
         /**
-         * Returns the guild with the given name. O(n)
+         * Returns the guild with the given name. O(log n)
          *
          * @return the guild with the given name, or NULL if it doesn't exist
          */
@@ -110,8 +107,29 @@ class GuildManager
         void setUserRights(Guild *guild, int playerId, int rights);
 
     private:
-        std::list<Guild*> mGuilds;
-        std::list<int> mOwners;
+        typedef std::map<int, Guild*> Guilds;
+        typedef std::map<std::string, Guild*> GuildsByName;
+        typedef std::map<int, std::vector<Guild*> > PlayerGuilds;
+
+        /**
+         * Adds a guild and its members to the indexes.
+         */
+        void addToIndex(Guild *guild);
+
+        /**
+         * Records that a player is in a guild.
+         */
+        void addPlayerGuild(int playerId, Guild *guild);
+
+        /**
+         * Records that a player is no longer in a guild.
+         */
+        void removePlayerGuild(int playerId, Guild *guild);
+
+        Guilds mGuilds;                 /**< Guilds by id. */
+        GuildsByName mGuildsByName;     /**< Guilds by name. */
+        PlayerGuilds mPlayerGuilds;     /**< Guilds of each player. */
+        std::set<int> mOwners;
 };
 
 extern GuildManager *guildManager;
@@ -20,7 +20,7 @@
 
 #include "party.hpp"
 
-#include <algorithm>
+#include "chatclient.hpp"
 
 Party::Party()
 {
@@ -29,18 +29,15 @@ Party::Party()
     mId = id;
 }
 
-void Party::addUser(const std::string &name)
+void Party::addUser(ChatClient *client)
 {
-    if (std::find(mUsers.begin(), mUsers.end(), name) == mUsers.end())
-    {
-        mUsers.push_back(name);
-    }
+    mUsers.insert(std::make_pair(client->characterId, client));
 }
 
-void Party::removeUser(const std::string &name)
+void Party::removeUser(ChatClient *client)
 {
-    PartyUsers::iterator itr = std::find(mUsers.begin(), mUsers.end(), name);
-    if (itr != mUsers.end())
+    PartyUsers::iterator itr = mUsers.find(client->characterId);
+    if (itr != mUsers.end() && itr->second == client)
     {
         mUsers.erase(itr);
     }
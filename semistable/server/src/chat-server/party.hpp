@@ -21,8 +21,9 @@
 #ifndef PARTY_H
 #define PARTY_H
 
-#include <string>
-#include <vector>
+#include <map>
+
+class ChatClient;
 
 /**
  * A party that contains 1 or more characters to play together
@@ -30,7 +31,8 @@
 class Party
 {
 public:
-    typedef std::vector<std::string> PartyUsers;
+    /** The members of the party, by character id. */
+    typedef std::map<unsigned int, ChatClient*> PartyUsers;
 
     /** Constructor */
     Party();
@@ -38,12 +40,17 @@ public:
     /**
      * Add user to party
      */
-    void addUser(const std::string &name);
+    void addUser(ChatClient *client);
 
     /**
      * Remove user from party
      */
-    void removeUser(const std::string &name);
+    void removeUser(ChatClient *client);
+
+    /**
+     * Return the users in the party
+     */
+    const PartyUsers &getUsers() const { return mUsers; }
 
     /**
      * Return number of users in party
@@ -55,14 +55,14 @@ bool ChatHandler::handlePartyJoin(const std::string &invited, const std::string
         }
 
         // add inviter to the party
-        c1->party->addUser(inviter);
+        c1->party->addUser(c1);
 
         // Get invited client
         ChatClient *c2 = getClient(invited);
         if (c2)
         {
             // add invited to the party
-            c1->party->addUser(invited);
+            c1->party->addUser(c2);
             c2->party = c1->party;
             // was successful so return success to inviter
             out.writeString(invited);
@@ -215,47 +215,44 @@ void ChatHandler::removeUserFromParty(ChatClient &client)
 {
     if (client.party)
     {
-        client.party->removeUser(client.characterName);
+        // inform the members, including the one leaving
         informPartyMemberQuit(client);
+        client.party->removeUser(&client);
 
         // if theres less than 1 member left, remove the party
         if (client.party->userCount() < 1)
         {
             delete client.party;
-            client.party = 0;
         }
+        client.party = 0;
     }
 }
 
 void ChatHandler::informPartyMemberQuit(ChatClient &client)
 {
-    std::map<std::string, ChatClient*>::iterator itr;
-    std::map<std::string, ChatClient*>::const_iterator itr_end = mPlayerMap.end();
+    const Party::PartyUsers &users = client.party->getUsers();
 
-    for (itr = mPlayerMap.begin(); itr != itr_end; ++itr)
+    MessageOut out(CPMSG_PARTY_MEMBER_LEFT);
+    out.writeShort(client.characterId);
+
+    for (Party::PartyUsers::const_iterator itr = users.begin(),
+         itr_end = users.end(); itr != itr_end; ++itr)
     {
-        if (itr->second->party == client.party)
-        {
-            MessageOut out(CPMSG_PARTY_MEMBER_LEFT);
-            out.writeShort(client.characterId);
-            itr->second->send(out);
-        }
+        itr->second->send(out);
     }
 }
 
 void ChatHandler::informPartyMemberJoined(ChatClient &client)
 {
-    std::map<std::string, ChatClient*>::iterator itr;
-    std::map<std::string, ChatClient*>::const_iterator itr_end = mPlayerMap.end();
+    const Party::PartyUsers &users = client.party->getUsers();
 
-    for (itr = mPlayerMap.begin(); itr != itr_end; ++itr)
+    MessageOut out(CPMSG_PARTY_NEW_MEMBER);
+    out.writeShort(client.characterId);
+    out.writeString(client.characterName);
+
+    for (Party::PartyUsers::const_iterator itr = users.begin(),
+         itr_end = users.end(); itr != itr_end; ++itr)
     {
-        if (itr->second->party == client.party)
-        {
-            MessageOut out(CPMSG_PARTY_NEW_MEMBER);
-            out.writeShort(client.characterId);
-            out.writeString(client.characterName);
-            itr->second->send(out);
-        }
+        itr->second->send(out);
     }
 }
@@ -31,10 +31,13 @@
 static std::map< std::string, std::string > options;
 /**< Location of config file. */
 static std::string configPath;
+/**< Incremented each time the options are loaded. */
+static int generation = 0;
 
 void Configuration::initialize(const std::string &filename)
 {
     configPath = filename;
+    ++generation;
 
     xmlDocPtr doc = xmlReadFile(filename.c_str(), NULL, 0);
 
@@ -76,6 +79,11 @@ std::string Configuration::getValue(const std::string &key,
     return iter->second;
 }
 
+int Configuration::getGeneration()
+{
+    return generation;
+}
+
 int Configuration::getValue(const std::string &key, int deflt)
 {
     std::map<std::string, std::string>::iterator iter = options.find(key);
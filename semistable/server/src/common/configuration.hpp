@@ -46,8 +46,54 @@ namespace Configuration
      * @param deflt default value.
      */
     int getValue(const std::string &key, int deflt);
+
+    /**
+     * Returns a number that changes each time the configuration is loaded.
+     */
+    int getGeneration();
 }
 
+/**
+ * Handle to a configuration option, for code that reads the option often.
+ * The key is looked up and the value parsed on first use, and again only
+ * after the configuration was loaded anew.
+ *
+ * \param T The type of the option value: int or std::string
+ */
+template <class T>
+class ConfigOption
+{
+    public:
+        ConfigOption(const std::string &key, const T &deflt):
+            mKey(key),
+            mDefault(deflt),
+            mValue(deflt),
+            mGeneration(-1)
+        {}
+
+        const T &get() const
+        {
+            if (mGeneration != Configuration::getGeneration())
+            {
+                mValue = Configuration::getValue(mKey, mDefault);
+                mGeneration = Configuration::getGeneration();
+            }
+            return mValue;
+        }
+
+        operator const T &() const
+        { return get(); }
+
+    private:
+        const std::string mKey;
+        const T mDefault;
+        mutable T mValue;
+        mutable int mGeneration;
+};
+
+typedef ConfigOption<int> IntOption;
+typedef ConfigOption<std::string> StringOption;
+
 #ifndef DEFAULT_SERVER_PORT
 #define DEFAULT_SERVER_PORT 9601
 #endif
@@ -91,6 +91,7 @@ void AccountConnection::sendCharacterData(Character *p)
 {
     MessageOut msg(GAMSG_PLAYER_DATA);
     msg.writeLong(p->getDatabaseID());
+    p->updateStatusEffects();
     serializeCharacterData(*p, msg);
     send(msg);
 }
@@ -153,6 +154,14 @@ void AccountConnection::processMessage(MessageIn &msg)
             recoveredQuestVar(id, name, value);
         } break;
 
+        case AGMSG_CHAT_JOURNAL_RESPONSE:
+        {
+            int id = msg.readLong();
+            Character *ch = gameHandler->getCharacterByIdSlow(id);
+            while (ch && msg.getUnreadLength())
+                GameState::sayTo(ch, NULL, msg.readString());
+        } break;
+
         case CGMSG_CHANGED_PARTY:
         {
             // Character DB id
@@ -230,6 +239,17 @@ void AccountConnection::updateQuestVar(Character *ch, const std::string &name,
     send(msg);
 }
 
+void AccountConnection::requestChatJournal(Character *ch,
+                                           const std::string &name,
+                                           int minutes)
+{
+    MessageOut msg(GAMSG_GET_CHAT_JOURNAL);
+    msg.writeLong(ch->getDatabaseID());
+    msg.writeString(name);
+    msg.writeLong(minutes);
+    send(msg);
+}
+
 void AccountConnection::banCharacter(Character *ch, int duration)
 {
     MessageOut msg(GAMSG_BAN_PLAYER);
@@ -85,6 +85,13 @@ class AccountConnection : public Connection
         void updateQuestVar(Character *, const std::string &name,
                             const std::string &value);
 
+        /**
+         * Requests the messages a character sent in the chat in the last
+         * minutes, to be shown to the given character.
+         */
+        void requestChatJournal(Character *, const std::string &name,
+                                int minutes);
+
         /**
          * Sends ban message.
          */
@@ -18,29 +18,40 @@
  *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 
 #include "game-server/being.hpp"
 
 #include "defines.h"
 #include "common/configuration.hpp"
 #include "game-server/collisiondetection.hpp"
+#include "game-server/combatqueue.hpp"
 #include "game-server/eventlistener.hpp"
 #include "game-server/mapcomposite.hpp"
 #include "game-server/effect.hpp"
+#include "game-server/state.hpp"
 #include "game-server/statuseffect.hpp"
 #include "game-server/statusmanager.hpp"
 #include "utils/logger.h"
 
+static const int TIMER_UNSET = INT_MIN;
+
 Being::Being(ThingType type):
     Actor(type),
     mAction(STAND),
     mTarget(NULL),
     mSpeed(0),
-    mDirection(0)
+    mDirection(0),
+    mDamageTaken(0),
+    mNextModifierExpiry(INT_MAX)
 {
+    std::fill(mTimers, mTimers + NB_TIMERS, TIMER_UNSET);
+
     Attribute attr = { 0, 0 };
-    mAttributes.resize(NB_BEING_ATTRIBUTES + CHAR_ATTR_NB, attr);
+    std::fill(mAttributes, mAttributes + NB_BEING_ATTRIBUTES + CHAR_ATTR_NB,
+              attr);
     // Initialize element resistance to 100 (normal damage).
     for (int i = BASE_ELEM_BEGIN; i < BASE_ELEM_END; ++i)
     {
@@ -88,12 +99,13 @@ int Being::damage(Actor *, const Damage &damage)
 
     if (HPloss > 0)
     {
-        mHitsTaken.push_back(HPloss);
+        mDamageTaken += HPloss;
         Attribute &HP = mAttributes[BASE_ATTR_HP];
         LOG_DEBUG("Being " << getPublicID() << " suffered "<<HPloss<<" damage. HP: "<<HP.base + HP.mod<<"/"<<HP.base);
         HP.mod -= HPloss;
         updateDerivedAttributes(BASE_ATTR_HP);
-        setTimerSoft(T_B_HP_REGEN, Configuration::getValue("hpRegenBreakAfterHit", 0)); // no HP regen after being hit
+        static const IntOption hpRegenBreakAfterHit("hpRegenBreakAfterHit", 0);
+        setTimerSoft(T_B_HP_REGEN, hpRegenBreakAfterHit); // no HP regen after being hit
     } else {
         HPloss = 0;
     }
@@ -264,14 +276,14 @@ int Being::directionToAngle(int direction)
     }
 }
 
-int Being::performAttack(Being *target, unsigned range, const Damage &damage)
+bool Being::performAttack(Being *target, unsigned range, const Damage &damage)
 {
     // check target legality
     if (!target || target == this || target->getAction() == Being::DEAD || !target->canFight())
-            return -1;
+            return false;
     if (getMap()->getPvP() == PVP_NONE && target->getType() == OBJECT_CHARACTER &&
         getType() == OBJECT_CHARACTER)
-        return -1;
+        return false;
 
     // check if target is in range using the pythagorean theorem
     int distx = this->getPosition().x - target->getPosition().x;
@@ -279,11 +291,12 @@ int Being::performAttack(Being *target, unsigned range, const Damage &damage)
     int distSquare = (distx * distx + disty * disty);
     int maxDist = range + target->getSize();
     if (maxDist * maxDist < distSquare)
-        return -1;
+        return false;
 
     mActionTime += 1000; // set to 10 ticks wait time
 
-    return (mTarget->damage(this, damage));
+    getMap()->getCombatQueue()->add(this, target, damage);
+    return true;
 }
 
 void Being::setAction(Action action)
@@ -303,9 +316,10 @@ void Being::applyModifier(int attr, int amount, int duration, int lvl)
         AttributeModifier mod;
         mod.attr = attr;
         mod.value = amount;
-        mod.duration = duration;
+        mod.expires = GameState::getCurrentTick() + duration;
         mod.level = lvl;
         mModifiers.push_back(mod);
+        mNextModifierExpiry = std::min(mNextModifierExpiry, mod.expires);
     }
     mAttributes[attr].mod += amount;
     updateDerivedAttributes(attr);
@@ -327,12 +341,6 @@ void Being::dispellModifiers(int level)
     }
 }
 
-int Being::getModifiedAttribute(int attr) const
-{
-    int res = mAttributes[attr].base + mAttributes[attr].mod;
-    return res <= 0 ? 0 : res;
-}
-
 void Being::applyStatusEffect(int id, int timer)
 {
     if (mAction == DEAD)
@@ -383,12 +391,6 @@ void Being::setStatusEffectTime(int id, int time)
 
 void Being::update()
 {
-    //update timers
-    for (Timers::iterator i = mTimers.begin(); i != mTimers.end(); i++)
-    {
-        if (i->second > -1) i->second--;
-    }
-
     int oldHP = getModifiedAttribute(BASE_ATTR_HP);
     int newHP = oldHP;
     int maxHP = getAttribute(BASE_ATTR_HP);
@@ -411,19 +413,25 @@ void Being::update()
         raiseUpdateFlags(UPDATEFLAG_HEALTHCHANGE);
     }
 
-    // Update lifetime of effects.
-    AttributeModifiers::iterator i = mModifiers.begin();
-    while (i != mModifiers.end())
+    // Remove the effects that ran out. Nothing needs to be done before the
+    // first one does.
+    const int now = GameState::getCurrentTick();
+    if (now >= mNextModifierExpiry)
     {
-        --i->duration;
-        if (!i->duration)
+        mNextModifierExpiry = INT_MAX;
+        AttributeModifiers::iterator i = mModifiers.begin();
+        while (i != mModifiers.end())
         {
-            mAttributes[i->attr].mod -= i->value;
-            updateDerivedAttributes(i->attr);
-            i = mModifiers.erase(i);
-            continue;
+            if (i->expires <= now)
+            {
+                mAttributes[i->attr].mod -= i->value;
+                updateDerivedAttributes(i->attr);
+                i = mModifiers.erase(i);
+                continue;
+            }
+            mNextModifierExpiry = std::min(mNextModifierExpiry, i->expires);
+            ++i;
         }
-        ++i;
     }
 
     // Update and run status effects
@@ -453,26 +461,22 @@ void Being::update()
 
 void Being::setTimerSoft(TimerID id, int value)
 {
-    Timers::iterator i = mTimers.find(id);
-    if (i == mTimers.end())
-    {
-        mTimers[id] = value;
-    }
-    else if (i->second < value)
-    {
-        i->second = value;
-    }
+    if (getTimer(id) < value)
+        setTimerHard(id, value);
 }
 
 void Being::setTimerHard(TimerID id, int value)
 {
-    mTimers[id] = value;
+    mTimers[id] = GameState::getCurrentTick() + value;
 }
 
 int Being::getTimer(TimerID id) const
 {
-    Timers::const_iterator i = mTimers.find(id);
-    return (i == mTimers.end()) ? -1 : i->second;
+    if (mTimers[id] == TIMER_UNSET)
+        return -1;
+
+    // Timers stop at -1 once they finished
+    return std::max(mTimers[id] - GameState::getCurrentTick(), -1);
 }
 
 bool Being::isTimerRunning(TimerID id) const
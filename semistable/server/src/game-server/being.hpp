@@ -27,6 +27,8 @@
 #include <map>
 #include "limits.h"
 
+#include "defines.h"
+
 #include "game-server/actor.hpp"
 
 class Being;
@@ -51,7 +53,8 @@ enum TimerID
     T_M_KILLSTEAL_PROTECTED,  // killsteal protection time
     T_M_DECAY,  // time until dead monster is removed
     T_B_ATTACK_TIME,    // time until being can attack again
-    T_B_HP_REGEN    // time until hp is regenerated again
+    T_B_HP_REGEN,   // time until hp is regenerated again
+    NB_TIMERS
 };
 
 /**
@@ -91,8 +94,7 @@ struct Attribute
 
 struct AttributeModifier
 {
-    /**< Number of ticks (0 means permanent, e.g. equipment). */
-    unsigned short duration;
+    int expires;         /**< World tick at which the modifier ends. */
     short value;         /**< Positive or negative amount. */
     unsigned char attr;  /**< Attribute to modify. */
     /**
@@ -113,11 +115,6 @@ struct Status
 typedef std::map< int, Status > StatusEffects;
 typedef std::vector< AttributeModifier > AttributeModifiers;
 
-/**
- * Type definition for a list of hits
- */
-typedef std::vector<unsigned int> Hits;
-
 /**
  * Generic being (living actor). Keeps direction, destination and a few other
  * relevant properties. Used for characters & monsters (all animated objects).
@@ -166,10 +163,17 @@ class Being : public Actor
         /**
          * Takes a damage structure, computes the real damage based on the
          * stats, deducts the result from the hitpoints and adds the result to
-         * the HitsTaken list.
+         * the damage taken since the last update.
          */
         virtual int damage(Actor *source, const Damage &damage);
 
+        /**
+         * Called once an attack declared by performAttack() was resolved.
+         *
+         * @param hit the damage inflicted
+         */
+        virtual void attackResolved(Being *target, int hit) {}
+
         /** Restores all hit points of the being */
         void heal();
 
@@ -235,22 +239,24 @@ class Being : public Actor
         void setSpeed(float s);
 
         /**
-         * Gets the damage list.
+         * Gets the damage taken since the last update.
          */
-        const Hits &getHitsTaken() const
-        { return mHitsTaken; }
+        int getDamageTaken() const
+        { return mDamageTaken; }
 
         /**
-         * Clears the damage list.
+         * Clears the damage taken.
          */
-        void clearHitsTaken()
-        { mHitsTaken.clear(); }
+        void clearDamageTaken()
+        { mDamageTaken = 0; }
 
         /**
-         * Performs an attack.
-         * Return Value: damage inflicted or -1 when illegal target
+         * Performs an attack. The attack is added to the combat queue of the
+         * map, and attackResolved() is called once it hit.
+         *
+         * @return whether the target could be attacked
          */
-        int performAttack(Being *target, unsigned range, const Damage &damage);
+        bool performAttack(Being *target, unsigned range, const Damage &damage);
 
         /**
          * Sets the current action.
@@ -294,7 +300,11 @@ class Being : public Actor
         /**
          * Gets an attribute after applying modifiers.
          */
-        int getModifiedAttribute(int) const;
+        int getModifiedAttribute(int n) const
+        {
+            const int res = mAttributes[n].base + mAttributes[n].mod;
+            return res <= 0 ? 0 : res;
+        }
 
         /**
          * Adds a modifier to one attribute.
@@ -369,7 +379,11 @@ class Being : public Actor
     protected:
         static const int TICKS_PER_HP_REGENERATION = 100;
         Action mAction;
-        std::vector< Attribute > mAttributes;
+        /**
+         * Kept in the being itself, since the attributes are read all the
+         * time and base and modifier are always read together.
+         */
+        Attribute mAttributes[NB_BEING_ATTRIBUTES + CHAR_ATTR_NB];
         StatusEffects mStatus;
         Being *mTarget;
         Point mOld;                 /**< Old coordinates. */
@@ -402,11 +416,15 @@ class Being : public Actor
         unsigned char mDirection;   /**< Facing direction. */
 
         std::string mName;
-        Hits mHitsTaken; /**< List of punches taken since last update. */
-        AttributeModifiers mModifiers; /**< Currently modified attributes. */
+        int mDamageTaken; /**< Damage taken since last update. */
+        AttributeModifiers mModifiers; /**< Temporarily modified attributes. */
+        int mNextModifierExpiry;       /**< First tick a modifier expires. */
 
-        typedef std::map<TimerID, int> Timers;
-        Timers mTimers;
+        /**
+         * World tick at which each timer reaches 0, or TIMER_UNSET. Timers
+         * count down by themselves this way, without any work per tick.
+         */
+        int mTimers[NB_TIMERS];
 };
 
 #endif // BEING_H
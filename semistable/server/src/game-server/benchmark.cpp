@@ -0,0 +1,276 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "game-server/benchmark.hpp"
+
+#include "game-server/map.hpp"
+#include "game-server/mapcomposite.hpp"
+#include "game-server/mapmanager.hpp"
+#include "game-server/monster.hpp"
+#include "game-server/monstermanager.hpp"
+#include "game-server/state.hpp"
+#include "utils/logger.h"
+#include "utils/stringfilter.h"
+#include "utils/timer.h"
+
+/** Number of slangs in the string filter benchmark. */
+static const int SLANG_COUNT = 2000;
+
+/**
+ * Returns the value below which the given percentage of the sorted values
+ * lies.
+ */
+static int percentile(const std::vector<int> &sorted, int percent)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+/**
+ * Activates the first map that can be loaded.
+ */
+static MapComposite *activateMap()
+{
+    const MapManager::Maps &maps = MapManager::getMaps();
+    for (MapManager::Maps::const_iterator i = maps.begin(),
+         i_end = maps.end(); i != i_end; ++i)
+    {
+        if (MapManager::raiseActive(i->first))
+            return i->second;
+    }
+    return 0;
+}
+
+/**
+ * Spawns monsters of all classes in turn on random walkable tiles of the map.
+ *
+ * @return the number of monsters that were spawned
+ */
+static int spawnMonsters(MapComposite *map, int count)
+{
+    const std::vector<MonsterClass *> species = MonsterManager::getMonsters();
+    if (species.empty())
+        return 0;
+
+    const Map *realMap = map->getMap();
+    const int tileWidth = realMap->getTileWidth();
+    const int tileHeight = realMap->getTileHeight();
+
+    int spawned = 0;
+    for (int n = 0; n < count; ++n)
+    {
+        Monster *monster = new Monster(species[n % species.size()]);
+        if (monster->getModifiedAttribute(BASE_ATTR_HP) <= 0)
+        {
+            delete monster;
+            continue;
+        }
+
+        // Prefer walkable tiles, but don't search forever on closed maps
+        int x = 0, y = 0;
+        for (int attempt = 0; attempt < 100; ++attempt)
+        {
+            x = rand() % realMap->getWidth();
+            y = rand() % realMap->getHeight();
+            if (realMap->getWalk(x, y, monster->getWalkMask()))
+                break;
+        }
+
+        monster->setMap(map);
+        monster->setPosition(Point(x * tileWidth + tileWidth / 2,
+                                   y * tileHeight + tileHeight / 2));
+        monster->clearDestination();
+
+        if (GameState::insertSafe(monster))
+            ++spawned;
+    }
+    return spawned;
+}
+
+int Benchmark::run(int monsters, int ticks)
+{
+    MapComposite *map = activateMap();
+    if (!map)
+    {
+        LOG_FATAL("Benchmark: no map could be activated.");
+        return 1;
+    }
+
+    std::srand(1);
+    const int spawned = spawnMonsters(map, monsters);
+    LOG_INFO("Benchmark: running " << ticks << " world ticks with "
+             << spawned << " monsters on " << map->getName() << '.');
+
+    std::vector<int> tickTimes;
+    tickTimes.reserve(ticks);
+
+    const uint64_t startTime = utils::Timer::getTimeInMicrosec();
+    for (int tick = 1; tick <= ticks; ++tick)
+    {
+        const uint64_t tickStart = utils::Timer::getTimeInMicrosec();
+        GameState::update(tick);
+        tickTimes.push_back(
+                (int) (utils::Timer::getTimeInMicrosec() - tickStart));
+    }
+    const uint64_t totalTime = utils::Timer::getTimeInMicrosec() - startTime;
+
+    std::sort(tickTimes.begin(), tickTimes.end());
+
+    // The log may be quieter than this, so print the results as well
+    std::ostringstream results;
+    results << "Benchmark: " << spawned << " monsters, " << ticks
+            << " ticks, " << totalTime / 1000 << " ms in total" << std::endl
+            << "Tick time (us): median " << percentile(tickTimes, 50)
+            << ", p90 " << percentile(tickTimes, 90)
+            << ", p99 " << percentile(tickTimes, 99)
+            << ", max " << (tickTimes.empty() ? 0 : tickTimes.back());
+
+    std::cout << results.str() << std::endl;
+    LOG_INFO(results.str());
+    return 0;
+}
+
+/**
+ * Returns a random lower case word of the given length range.
+ */
+static std::string randomWord(int minLength, int maxLength)
+{
+    const int length = minLength + rand() % (maxLength - minLength + 1);
+    std::string word(length, ' ');
+    for (int i = 0; i < length; ++i)
+        word[i] = 'a' + rand() % 26;
+    return word;
+}
+
+/**
+ * Checks a text the way the slang filter used to, by searching the upper
+ * case text for each upper case slang in turn.
+ */
+static bool naiveFilter(const std::list<std::string> &upperCaseSlangs,
+                        const std::string &text)
+{
+    std::string upperCaseText = text;
+    std::transform(text.begin(), text.end(), upperCaseText.begin(),
+                   (int(*)(int)) std::toupper);
+
+    for (std::list<std::string>::const_iterator i = upperCaseSlangs.begin(),
+         i_end = upperCaseSlangs.end(); i != i_end; ++i)
+    {
+        if (upperCaseText.find(*i) != std::string::npos)
+            return false;
+    }
+    return true;
+}
+
+int Benchmark::runStringFilter(int messages)
+{
+    std::srand(1);
+
+    // Slangs are words of 4 to 10 letters, like a real list
+    std::list<std::string> slangs, upperCaseSlangs;
+    for (int i = 0; i < SLANG_COUNT; ++i)
+    {
+        const std::string slang = randomWord(4, 10);
+        slangs.push_back(slang);
+
+        std::string upperCaseSlang = slang;
+        std::transform(slang.begin(), slang.end(), upperCaseSlang.begin(),
+                       (int(*)(int)) std::toupper);
+        upperCaseSlangs.push_back(upperCaseSlang);
+    }
+
+    // Chat lines of up to a dozen words, some of them with a slang
+    std::vector<std::string> texts;
+    texts.reserve(messages);
+    for (int i = 0; i < messages; ++i)
+    {
+        std::string text;
+        const int words = 1 + rand() % 12;
+        for (int w = 0; w < words; ++w)
+        {
+            if (!text.empty())
+                text += ' ';
+            text += randomWord(1, 8);
+        }
+        if (rand() % 20 == 0)
+        {
+            std::list<std::string>::const_iterator slang = slangs.begin();
+            std::advance(slang, rand() % SLANG_COUNT);
+            text += ' ' + *slang;
+        }
+        texts.push_back(text);
+    }
+
+    const uint64_t compileStart = utils::Timer::getTimeInMicrosec();
+    utils::StringFilter filter;
+    filter.setSlangFilterList(slangs);
+    const uint64_t compileTime =
+            utils::Timer::getTimeInMicrosec() - compileStart;
+
+    int filtered = 0;
+    const uint64_t filterStart = utils::Timer::getTimeInMicrosec();
+    for (std::vector<std::string>::const_iterator i = texts.begin(),
+         i_end = texts.end(); i != i_end; ++i)
+    {
+        if (!filter.filterContent(*i))
+            ++filtered;
+    }
+    const uint64_t filterTime =
+            utils::Timer::getTimeInMicrosec() - filterStart;
+
+    int naiveFiltered = 0;
+    const uint64_t naiveStart = utils::Timer::getTimeInMicrosec();
+    for (std::vector<std::string>::const_iterator i = texts.begin(),
+         i_end = texts.end(); i != i_end; ++i)
+    {
+        if (!naiveFilter(upperCaseSlangs, *i))
+            ++naiveFiltered;
+    }
+    const uint64_t naiveTime =
+            utils::Timer::getTimeInMicrosec() - naiveStart;
+
+    std::ostringstream results;
+    results << "Benchmark: " << messages << " messages, " << SLANG_COUNT
+            << " slangs, compiled in " << compileTime << " us" << std::endl
+            << "Automaton: " << filterTime << " us, "
+            << filtered << " messages filtered" << std::endl
+            << "Search per slang: " << naiveTime << " us, "
+            << naiveFiltered << " messages filtered";
+
+    std::cout << results.str() << std::endl;
+    LOG_INFO(results.str());
+
+    if (filtered != naiveFiltered)
+    {
+        LOG_ERROR("Benchmark: the slang filter disagrees with the search.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+/**
+ * Measures how long world updates take with a crowded map, and how long
+ * the slang filter takes on chat messages, without an account server or
+ * clients.
+ */
+namespace Benchmark
+{
+    /**
+     * Activates the first map that can be loaded, spawns the given number of
+     * monsters on it and runs the given number of world updates as fast as
+     * possible. The monsters are seeded the same way on each run, so results
+     * can be compared between builds.
+     *
+     * @return the exit code for the server
+     */
+    int run(int monsters, int ticks);
+
+    /**
+     * Checks the given number of generated chat messages against a
+     * generated list of 2000 slangs, with the slang filter and with a
+     * search for each slang in turn, and prints how long both took.
+     *
+     * @return the exit code for the server
+     */
+    int runStringFilter(int messages);
+}
+
+#endif // BENCHMARK_HPP
@@ -54,8 +54,10 @@ Character::Character(MessageIn &msg):
     Being(OBJECT_CHARACTER),
     mClient(NULL),
     mTransactionHandler(NULL),
+    mRechargeNeeded(0),
     mRechargePerSpecial(0),
     mSpecialUpdateNeeded(false),
+    mDirtyDerivedAttributes(0),
     mDatabaseID(-1),
     mGender(0),
     mHairStyle(0),
@@ -67,15 +69,18 @@ Character::Character(MessageIn &msg):
     mParty(0),
     mTransaction(TRANS_NONE)
 {
-    Attribute attr = { 0, 0 };
-    mAttributes.resize(CHAR_ATTR_NB, attr);
     // Get character data.
     mDatabaseID = msg.readLong();
     setName(msg.readString());
     deserializeCharacterData(*this, msg);
+
+    // Compute all derived attributes once, then let the client know about
+    // the character attributes too.
+    mDirtyDerivedAttributes = (1 << BASE_ATTR_END) - 1;
+    recalculateDerivedAttributes();
     for (int i = CHAR_ATTR_BEGIN; i < CHAR_ATTR_END; ++i)
     {
-        updateDerivedAttributes(i);
+        flagAttribute(i);
     }
     setSize(16);
     Inventory(this).initialize();
@@ -98,23 +103,19 @@ void Character::update()
     }
 
     //update special recharge
-    std::list<Special *> rechargeNeeded;
-    int numRechargeNeeded = 0;
-    for (std::map<int, Special*>::iterator i = mSpecials.begin(); i != mSpecials.end(); i++)
+    if (mRechargeNeeded > 0)
     {
-        Special * s = i->second;
-        if (s->currentMana < s->neededMana)
+        mRechargePerSpecial = getModifiedAttribute(CHAR_ATTR_INTELLIGENCE) / mRechargeNeeded;
+        for (Specials::iterator i = mSpecials.begin(), i_end = mSpecials.end();
+             i != i_end; ++i)
         {
-            rechargeNeeded.push_back(s);
-            numRechargeNeeded++;
-        }
-    }
-    if (numRechargeNeeded > 0)
-    {
-        mRechargePerSpecial = getModifiedAttribute(CHAR_ATTR_INTELLIGENCE) / numRechargeNeeded;
-        for (std::list<Special*>::iterator i = rechargeNeeded.begin(); i != rechargeNeeded.end(); i++)
-        {
-            (*i)->currentMana += mRechargePerSpecial;
+            Special &s = i->second;
+            if (s.currentMana < s.neededMana)
+            {
+                s.currentMana += mRechargePerSpecial;
+                if (s.currentMana >= s.neededMana)
+                    --mRechargeNeeded;
+            }
         }
     }
 
@@ -124,13 +125,6 @@ void Character::update()
         mSpecialUpdateNeeded = false;
     }
 
-    mStatusEffects.clear();
-    StatusEffects::iterator it = mStatus.begin();
-    while (it != mStatus.end())
-    {
-        mStatusEffects[it->first] = it->second.time;
-        it++;
-    }
     Being::update();
 }
 
@@ -214,7 +208,7 @@ void Character::respawn()
 void Character::useSpecial(int id)
 {
     //check if the character may use this special in general
-    std::map<int, Special*>::iterator i = mSpecials.find(id);
+    Specials::iterator i = findSpecial(id);
     if (i == mSpecials.end())
     {
         LOG_INFO("Character uses special "<<id<<" without autorisation.");
@@ -222,7 +216,7 @@ void Character::useSpecial(int id)
     }
 
     //check if the special is currently recharged
-    Special *special = i->second;
+    Special *special = &i->second;
     if (special->currentMana < special->neededMana)
     {
         LOG_INFO("Character uses special "<<id<<" which is not recharged. ("
@@ -232,6 +226,8 @@ void Character::useSpecial(int id)
 
     //tell script engine to cast the spell
     special->currentMana = 0;
+    if (special->neededMana > 0)
+        ++mRechargeNeeded;
     Script::perform_special_action(id, this);
     mSpecialUpdateNeeded = true;
     return;
@@ -240,15 +236,15 @@ void Character::useSpecial(int id)
 void Character::sendSpecialUpdate()
 {
     //GPMSG_SPECIAL_STATUS           = 0x0293, // { B specialID, L current, L max, L recharge }
-    for (std::map<int, Special*>::iterator i = mSpecials.begin();
+    for (Specials::const_iterator i = mSpecials.begin();
          i != mSpecials.end();
          i++)
     {
 
         MessageOut msg(GPMSG_SPECIAL_STATUS );
         msg.writeByte(i->first);
-        msg.writeLong(i->second->currentMana);
-        msg.writeLong(i->second->neededMana);
+        msg.writeLong(i->second.currentMana);
+        msg.writeLong(i->second.neededMana);
         msg.writeLong(mRechargePerSpecial);
         /* yes, the last one is redundant because it is the same for each
            special, but I would like to keep the netcode flexible enough
@@ -386,63 +382,91 @@ int Character::getModifiedAttribute(int attr) const
     }
 }
 
+/**
+ * The derived attributes that depend on each character attribute, as a
+ * bitmask of base attributes.
+ */
+static const unsigned derivedAttributes[CHAR_ATTR_NB] =
+{
+    // CHAR_ATTR_STRENGTH
+    1 << BASE_ATTR_PHY_ATK_MIN,
+    // CHAR_ATTR_AGILITY
+    1 << BASE_ATTR_EVADE,
+    // CHAR_ATTR_DEXTERITY
+    1 << BASE_ATTR_HIT,
+    // CHAR_ATTR_VITALITY
+    1 << BASE_ATTR_HP | 1 << BASE_ATTR_HP_REGEN | 1 << BASE_ATTR_PHY_RES,
+    // CHAR_ATTR_INTELLIGENCE
+    0,
+    // CHAR_ATTR_WILLPOWER
+    1 << BASE_ATTR_MAG_RES | 1 << BASE_ATTR_MAG_ATK
+};
+
 void Character::updateDerivedAttributes(int attr)
 {
     if (attr >= CHAR_ATTR_BEGIN && attr < CHAR_ATTR_END)
     {
-        for (int i = BASE_ATTR_BEGIN; i < BASE_ATTR_END; ++i)
-        {
-            int newValue = getAttribute(i);
+        mDirtyDerivedAttributes |= derivedAttributes[attr - CHAR_ATTR_BEGIN];
+        recalculateDerivedAttributes();
+    }
+    flagAttribute(attr);
+}
 
-            if (i == BASE_ATTR_HP_REGEN){
-                newValue = (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
-                         * (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
-                         / (600 / TICKS_PER_HP_REGENERATION);
-                         // formula is in HP per minute. 600 game ticks = 1 minute.
-            }
-            else if (i == BASE_ATTR_HP){
-                newValue = (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
-                        * (mLevel + 10);
-            }
-            else if (i == BASE_ATTR_HIT) {
-                newValue = getModifiedAttribute(CHAR_ATTR_DEXTERITY)
-                        /* + skill in class of currently equipped weapon */;
-            }
-            else if (i == BASE_ATTR_EVADE) {
-                newValue = getModifiedAttribute(CHAR_ATTR_AGILITY);
-                        /* TODO: multiply with 10 / (10 * equip_weight)*/
-            }
-            else if (i == BASE_ATTR_PHY_RES) {
-                newValue = getModifiedAttribute(CHAR_ATTR_VITALITY);
-                        /* equip defence is through equip modifiers */
-            }
-            else if (i == BASE_ATTR_PHY_ATK_MIN) {
-                newValue = getModifiedAttribute(CHAR_ATTR_STRENGTH);
-                        /* weapon attack is applied through equip modifiers */
-            }
-            else if (i == BASE_ATTR_PHY_ATK_DELTA) {
-                newValue =  0;
-                        /* + skill in class of currently equipped weapon ( is
-                         * applied during the damage calculation)
-                         * weapon attack bonus is applied through equip
-                         * modifiers.
-                         */
-            }
-            else if (i == BASE_ATTR_MAG_RES) {
-                newValue = getModifiedAttribute(CHAR_ATTR_WILLPOWER);
-            }
-            else if (i == BASE_ATTR_MAG_ATK) {
-                newValue = getModifiedAttribute(CHAR_ATTR_WILLPOWER);
-            }
+void Character::recalculateDerivedAttributes()
+{
+    for (int i = BASE_ATTR_BEGIN; mDirtyDerivedAttributes; ++i)
+    {
+        if (!(mDirtyDerivedAttributes & (1 << i)))
+            continue;
 
-            if (newValue != getAttribute(i))
-            {
-                setAttribute(i, newValue);
-                flagAttribute(i);
-            }
+        mDirtyDerivedAttributes &= ~(1 << i);
+
+        int newValue = calculateDerivedAttribute(i);
+        if (newValue != getAttribute(i))
+        {
+            setAttribute(i, newValue);
+            flagAttribute(i);
         }
     }
-    flagAttribute(attr);
+}
+
+int Character::calculateDerivedAttribute(int attr) const
+{
+    switch (attr)
+    {
+        case BASE_ATTR_HP_REGEN:
+            // formula is in HP per minute. 600 game ticks = 1 minute.
+            return (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
+                 * (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
+                 / (600 / TICKS_PER_HP_REGENERATION);
+        case BASE_ATTR_HP:
+            return (getModifiedAttribute(CHAR_ATTR_VITALITY) + 10)
+                 * (mLevel + 10);
+        case BASE_ATTR_HIT:
+            return getModifiedAttribute(CHAR_ATTR_DEXTERITY)
+                 /* + skill in class of currently equipped weapon */;
+        case BASE_ATTR_EVADE:
+            return getModifiedAttribute(CHAR_ATTR_AGILITY);
+                 /* TODO: multiply with 10 / (10 * equip_weight)*/
+        case BASE_ATTR_PHY_RES:
+            return getModifiedAttribute(CHAR_ATTR_VITALITY);
+                 /* equip defence is through equip modifiers */
+        case BASE_ATTR_PHY_ATK_MIN:
+            return getModifiedAttribute(CHAR_ATTR_STRENGTH);
+                 /* weapon attack is applied through equip modifiers */
+        case BASE_ATTR_PHY_ATK_DELTA:
+            return 0;
+                 /* + skill in class of currently equipped weapon ( is
+                  * applied during the damage calculation)
+                  * weapon attack bonus is applied through equip
+                  * modifiers.
+                  */
+        case BASE_ATTR_MAG_RES:
+        case BASE_ATTR_MAG_ATK:
+            return getModifiedAttribute(CHAR_ATTR_WILLPOWER);
+        default:
+            return getAttribute(attr);
+    }
 }
 
 void Character::flagAttribute(int attr)
@@ -482,7 +506,8 @@ void Character::receiveExperience(int skill, int experience, int optimalLevel)
         if (newExp < 0) newExp = 0; // avoid integer underflow/negative exp
 
         // Check the skill cap
-        long int maxSkillCap = Configuration::getValue("maxSkillCap", INT_MAX);
+        static const IntOption maxSkillCapOption("maxSkillCap", INT_MAX);
+        long int maxSkillCap = maxSkillCapOption;
         assert(maxSkillCap <= INT_MAX);  // avoid interger overflow
         if (newExp > maxSkillCap)
         {
@@ -591,6 +616,10 @@ void Character::levelup()
 {
     mLevel++;
 
+    // The maximum hit points depend on the level
+    mDirtyDerivedAttributes |= 1 << BASE_ATTR_HP;
+    recalculateDerivedAttributes();
+
     mCharacterPoints += CHARPOINTS_PER_LEVELUP;
     mCorrectionPoints += CORRECTIONPOINTS_PER_LEVELUP;
     if (mCorrectionPoints > CORRECTIONPOINTS_MAX)
@@ -650,23 +679,49 @@ Character::~Character()
     }
 }
 
+/**
+ * Orders specials by id, and finds them by id.
+ */
+struct SpecialIdLess
+{
+    bool operator()(const Character::Specials::value_type &special,
+                    int id) const
+    { return special.first < id; }
+};
+
+Character::Specials::iterator Character::findSpecial(int id)
+{
+    Specials::iterator i = std::lower_bound(mSpecials.begin(),
+                                            mSpecials.end(),
+                                            id, SpecialIdLess());
+    if (i != mSpecials.end() && i->first != id)
+        return mSpecials.end();
+    return i;
+}
+
 void Character::giveSpecial(int id)
 {
-    if (mSpecials.find(id) == mSpecials.end())
+    Specials::iterator i = std::lower_bound(mSpecials.begin(),
+                                            mSpecials.end(),
+                                            id, SpecialIdLess());
+    if (i == mSpecials.end() || i->first != id)
     {
-        Special *s = new Special();
-        Script::addDataToSpecial(id, s);
-        mSpecials[id] = s;
+        i = mSpecials.insert(i, std::make_pair(id, Special()));
+        Special &s = i->second;
+        Script::addDataToSpecial(id, &s);
+        if (s.currentMana < s.neededMana)
+            ++mRechargeNeeded;
         mSpecialUpdateNeeded = true;
     }
 }
 
 void Character::takeSpecial(int id)
 {
-    std::map<int, Special*>::iterator i = mSpecials.find(id);
+    Specials::iterator i = findSpecial(id);
     if (i != mSpecials.end())
     {
-        delete i->second;
+        if (i->second.currentMana < i->second.neededMana)
+            --mRechargeNeeded;
         mSpecials.erase(i);
         mSpecialUpdateNeeded = true;
     }
@@ -674,9 +729,16 @@ void Character::takeSpecial(int id)
 
 void Character::clearSpecials()
 {
-    for(std::map<int, Special*>::iterator i = mSpecials.begin(); i != mSpecials.end(); i++)
+    mSpecials.clear();
+    mRechargeNeeded = 0;
+}
+
+void Character::updateStatusEffects()
+{
+    mStatusEffects.clear();
+    for (StatusEffects::const_iterator it = mStatus.begin(),
+         it_end = mStatus.end(); it != it_end; ++it)
     {
-        delete i->second;
+        mStatusEffects[it->first] = it->second.time;
     }
-    mSpecials.clear();
 }
@@ -53,6 +53,10 @@ struct Special
 class Character : public Being
 {
     public:
+        /**
+         * The specials known by the character, sorted by id.
+         */
+        typedef std::vector< std::pair<int, Special> > Specials;
 
         /**
          * Utility constructor for creating a Character from a received
@@ -101,7 +105,7 @@ class Character : public Being
         /**
          * Checks if a character knows a special action
          */
-        bool hasSpecial(int id) { return mSpecials.find(id) != mSpecials.end(); }
+        bool hasSpecial(int id) { return findSpecial(id) != mSpecials.end(); }
 
         /**
          * Removes an available special action
@@ -267,7 +271,8 @@ class Character : public Being
         int getModifiedAttribute(int) const;
 
         /**
-         * Updates base Being attributes.
+         * Updates the base Being attributes that depend on the given
+         * character attribute.
          */
         void updateDerivedAttributes(int);
 
@@ -297,6 +302,12 @@ class Character : public Being
         const std::map<int, int>::const_iterator getSkillEnd() const
         { return mExperience.end(); }
 
+        /**
+         * Copies the remaining time of the status effects, to be read by the
+         * functions below when the character is serialized.
+         */
+        void updateStatusEffects();
+
         /**
          * used to serialized status effects
          */
@@ -330,10 +341,10 @@ class Character : public Being
         int getSpecialSize() const
         { return mSpecials.size(); }
 
-        const std::map<int, Special*>::const_iterator getSpecialBegin() const
+        const Specials::const_iterator getSpecialBegin() const
         { return mSpecials.begin(); }
 
-        const std::map<int, Special*>::const_iterator getSpecialEnd() const
+        const Specials::const_iterator getSpecialEnd() const
         { return mSpecials.end(); }
 
         /**
@@ -426,6 +437,23 @@ class Character : public Being
          */
         void flagAttribute(int);
 
+        /**
+         * Returns the special with the given id, or the end of the specials
+         * when the character doesn't know it.
+         */
+        Specials::iterator findSpecial(int id);
+
+        /**
+         * Recomputes the derived attributes marked as dirty.
+         */
+        void recalculateDerivedAttributes();
+
+        /**
+         * Computes the value of a derived attribute from the character
+         * attributes.
+         */
+        int calculateDerivedAttribute(int) const;
+
         /**
          * Returns the exp needed for next skill levelup
          */
@@ -461,13 +489,17 @@ class Character : public Being
 
         std::map<int, int> mExperience; /**< experience collected for each skill.*/
 
-        std::map<int, Special*> mSpecials;
+        Specials mSpecials;
+        int mRechargeNeeded;         /**< Number of specials recharging. */
         std::map<int, int> mStatusEffects; /**< only used by select functions
                                                 to make it easier to make the accountserver
                                                 do not modify or use anywhere else*/
         int mRechargePerSpecial;
         bool mSpecialUpdateNeeded;
 
+        /** Bitmask of base attributes that need to be recomputed. */
+        unsigned mDirtyDerivedAttributes;
+
         int mDatabaseID;             /**< Character's database ID. */
         unsigned char mGender;       /**< Gender of the character. */
         unsigned char mHairStyle;    /**< Hair Style of the character. */
@@ -0,0 +1,77 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "game-server/combatqueue.hpp"
+
+void CombatQueue::add(Being *source, Being *target, const Damage &damage)
+{
+    mAttacks.push_back(Attack());
+    Attack &attack = mAttacks.back();
+    attack.source = source;
+    attack.target = target;
+    attack.damage = damage;
+    attack.targetId = target->getPublicID();
+    attack.order = mAttacks.size();
+}
+
+void CombatQueue::resolve()
+{
+    if (mAttacks.empty())
+        return;
+
+    mResolving.swap(mAttacks);
+    std::sort(mResolving.begin(), mResolving.end(), AttackLess());
+
+    // Indexes rather than iterators, since the scripts run by the attackers
+    // may declare new attacks or remove beings.
+    for (size_t i = 0; i < mResolving.size(); ++i)
+    {
+        Attack &attack = mResolving[i];
+        if (!attack.target)
+            continue;
+
+        const int hit = attack.target->damage(attack.source, attack.damage);
+
+        if (attack.source)
+            attack.source->attackResolved(attack.target, hit);
+    }
+
+    mResolving.clear();
+}
+
+void CombatQueue::remove(std::vector<Attack> &attacks, Being *being)
+{
+    for (std::vector<Attack>::iterator i = attacks.begin(),
+         i_end = attacks.end(); i != i_end; ++i)
+    {
+        if (i->target == being)
+            i->target = NULL;
+        if (i->source == being)
+            i->source = NULL;
+    }
+}
+
+void CombatQueue::remove(Being *being)
+{
+    remove(mAttacks, being);
+    remove(mResolving, being);
+}
@@ -0,0 +1,86 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMBATQUEUE_HPP
+#define COMBATQUEUE_HPP
+
+#include <vector>
+
+#include "game-server/being.hpp"
+
+/**
+ * The attacks declared on a map that are not resolved yet.
+ *
+ * Beings declare their attacks while performing their actions, and scripts
+ * declare the damage they deal. All of them are resolved together afterwards,
+ * sorted by target, so that the hits on a being are applied in one go and
+ * the clients get the damage a being took during a tick as a single record.
+ */
+class CombatQueue
+{
+    public:
+        /**
+         * Declares an attack.
+         *
+         * @param source the attacker, or NULL for damage dealt by a script
+         */
+        void add(Being *source, Being *target, const Damage &damage);
+
+        /**
+         * Resolves the attacks declared so far, in the order they were
+         * declared for each target, and tells the attackers how much damage
+         * they did. Attacks declared while resolving wait for the next call.
+         */
+        void resolve();
+
+        /**
+         * Forgets the attacks from and on a being leaving the map.
+         */
+        void remove(Being *being);
+
+        bool isEmpty() const
+        { return mAttacks.empty(); }
+
+    private:
+        struct Attack
+        {
+            Being *source;
+            Being *target;   /**< NULL once the target left the map. */
+            Damage damage;
+            int targetId;    /**< Public ID, to sort the same way each run. */
+            unsigned int order;
+        };
+
+        struct AttackLess
+        {
+            bool operator()(const Attack &a, const Attack &b) const
+            {
+                return a.targetId < b.targetId ||
+                       (a.targetId == b.targetId && a.order < b.order);
+            }
+        };
+
+        static void remove(std::vector<Attack> &attacks, Being *being);
+
+        std::vector<Attack> mAttacks;    /**< Attacks waiting. */
+        std::vector<Attack> mResolving;  /**< Attacks being resolved. */
+};
+
+#endif // COMBATQUEUE_HPP
@@ -28,6 +28,7 @@
 #include "game-server/item.hpp"
 #include "game-server/itemmanager.hpp"
 #include "game-server/mapmanager.hpp"
+#include "game-server/metrics.hpp"
 #include "game-server/monster.hpp"
 #include "game-server/monstermanager.hpp"
 #include "game-server/state.hpp"
@@ -63,6 +64,8 @@ static void handleGivePermission(Character*, std::string&);
 static void handleTakePermission(Character*, std::string&);
 static void handleAnnounce(Character*, std::string&);
 static void handleHistory(Character*, std::string&);
+static void handleMetrics(Character*, std::string&);
+static void handleJournal(Character*, std::string&);
 
 static CmdRef const cmdRef[] =
 {
@@ -102,6 +105,10 @@ static CmdRef const cmdRef[] =
         "Sends a chat message to all characters in the game", &handleAnnounce},
     {"history", "<number of transactions>",
         "Shows the last transactions", &handleHistory},
+    {"metrics", "[reset]",
+        "Shows how long the world ticks take on the server and on your map", &handleMetrics},
+    {"journal", "<character> [minutes]",
+        "Shows what a character said in the chat lately, 60 minutes by default", &handleJournal},
     {NULL, NULL, NULL, NULL}
 
 };
@@ -921,6 +928,58 @@ static void handleHistory(Character *player, std::string &args)
     // TODO: Get args number of transactions and show them to the player
 }
 
+static void handleMetrics(Character *player, std::string &args)
+{
+    if (getArgument(args) == "reset")
+    {
+        Metrics::reset();
+        say("Metrics reset.", player);
+        return;
+    }
+
+    std::vector<std::string> lines;
+    Metrics::summarize(player->getMapId(), lines);
+    for (std::vector<std::string>::const_iterator i = lines.begin(),
+         i_end = lines.end(); i != i_end; ++i)
+    {
+        say(*i, player);
+    }
+}
+
+static void handleJournal(Character *player, std::string &args)
+{
+    std::string character = getArgument(args);
+    std::string valuestr = getArgument(args);
+
+    if (character == "")
+    {
+        say("Invalid number of arguments given.", player);
+        say("Usage: @journal <character> [minutes]", player);
+        return;
+    }
+
+    int minutes = 60;
+    if (valuestr != "")
+    {
+        if (!utils::isNumeric(valuestr))
+        {
+            say("Invalid argument", player);
+            return;
+        }
+        minutes = utils::stringToInt(valuestr);
+    }
+
+    // The journal is read from disk, so don't look back further than a week
+    if (minutes <= 0 || minutes > 7 * 24 * 60)
+    {
+        say("Invalid number of minutes", player);
+        return;
+    }
+
+    // The character may be offline, so the account server looks it up
+    accountHandler->requestChatJournal(player, character, minutes);
+}
+
 
 void CommandHandler::handleCommand(Character *player,
                                    const std::string &command)
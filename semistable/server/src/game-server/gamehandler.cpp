@@ -710,6 +710,21 @@ GameClient *GameHandler::getClientByNameSlow(const std::string &name) const
     return 0;
 }
 
+Character *GameHandler::getCharacterByIdSlow(int id) const
+{
+    for (NetComputers::const_iterator i = clients.begin(),
+         i_end = clients.end(); i != i_end; ++i)
+    {
+        GameClient *c = static_cast< GameClient * >(*i);
+        Character *ch = c->character;
+        if (ch && c->status == CLIENT_CONNECTED && ch->getDatabaseID() == id)
+        {
+            return ch;
+        }
+    }
+    return 0;
+}
+
 void GameHandler::sendError(NetComputer *computer, int id, std::string errorMsg)
 {
     MessageOut msg(GPMSG_NPC_ERROR);
@@ -114,6 +114,13 @@ class GameHandler: public ConnectionHandler
          */
         GameClient *getClientByNameSlow(const std::string &) const;
 
+        /**
+         * Gets the connected character with the given database ID. This
+         * method is slow, so it should never be called for regular
+         * operations.
+         */
+        Character *getCharacterByIdSlow(int id) const;
+
     protected:
         NetComputer *computerConnected(ENetPeer *);
         void computerDisconnected(NetComputer *);
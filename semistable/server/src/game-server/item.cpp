@@ -138,7 +138,8 @@ bool ItemClass::use(Being *itemUser)
 Item::Item(ItemClass *type, int amount)
           : Actor(OBJECT_ITEM), mType(type), mAmount(amount)
 {
-    mLifetime = Configuration::getValue("floorItemDecayTime", 0) * 10;
+    static const IntOption floorItemDecayTime("floorItemDecayTime", 0);
+    mLifetime = floorItemDecayTime * 10;
 }
 
 void Item::update()
@@ -19,6 +19,7 @@
  */
 
 #include <cstdlib>
+#include <fstream>
 #include <getopt.h>
 #include <iostream>
 #include <signal.h>
@@ -39,10 +40,12 @@
 #include "common/permissionmanager.hpp"
 #include "common/resourcemanager.hpp"
 #include "game-server/accountconnection.hpp"
+#include "game-server/benchmark.hpp"
 #include "game-server/gamehandler.hpp"
 #include "game-server/skillmanager.hpp"
 #include "game-server/itemmanager.hpp"
 #include "game-server/mapmanager.hpp"
+#include "game-server/metrics.hpp"
 #include "game-server/monstermanager.hpp"
 #include "game-server/statusmanager.hpp"
 #include "game-server/postman.hpp"
@@ -61,6 +64,7 @@ using utils::Logger;
 
 // Default options that automake should be able to override.
 #define DEFAULT_LOG_FILE                    "manaserv-game.log"
+#define DEFAULT_METRICS_FILE                "manaserv-game.stats"
 #define DEFAULT_CONFIG_FILE                 "manaserv.xml"
 #define DEFAULT_ITEMSDB_FILE                "items.xml"
 #define DEFAULT_SKILLSDB_FILE               "mana-skills.xml"
@@ -125,11 +129,25 @@ void initConfig()
 
 }
 
+/**
+ * Logs how long a phase of the server startup took, and starts timing the
+ * next phase.
+ */
+static void logStartupPhase(const char *phase, uint64_t &phaseStart)
+{
+    const uint64_t now = utils::Timer::getTimeInMillisec();
+    LOG_INFO("Startup: " << phase << " took " << (now - phaseStart) << " ms");
+    phaseStart = now;
+}
+
 /**
  * Initializes the server.
  */
 void initialize()
 {
+    const uint64_t startTime = utils::Timer::getTimeInMillisec();
+    uint64_t phaseStart = startTime;
+
     // Reset to default segmentation fault handling for debugging purposes
     signal(SIGSEGV, SIG_DFL);
 
@@ -170,25 +188,53 @@ void initialize()
     Logger::setTeeMode(true);
     LOG_INFO("Using log file: " << logPath);
 
+    const std::string binaryLogPath =
+        Configuration::getValue("log_gameBinaryFile", std::string());
+    if (!binaryLogPath.empty())
+    {
+        Logger::setBinaryFile(binaryLogPath);
+        LOG_INFO("Using binary log file: " << binaryLogPath);
+    }
+
+    // Write the messages from a background thread, so that logging doesn't
+    // hold up the server
+    if (Configuration::getValue("log_async", 1))
+    {
+        const Logger::OverflowPolicy policy =
+            Configuration::getValue("log_asyncOverflow", "drop") == "block" ?
+            Logger::Block : Logger::Drop;
+        if (!Logger::startAsync(Configuration::getValue("log_asyncBufferSize",
+                                                        4096), policy))
+            LOG_WARN("Unable to start the log writer thread");
+    }
+
     // --- Initialize the managers
     // Initialize the slang's and double quotes filter.
     stringFilter = new StringFilter;
 
     ResourceManager::initialize();
+    logStartupPhase("resource manager", phaseStart);
     if (MapManager::initialize(DEFAULT_MAPSDB_FILE) < 1)
     {
         LOG_FATAL("The Game Server can't find any valid/available maps.");
         exit(2);
     }
+    logStartupPhase("map database", phaseStart);
     SkillManager::initialize(DEFAULT_SKILLSDB_FILE);
+    logStartupPhase("skill database", phaseStart);
     ItemManager::initialize(DEFAULT_ITEMSDB_FILE);
+    logStartupPhase("item database", phaseStart);
     MonsterManager::initialize(DEFAULT_MONSTERSDB_FILE);
+    logStartupPhase("monster database", phaseStart);
     StatusManager::initialize(DEFAULT_STATUSDB_FILE);
+    logStartupPhase("status effect database", phaseStart);
     PermissionManager::initialize(DEFAULT_PERMISSION_FILE);
+    logStartupPhase("permissions", phaseStart);
     // Initialize global event script
     LuaScript::load_global_event_script(DEFAULT_GLOBAL_EVENT_SCRIPT_FILE);
     // Initialize special action script
     LuaScript::load_special_actions_script(DEFAULT_SPECIAL_ACTIONS_SCRIPT_FILE);
+    logStartupPhase("global scripts", phaseStart);
 
     // --- Initialize the global handlers
     // FIXME: Make the global handlers global vars or part of a bigger
@@ -215,6 +261,9 @@ void initialize()
 
     // Seed the random number generator
     std::srand( time(NULL) );
+
+    LOG_INFO("Startup: initialization took "
+             << (utils::Timer::getTimeInMillisec() - startTime) << " ms");
 }
 
 
@@ -246,6 +295,29 @@ void deinitialize()
 }
 
 
+/**
+ * Dumps the tick timings and the traffic.
+ */
+static void dumpMetrics()
+{
+#if defined METRICS_FILE
+    std::string path = METRICS_FILE;
+#else
+
+#if (defined __USE_UNIX98 || defined __FreeBSD__)
+    std::string path = getenv("HOME");
+    path += "/.";
+    path += DEFAULT_METRICS_FILE;
+#else // Win32, ...
+    std::string path = DEFAULT_METRICS_FILE;
+#endif
+
+#endif
+
+    std::ofstream os(path.c_str());
+    Metrics::write(os);
+}
+
 /**
  * Show command line arguments
  */
@@ -261,6 +333,18 @@ void printHelp()
               << "                        - 3. Plus standard information." << std::endl
               << "                        - 4. Plus debugging information." << std::endl
               << "     --port <n>      : Set the default port to listen on."
+              << std::endl
+              << "     --benchmark-monsters <n> : Time world updates with this"
+              << std::endl
+              << "                        number of monsters, then quit."
+              << std::endl
+              << "     --benchmark-ticks <n>    : Number of world updates to"
+              << std::endl
+              << "                        time in the benchmark."
+              << std::endl
+              << "     --benchmark-filter <n>   : Time the slang filter on"
+              << std::endl
+              << "                        this number of messages, then quit."
               << std::endl;
     exit(0);
 }
@@ -269,11 +353,17 @@ struct CommandLineOptions
 {
     CommandLineOptions():
         verbosity(Logger::Warn),
-        port(DEFAULT_SERVER_PORT + 3)
+        port(DEFAULT_SERVER_PORT + 3),
+        benchmarkMonsters(0),
+        benchmarkTicks(1000),
+        benchmarkFilter(0)
     {}
 
     Logger::Level verbosity;
     int port;
+    int benchmarkMonsters;
+    int benchmarkTicks;
+    int benchmarkFilter;
 };
 
 /**
@@ -288,6 +378,9 @@ void parseOptions(int argc, char *argv[], CommandLineOptions &options)
         { "help",       no_argument, 0, 'h' },
         { "verbosity",  required_argument, 0, 'v' },
         { "port",       required_argument, 0, 'p' },
+        { "benchmark-monsters", required_argument, 0, 'b' },
+        { "benchmark-ticks",    required_argument, 0, 't' },
+        { "benchmark-filter",   required_argument, 0, 'f' },
         { 0 }
     };
 
@@ -311,6 +404,15 @@ void parseOptions(int argc, char *argv[], CommandLineOptions &options)
             case 'p':
                 options.port = atoi(optarg);
                 break;
+            case 'b':
+                options.benchmarkMonsters = atoi(optarg);
+                break;
+            case 't':
+                options.benchmarkTicks = atoi(optarg);
+                break;
+            case 'f':
+                options.benchmarkFilter = atoi(optarg);
+                break;
         }
     }
 }
@@ -341,6 +443,22 @@ int main(int argc, char *argv[])
     // General initialization
     initialize();
 
+    // The benchmark runs on its own, without the account server
+    if (options.benchmarkMonsters > 0)
+    {
+        const int result = Benchmark::run(options.benchmarkMonsters,
+                                          options.benchmarkTicks);
+        deinitialize();
+        return result;
+    }
+
+    if (options.benchmarkFilter > 0)
+    {
+        const int result = Benchmark::runStringFilter(options.benchmarkFilter);
+        deinitialize();
+        return result;
+    }
+
     // Make an initial attempt to connect to the account server
     // Try again after longer and longer intervals when connection fails.
     bool isConnected = false;
@@ -379,15 +497,17 @@ int main(int argc, char *argv[])
             {
                 LOG_WARN("Skipped "<< elapsedWorldTicks - 1
                         << " world tick due to insufficient CPU time.");
+                Metrics::addSkippedTicks(elapsedWorldTicks - 1);
                 elapsedWorldTicks = 1;
             }
             worldTime++;
             elapsedWorldTicks--;
+            GameState::setCurrentTick(worldTime);
 
             // Print world time at 10 second intervals to show we're alive
             if (worldTime % 100 == 0) {
                 LOG_INFO("World time: " << worldTime);
-
+                dumpMetrics();
             }
 
             if (accountHandler->isConnected())
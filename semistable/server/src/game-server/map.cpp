@@ -24,6 +24,7 @@
 #include <cstring>
 
 #include "game-server/map.hpp"
+#include "game-server/metrics.hpp"
 
 // Basic cost for moving from one tile to another.
 // Used in findPath() function when computing the A* path algorithm.
@@ -218,6 +219,8 @@ Path Map::findPath(int startX, int startY,
                                    int destX, int destY,
                                    unsigned char walkmask, int maxCost)
 {
+    Metrics::CallTimer timer(Metrics::CALL_PATHFINDING);
+
     // Path to be built up (empty by default)
     Path path;
 
@@ -0,0 +1,350 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game-server/mapcache.hpp"
+
+#include "common/configuration.hpp"
+#include "utils/logger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Snapshots are written in native byte order. Since the magic is written the
+ * same way, a snapshot from a machine with another byte order is rebuilt.
+ */
+static const int CACHE_MAGIC = 0x4D415053; // "MAPS"
+
+/**
+ * Increase this whenever the layout of the snapshots or the meaning of their
+ * contents changes.
+ */
+static const int CACHE_VERSION = 1;
+
+namespace
+{
+    class SnapshotWriter
+    {
+        public:
+            void writeInt(int value)
+            { mData.append((const char *) &value, sizeof(value)); }
+
+            void writeString(const std::string &value)
+            {
+                writeInt(value.size());
+                mData.append(value);
+            }
+
+            void writeProperties(const MapData::Properties &properties)
+            {
+                writeInt(properties.size());
+                for (MapData::Properties::const_iterator i =
+                     properties.begin(), i_end = properties.end();
+                     i != i_end; ++i)
+                {
+                    writeString(i->first);
+                    writeString(i->second);
+                }
+            }
+
+            void writeBytes(const std::vector<char> &bytes)
+            {
+                writeInt(bytes.size());
+                if (!bytes.empty())
+                    mData.append(&bytes[0], bytes.size());
+            }
+
+            const std::string &data() const
+            { return mData; }
+
+        private:
+            std::string mData;
+    };
+
+    /**
+     * Reads a snapshot, guarding against truncated or corrupt files. Once
+     * anything fails to read, all further reads return empty values.
+     */
+    class SnapshotReader
+    {
+        public:
+            SnapshotReader(const char *data, size_t size):
+                mPos(data), mEnd(data + size), mValid(true)
+            {}
+
+            bool isValid() const
+            { return mValid; }
+
+            int readInt()
+            {
+                int value = 0;
+                if (check(sizeof(value)))
+                {
+                    memcpy(&value, mPos, sizeof(value));
+                    mPos += sizeof(value);
+                }
+                return value;
+            }
+
+            std::string readString()
+            {
+                int length = readInt();
+                if (length < 0 || !check(length))
+                    return std::string();
+
+                std::string value(mPos, length);
+                mPos += length;
+                return value;
+            }
+
+            void readProperties(MapData::Properties &properties)
+            {
+                int count = readInt();
+                if (count < 0 || !check(count))
+                    return;
+
+                properties.resize(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    properties[i].first = readString();
+                    properties[i].second = readString();
+                }
+            }
+
+            void readBytes(std::vector<char> &bytes)
+            {
+                int count = readInt();
+                if (count < 0 || !check(count))
+                    return;
+
+                bytes.assign(mPos, mPos + count);
+                mPos += count;
+            }
+
+            /**
+             * Reads an element count, which is sane only when each element
+             * takes at least a byte.
+             */
+            int readCount()
+            {
+                int count = readInt();
+                if (count < 0 || !check(count))
+                    return 0;
+                return count;
+            }
+
+        private:
+            bool check(size_t size)
+            {
+                if (mValid && (size_t) (mEnd - mPos) >= size)
+                    return true;
+
+                mValid = false;
+                return false;
+            }
+
+            const char *mPos;
+            const char *mEnd;
+            bool mValid;
+    };
+}
+
+/**
+ * Returns the name of the snapshot of the given map file, or an empty string
+ * when snapshots are disabled.
+ */
+static std::string snapshotFile(const std::string &mapFile)
+{
+    if (!Configuration::getValue("mapCacheEnabled", 1))
+        return std::string();
+
+    std::string path = Configuration::getValue("mapCachePath", "mapcache");
+
+    std::string name = mapFile;
+    for (std::string::iterator i = name.begin(); i != name.end(); ++i)
+    {
+        if (*i == '/' || *i == '\\')
+            *i = '_';
+    }
+
+    return path + "/" + name + ".bin";
+}
+
+static bool readData(SnapshotReader &reader, unsigned long checksum,
+                     MapData &data)
+{
+    if (reader.readInt() != CACHE_MAGIC ||
+        reader.readInt() != CACHE_VERSION ||
+        (unsigned) reader.readInt() != (unsigned) checksum)
+    {
+        return false;
+    }
+
+    data.width = reader.readInt();
+    data.height = reader.readInt();
+    data.tileWidth = reader.readInt();
+    data.tileHeight = reader.readInt();
+    reader.readBytes(data.blocked);
+    reader.readProperties(data.properties);
+
+    data.objects.resize(reader.readCount());
+    for (std::vector<MapData::Object>::iterator i = data.objects.begin(),
+         i_end = data.objects.end(); i != i_end; ++i)
+    {
+        i->name = reader.readString();
+        i->type = reader.readString();
+        i->x = reader.readInt();
+        i->y = reader.readInt();
+        i->width = reader.readInt();
+        i->height = reader.readInt();
+        reader.readProperties(i->properties);
+    }
+
+    return reader.isValid() &&
+           data.blocked.size() == (size_t) (data.width * data.height);
+}
+
+bool MapCache::read(const std::string &mapFile, unsigned long checksum,
+                    MapData &data)
+{
+    const std::string fileName = snapshotFile(mapFile);
+    if (fileName.empty())
+        return false;
+
+    bool valid = false;
+
+#ifndef _WIN32
+    // Map the snapshot rather than reading it, only the parts used get loaded
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *mapped = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            SnapshotReader reader((const char *) mapped, info.st_size);
+            valid = readData(reader, checksum, data);
+            munmap(mapped, info.st_size);
+        }
+    }
+    close(fd);
+#else
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+        return false;
+
+    std::string buffer((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+    SnapshotReader reader(buffer.data(), buffer.size());
+    valid = readData(reader, checksum, data);
+#endif
+
+    if (!valid)
+        LOG_INFO("Map snapshot " << fileName << " is outdated.");
+
+    return valid;
+}
+
+void MapCache::write(const std::string &mapFile, unsigned long checksum,
+                     const MapData &data)
+{
+    const std::string fileName = snapshotFile(mapFile);
+    if (fileName.empty())
+        return;
+
+    SnapshotWriter writer;
+    writer.writeInt(CACHE_MAGIC);
+    writer.writeInt(CACHE_VERSION);
+    writer.writeInt(checksum);
+
+    writer.writeInt(data.width);
+    writer.writeInt(data.height);
+    writer.writeInt(data.tileWidth);
+    writer.writeInt(data.tileHeight);
+    writer.writeBytes(data.blocked);
+    writer.writeProperties(data.properties);
+
+    writer.writeInt(data.objects.size());
+    for (std::vector<MapData::Object>::const_iterator i = data.objects.begin(),
+         i_end = data.objects.end(); i != i_end; ++i)
+    {
+        writer.writeString(i->name);
+        writer.writeString(i->type);
+        writer.writeInt(i->x);
+        writer.writeInt(i->y);
+        writer.writeInt(i->width);
+        writer.writeInt(i->height);
+        writer.writeProperties(i->properties);
+    }
+
+    // The directory may exist already
+    const std::string path = fileName.substr(0, fileName.rfind('/'));
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+
+    // Write to a temporary file first, so that a crash while writing doesn't
+    // leave a broken snapshot behind
+    const std::string tempName = fileName + ".tmp";
+    std::ofstream file(tempName.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(writer.data().data(), writer.data().size());
+    file.close();
+
+    if (!file)
+    {
+        LOG_WARN("Could not write map snapshot " << tempName);
+        std::remove(tempName.c_str());
+        return;
+    }
+
+#ifdef _WIN32
+    // Renaming doesn't replace existing files on Windows
+    std::remove(fileName.c_str());
+#endif
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0)
+    {
+        LOG_WARN("Could not write map snapshot " << fileName);
+        std::remove(tempName.c_str());
+    }
+}
+
+unsigned long MapCache::checksum(const char *buffer, int size)
+{
+    unsigned long crc = crc32(0L, Z_NULL, 0);
+    return crc32(crc, (const Bytef *) buffer, size);
+}
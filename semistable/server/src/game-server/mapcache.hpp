@@ -0,0 +1,91 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPCACHE_HPP
+#define MAPCACHE_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * The parsed contents of a map file, as far as the game server uses them.
+ * Objects are kept in their raw form, since warps and spawn areas refer to
+ * other maps and monsters which are only known at runtime.
+ */
+struct MapData
+{
+    typedef std::vector< std::pair< std::string, std::string > > Properties;
+
+    struct Object
+    {
+        std::string name;
+        std::string type;       /**< Upper case. */
+        int x, y, width, height;
+        Properties properties;  /**< Names in upper case. */
+    };
+
+    int width;
+    int height;
+    int tileWidth;
+    int tileHeight;
+
+    /** Whether each tile is blocked by a collision layer, row by row. */
+    std::vector<char> blocked;
+
+    Properties properties;
+    std::vector<Object> objects;
+};
+
+/**
+ * Versioned binary snapshots of parsed maps, so that restarting the server
+ * doesn't need to inflate and parse every map again. A snapshot is only
+ * used when the checksum of the map file it was made from still matches.
+ *
+ * The snapshots are stored in the directory given by the
+ * <code>mapCachePath</code> option. Setting the <code>mapCacheEnabled</code>
+ * option to 0 disables them.
+ */
+namespace MapCache
+{
+    /**
+     * Reads the snapshot of a map.
+     *
+     * @param mapFile  the map file the snapshot was made from
+     * @param checksum the checksum of the current contents of the map file
+     * @param data     the map data to fill
+     * @return <code>true</code> when an up to date snapshot was read
+     */
+    bool read(const std::string &mapFile, unsigned long checksum,
+              MapData &data);
+
+    /**
+     * Writes a snapshot of a map.
+     */
+    void write(const std::string &mapFile, unsigned long checksum,
+               const MapData &data);
+
+    /**
+     * Returns the checksum of the given file contents.
+     */
+    unsigned long checksum(const char *buffer, int size);
+}
+
+#endif // MAPCACHE_HPP
@@ -26,6 +26,7 @@
 #include "game-server/map.hpp"
 #include "game-server/mapcomposite.hpp"
 #include "game-server/character.hpp"
+#include "game-server/combatqueue.hpp"
 #include "scripting/script.hpp"
 #include "utils/logger.h"
 
@@ -434,6 +435,7 @@ MapComposite::MapComposite(int id, const std::string &name):
     mMap(NULL),
     mContent(NULL),
     mScript(NULL),
+    mCombatQueue(new CombatQueue),
     mName(name),
     mID(id)
 {
@@ -443,6 +445,7 @@ MapComposite::~MapComposite()
 {
     delete mMap;
     delete mContent;
+    delete mCombatQueue;
     delete mScript;
 }
 
@@ -512,6 +515,11 @@ bool MapComposite::insert(Thing *ptr)
 
 void MapComposite::remove(Thing *ptr)
 {
+    if (ptr->canFight())
+    {
+        mCombatQueue->remove(static_cast<Being*>(ptr));
+    }
+
     for (std::vector<Thing*>::iterator i = mContent->things.begin(),
          i_end = mContent->things.end(); i != i_end; ++i)
     {
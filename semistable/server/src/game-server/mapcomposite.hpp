@@ -27,6 +27,7 @@
 class Actor;
 class Being;
 class Character;
+class CombatQueue;
 class Map;
 class MapComposite;
 class Point;
@@ -295,6 +296,12 @@ class MapComposite
          */
         void update();
 
+        /**
+         * Gets the attacks declared on the map and not resolved yet.
+         */
+        CombatQueue *getCombatQueue() const
+        { return mCombatQueue; }
+
         /**
          * Gets the PvP rules on the map.
          */
@@ -338,6 +345,7 @@ class MapComposite
         Map *mMap;            /**< Actual map. */
         MapContent *mContent; /**< Entities on the map. */
         Script *mScript;      /**< Script associated to this map. */
+        CombatQueue *mCombatQueue; /**< Attacks waiting to be resolved. */
         std::string mName;    /**< Name of the map. */
         unsigned short mID;   /**< ID of the map. */
 
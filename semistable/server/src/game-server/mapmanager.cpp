@@ -25,6 +25,7 @@
 #include "game-server/mapcomposite.hpp"
 #include "game-server/mapreader.hpp"
 #include "utils/logger.h"
+#include "utils/timer.h"
 #include "utils/xml.hpp"
 
 #include <cassert>
@@ -136,9 +137,11 @@ bool MapManager::raiseActive(int mapId)
     {
         file += ".gz";
     }
+    const uint64_t startTime = utils::Timer::getTimeInMillisec();
     if (MapReader::readMap(file, composite))
     {
-        LOG_INFO("Activated map \"" << file << "\" (id " << mapId << ")");
+        LOG_INFO("Activated map \"" << file << "\" (id " << mapId << ") in "
+                 << (utils::Timer::getTimeInMillisec() - startTime) << " ms");
         return true;
     }
     else
@@ -37,8 +37,6 @@
 
 #include <cstring>
 
-static std::vector< int > tilesetFirstGids;
-
 bool MapReader::readMap(const std::string &filename, MapComposite *composite)
 {
     int fileSize;
@@ -50,52 +48,65 @@ bool MapReader::readMap(const std::string &filename, MapComposite *composite)
         return false;
     }
 
-    xmlDocPtr doc = NULL;
+    // Use the snapshot of the map when it is up to date
+    const unsigned long checksum = MapCache::checksum(buffer, fileSize);
+    MapData data;
+    bool haveData = MapCache::read(filename, checksum, data);
 
-    int l = filename.length();
-    if (l > 3 && filename.substr(l - 3) == ".gz")
+    if (haveData)
     {
-        // Inflate the gzipped map data.
-        char *inflated;
-        unsigned inflatedSize = 0;
-        bool ret = inflateMemory(buffer, fileSize, inflated, inflatedSize);
         free(buffer);
-        buffer = ret ? inflated : NULL;
-        fileSize = inflatedSize;
     }
-
-    if (buffer)
+    else
     {
-        // Parse the XML document.
-        doc = xmlParseMemory(buffer, fileSize);
-        free(buffer);
-    }
+        xmlDocPtr doc = NULL;
 
-    if (!doc)
-    {
-        LOG_ERROR("Error while parsing map file '" << filename << "'!");
-        return false;
-    }
+        int l = filename.length();
+        if (l > 3 && filename.substr(l - 3) == ".gz")
+        {
+            // Inflate the gzipped map data.
+            char *inflated;
+            unsigned inflatedSize = 0;
+            bool ret = inflateMemory(buffer, fileSize, inflated, inflatedSize);
+            free(buffer);
+            buffer = ret ? inflated : NULL;
+            fileSize = inflatedSize;
+        }
 
-    Map *map = NULL;
-    xmlNodePtr node = xmlDocGetRootElement(doc);
+        if (buffer)
+        {
+            // Parse the XML document.
+            doc = xmlParseMemory(buffer, fileSize);
+            free(buffer);
+        }
 
-    std::vector<Thing *> things;
+        if (!doc)
+        {
+            LOG_ERROR("Error while parsing map file '" << filename << "'!");
+            return false;
+        }
 
-    // Parse the inflated map data.
-    if (node && xmlStrEqual(node->name, BAD_CAST "map"))
-    {
-        map = MapReader::readMap(node, filename, composite, things);
-    }
-    else
-    {
-        LOG_ERROR("Error: Not a map file (" << filename << ")!");
-    }
+        xmlNodePtr node = xmlDocGetRootElement(doc);
+
+        // Parse the inflated map data.
+        if (node && xmlStrEqual(node->name, BAD_CAST "map"))
+        {
+            readMapData(node, data);
+            MapCache::write(filename, checksum, data);
+            haveData = true;
+        }
+        else
+        {
+            LOG_ERROR("Error: Not a map file (" << filename << ")!");
+        }
 
-    xmlFreeDoc(doc);
+        xmlFreeDoc(doc);
+    }
 
-    if (map)
+    if (haveData)
     {
+        std::vector<Thing *> things;
+        Map *map = createMap(data, composite, things);
         composite->setMap(map);
 
         for (std::vector< Thing * >::const_iterator i = things.begin(),
@@ -114,17 +125,16 @@ bool MapReader::readMap(const std::string &filename, MapComposite *composite)
     return true;
 }
 
-Map* MapReader::readMap(xmlNodePtr node, const std::string &path,
-                        MapComposite *composite, std::vector<Thing *> &things)
+void MapReader::readMapData(xmlNodePtr node, MapData &data)
 {
-    // Take the filename off the path
-    std::string pathDir = path.substr(0, path.rfind("/") + 1);
-    int w = XML::getProperty(node, "width", 0);
-    int h = XML::getProperty(node, "height", 0);
+    data.width = XML::getProperty(node, "width", 0);
+    data.height = XML::getProperty(node, "height", 0);
     // We only support tile width of 32 at the moment
-    int tilew = XML::getProperty(node, "tilewidth", DEFAULT_TILE_WIDTH);
-    int tileh = XML::getProperty(node, "tileheight", DEFAULT_TILE_HEIGHT);
-    Map* map = new Map(w, h, tilew, tileh);
+    data.tileWidth = XML::getProperty(node, "tilewidth", DEFAULT_TILE_WIDTH);
+    data.tileHeight = XML::getProperty(node, "tileheight", DEFAULT_TILE_HEIGHT);
+    data.blocked.assign(data.width * data.height, 0);
+
+    std::vector<int> tilesetFirstGids;
 
     for (node = node->xmlChildrenNode; node != NULL; node = node->next)
     {
@@ -136,7 +146,7 @@ Map* MapReader::readMap(xmlNodePtr node, const std::string &path,
             }
             else
             {
-                ::tilesetFirstGids.push_back(XML::getProperty(node, "firstgid", 0));
+                tilesetFirstGids.push_back(XML::getProperty(node, "firstgid", 0));
             }
         }
         else if (xmlStrEqual(node->name, BAD_CAST "properties"))
@@ -148,7 +158,7 @@ Map* MapReader::readMap(xmlNodePtr node, const std::string &path,
                     std::string key = XML::getProperty(propNode, "name", "");
                     std::string val = XML::getProperty(propNode, "value", "");
                     LOG_DEBUG("  "<<key<<": "<<val);
-                    map->setProperty(key, val);
+                    data.properties.push_back(std::make_pair(key, val));
                 }
             }
         }
@@ -157,7 +167,7 @@ Map* MapReader::readMap(xmlNodePtr node, const std::string &path,
             if (utils::compareStrI(XML::getProperty(node, "name", "unnamed"),
                                    "collision") == 0)
             {
-                readLayer(node, map);
+                readLayer(node, data, tilesetFirstGids);
             }
         }
         else if (xmlStrEqual(node->name, BAD_CAST "objectgroup"))
@@ -170,227 +180,167 @@ Map* MapReader::readMap(xmlNodePtr node, const std::string &path,
                     continue;
                 }
 
-                std::string objName = XML::getProperty(objectNode, "name", "");
-                std::string objType = XML::getProperty(objectNode, "type", "");
-                objType = utils::toupper(objType);
-                int objX = XML::getProperty(objectNode, "x", 0);
-                int objY = XML::getProperty(objectNode, "y", 0);
-                int objW = XML::getProperty(objectNode, "width", 0);
-                int objH = XML::getProperty(objectNode, "height", 0);
-                Rectangle rect = { objX, objY, objW, objH };
-
+                MapData::Object object;
+                object.name = XML::getProperty(objectNode, "name", "");
+                object.type = XML::getProperty(objectNode, "type", "");
+                object.type = utils::toupper(object.type);
+                object.x = XML::getProperty(objectNode, "x", 0);
+                object.y = XML::getProperty(objectNode, "y", 0);
+                object.width = XML::getProperty(objectNode, "width", 0);
+                object.height = XML::getProperty(objectNode, "height", 0);
 
-                if (objType == "WARP")
+                for_each_xml_child_node(propertiesNode, objectNode)
                 {
-                    std::string destMapName = std::string();
-                    int destX = -1;
-                    int destY = -1;
-
-                    for_each_xml_child_node(propertiesNode, objectNode)
+                    if (!xmlStrEqual(propertiesNode->name, BAD_CAST "properties"))
                     {
-                        if (!xmlStrEqual(propertiesNode->name, BAD_CAST "properties"))
-                        {
-                            continue;
-                        }
-
-                        for_each_xml_child_node(propertyNode, propertiesNode)
-                        {
-                            if (xmlStrEqual(propertyNode->name, BAD_CAST "property"))
-                            {
-                                std::string value = XML::getProperty(propertyNode, "name", std::string());
-                                value = utils::toupper(value);
-                                if (value == "DEST_MAP")
-                                {
-                                    destMapName = getObjectProperty(propertyNode, std::string());
-                                }
-                                else if (value == "DEST_X")
-                                {
-                                    destX = getObjectProperty(propertyNode, -1);
-                                }
-                                else if (value == "DEST_Y")
-                                {
-                                    destY = getObjectProperty(propertyNode, -1);
-                                }
-                            }
-                        }
+                        continue;
                     }
 
-                    if (destMapName != "" && destX != -1 && destY != -1)
+                    for_each_xml_child_node(propertyNode, propertiesNode)
                     {
-                        MapComposite *destMap = MapManager::getMap(destMapName);
-                        if (destMap)
+                        if (xmlStrEqual(propertyNode->name, BAD_CAST "property"))
                         {
-                            things.push_back(new TriggerArea(
-                                composite, rect,
-                                new WarpAction(destMap, destX, destY),
-                                false));
+                            std::string name = XML::getProperty(propertyNode, "name", std::string());
+                            name = utils::toupper(name);
+                            object.properties.push_back(std::make_pair(
+                                name, getObjectProperty(propertyNode, std::string())));
                         }
                     }
-                    else
-                    {
-                        LOG_WARN("Unrecognized warp format");
-                    }
                 }
-                else if (objType == "SPAWN")
-                {
-                    int monsterId = -1;
-                    int maxBeings = 10; // Default value
-                    int spawnRate = 10; // Default value
 
-                    for_each_xml_child_node(propertiesNode, objectNode)
-                    {
-                        if (!xmlStrEqual(propertiesNode->name, BAD_CAST "properties"))
-                        {
-                            continue;
-                        }
+                data.objects.push_back(object);
+            }
+        }
+    }
+}
 
-                        for_each_xml_child_node(propertyNode, propertiesNode)
-                        {
-                            if (xmlStrEqual(propertyNode->name, BAD_CAST "property"))
-                            {
-                                std::string value = XML::getProperty(propertyNode, "name", std::string());
-                                value = utils::toupper(value);
-                                if (value == "MONSTER_ID")
-                                {
-                                    monsterId = getObjectProperty(propertyNode, monsterId);
-                                }
-                                else if (value == "MAX_BEINGS")
-                                {
-                                    maxBeings = getObjectProperty(propertyNode, maxBeings);
-                                }
-                                else if (value == "SPAWN_RATE")
-                                {
-                                    spawnRate = getObjectProperty(propertyNode, spawnRate);
-                                }
-                            }
-                        }
-                    }
+Map *MapReader::createMap(const MapData &data, MapComposite *composite,
+                          std::vector<Thing *> &things)
+{
+    Map *map = new Map(data.width, data.height,
+                       data.tileWidth, data.tileHeight);
 
-                    MonsterClass *monster = MonsterManager::getMonster(monsterId);
-                    if (monster)
-                    {
-                        things.push_back(new SpawnArea(composite, monster, rect, maxBeings, spawnRate));
-                    }
-                    else
-                    {
-                        LOG_WARN("Couldn't find monster ID " << monsterId <<
-                                " for spawn area");
-                    }
-                }
-                else if (objType == "NPC")
-                {
-                    Script *s = composite->getScript();
-                    if (!s)
-                    {
-                        // Create a Lua context.
-                        s = Script::create("lua");
-                        composite->setScript(s);
-                    }
+    for (int y = 0; y < data.height; ++y)
+    {
+        for (int x = 0; x < data.width; ++x)
+        {
+            if (data.blocked[x + y * data.width])
+                map->blockTile(x, y, Map::BLOCKTYPE_WALL);
+        }
+    }
 
-                    int npcId = -1;
-                    std::string scriptText;
+    for (MapData::Properties::const_iterator i = data.properties.begin(),
+         i_end = data.properties.end(); i != i_end; ++i)
+    {
+        map->setProperty(i->first, i->second);
+    }
 
-                    for_each_xml_child_node(propertiesNode, objectNode)
-                    {
-                        if (!xmlStrEqual(propertiesNode->name, BAD_CAST "properties"))
-                        {
-                            continue;
-                        }
+    for (std::vector<MapData::Object>::const_iterator i = data.objects.begin(),
+         i_end = data.objects.end(); i != i_end; ++i)
+    {
+        const MapData::Object &object = *i;
+        Rectangle rect = { object.x, object.y, object.width, object.height };
 
-                        for_each_xml_child_node(propertyNode, propertiesNode)
-                        {
-                            if (xmlStrEqual(propertyNode->name, BAD_CAST "property"))
-                            {
-                                std::string value = XML::getProperty(propertyNode, "name", std::string());
-                                value = utils::toupper(value);
-                                if (value == "NPC_ID")
-                                {
-                                    npcId = getObjectProperty(propertyNode, npcId);
-                                }
-                                else if (value == "SCRIPT")
-                                {
-                                    scriptText = getObjectProperty(propertyNode, "");
-                                }
-                            }
-                        }
-                    }
+        if (object.type == "WARP")
+        {
+            std::string destMapName = getObjectProperty(object, "DEST_MAP");
+            int destX = getObjectProperty(object, "DEST_X", -1);
+            int destY = getObjectProperty(object, "DEST_Y", -1);
 
-                    if (npcId != -1 && !scriptText.empty())
-                    {
-                        s->loadNPC(objName, npcId, objX, objY, scriptText.c_str());
-                    }
-                    else
-                    {
-                        LOG_WARN("Unrecognized format for npc");
-                    }
-                }
-                else if (objType == "SCRIPT")
+            if (destMapName != "" && destX != -1 && destY != -1)
+            {
+                MapComposite *destMap = MapManager::getMap(destMapName);
+                if (destMap)
                 {
-                    Script *s = composite->getScript();
-                    if (!s)
-                    {
-                        // Create a Lua context.
-                        s = Script::create("lua");
-                        composite->setScript(s);
-                    }
+                    things.push_back(new TriggerArea(
+                        composite, rect,
+                        new WarpAction(destMap, destX, destY),
+                        false));
+                }
+            }
+            else
+            {
+                LOG_WARN("Unrecognized warp format");
+            }
+        }
+        else if (object.type == "SPAWN")
+        {
+            int monsterId = getObjectProperty(object, "MONSTER_ID", -1);
+            int maxBeings = getObjectProperty(object, "MAX_BEINGS", 10);
+            int spawnRate = getObjectProperty(object, "SPAWN_RATE", 10);
 
-                    std::string scriptFilename;
-                    std::string scriptText;
+            MonsterClass *monster = MonsterManager::getMonster(monsterId);
+            if (monster)
+            {
+                things.push_back(new SpawnArea(composite, monster, rect, maxBeings, spawnRate));
+            }
+            else
+            {
+                LOG_WARN("Couldn't find monster ID " << monsterId <<
+                        " for spawn area");
+            }
+        }
+        else if (object.type == "NPC")
+        {
+            Script *s = composite->getScript();
+            if (!s)
+            {
+                // Create a Lua context.
+                s = Script::create("lua");
+                composite->setScript(s);
+            }
 
-                    for_each_xml_child_node(propertiesNode, objectNode)
-                    {
-                        if (!xmlStrEqual(propertiesNode->name, BAD_CAST "properties"))
-                        {
-                            continue;
-                        }
+            int npcId = getObjectProperty(object, "NPC_ID", -1);
+            std::string scriptText = getObjectProperty(object, "SCRIPT");
 
-                        for_each_xml_child_node(propertyNode, propertiesNode)
-                        {
-                            if (xmlStrEqual(propertyNode->name, BAD_CAST "property"))
-                            {
-                                std::string value = XML::getProperty(propertyNode, "name", std::string());
-                                value = utils::toupper(value);
-                                if (value == "FILENAME")
-                                {
-                                    scriptFilename = getObjectProperty(propertyNode, "");
-                                    trim(scriptFilename);
-                                }
-                                else if (value == "TEXT")
-                                {
-                                    scriptText = getObjectProperty(propertyNode, "");
-                                }
-                            }
-                        }
-                    }
+            if (npcId != -1 && !scriptText.empty())
+            {
+                s->loadNPC(object.name, npcId, object.x, object.y,
+                           scriptText.c_str());
+            }
+            else
+            {
+                LOG_WARN("Unrecognized format for npc");
+            }
+        }
+        else if (object.type == "SCRIPT")
+        {
+            Script *s = composite->getScript();
+            if (!s)
+            {
+                // Create a Lua context.
+                s = Script::create("lua");
+                composite->setScript(s);
+            }
 
-                    if (!scriptFilename.empty())
-                    {
-                        s->loadFile(scriptFilename);
-                    }
-                    else if (!scriptText.empty())
-                    {
-                        s->load(scriptText.c_str());
-                    }
-                    else
-                    {
-                        LOG_WARN("Unrecognized format for script");
-                    }
-                }
+            std::string scriptFilename = getObjectProperty(object, "FILENAME");
+            std::string scriptText = getObjectProperty(object, "TEXT");
+            trim(scriptFilename);
+
+            if (!scriptFilename.empty())
+            {
+                s->loadFile(scriptFilename);
+            }
+            else if (!scriptText.empty())
+            {
+                s->load(scriptText.c_str());
+            }
+            else
+            {
+                LOG_WARN("Unrecognized format for script");
             }
         }
     }
 
-    // Clean up tilesets
-    ::tilesetFirstGids.clear();
-
     return map;
 }
 
-void MapReader::readLayer(xmlNodePtr node, Map *map)
+void MapReader::readLayer(xmlNodePtr node, MapData &data,
+                          const std::vector<int> &tilesetFirstGids)
 {
     node = node->xmlChildrenNode;
-    int h = map->getHeight();
-    int w = map->getWidth();
+    int h = data.height;
+    int w = data.width;
     int x = 0;
     int y = 0;
 
@@ -471,7 +421,7 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
                       (binData[i + 2] << 16) |
                       (binData[i + 3] << 24);
 
-            setTileWithGid(map, x, y, gid);
+            setTileWithGid(data, x, y, gid, tilesetFirstGids);
 
             if (++x == w)
             {
@@ -491,7 +441,7 @@ void MapReader::readLayer(xmlNodePtr node, Map *map)
         if (xmlStrEqual(node->name, BAD_CAST "tile") && y < h)
         {
             int gid = XML::getProperty(node, "gid", -1);
-            setTileWithGid(map, x, y, gid);
+            setTileWithGid(data, x, y, gid, tilesetFirstGids);
 
             if (++x == w)
             {
@@ -511,33 +461,45 @@ std::string MapReader::getObjectProperty(xmlNodePtr node,
     {
         return XML::getProperty(node, "value", def);
     }
-    else if (const char *prop = (const char *)node->xmlChildrenNode->content)
+    else if (node->xmlChildrenNode && node->xmlChildrenNode->content)
     {
-        return std::string(prop);
+        return std::string((const char *) node->xmlChildrenNode->content);
     }
     return std::string();
 }
 
-int MapReader::getObjectProperty(xmlNodePtr node, int def)
+int MapReader::getObjectProperty(const MapData::Object &object,
+                                 const std::string &name, int def)
 {
-    int val = def;
-    if (xmlHasProp(node, BAD_CAST "value"))
+    for (MapData::Properties::const_iterator i = object.properties.begin(),
+         i_end = object.properties.end(); i != i_end; ++i)
     {
-        val = XML::getProperty(node, "value", def);
+        if (i->first == name)
+            def = atoi(i->second.c_str());
     }
-    else if (const char *prop = (const char *)node->xmlChildrenNode->content)
+    return def;
+}
+
+std::string MapReader::getObjectProperty(const MapData::Object &object,
+                                         const std::string &name)
+{
+    std::string value;
+    for (MapData::Properties::const_iterator i = object.properties.begin(),
+         i_end = object.properties.end(); i != i_end; ++i)
     {
-        val = atoi(prop);
+        if (i->first == name)
+            value = i->second;
     }
-    return val;
+    return value;
 }
 
-void MapReader::setTileWithGid(Map *map, int x, int y, int gid)
+void MapReader::setTileWithGid(MapData &data, int x, int y, int gid,
+                               const std::vector<int> &tilesetFirstGids)
 {
     // Find the tileset with the highest firstGid below/eq to gid
     int set = gid;
-    for (std::vector< int >::const_iterator i = ::tilesetFirstGids.begin(),
-         i_end = ::tilesetFirstGids.end(); i != i_end; ++i)
+    for (std::vector< int >::const_iterator i = tilesetFirstGids.begin(),
+         i_end = tilesetFirstGids.end(); i != i_end; ++i)
     {
         if (gid < *i)
             break;
@@ -545,6 +507,6 @@ void MapReader::setTileWithGid(Map *map, int x, int y, int gid)
         set = *i;
     }
 
-    if (gid!=set)
-        map->blockTile(x, y, Map::BLOCKTYPE_WALL);
+    if (gid != set && x < data.width && y < data.height)
+        data.blocked[x + y * data.width] = 1;
 }
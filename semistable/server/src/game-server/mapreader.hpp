@@ -26,12 +26,15 @@
 
 #include <libxml/tree.h>
 
+#include "game-server/mapcache.hpp"
+
 class Map;
 class MapComposite;
 class Thing;
 
 /**
- * Reader for XML map files (*.tmx)
+ * Reader for XML map files (*.tmx). Parsed maps are kept as binary
+ * snapshots, see MapCache.
  */
 class MapReader
 {
@@ -45,17 +48,22 @@ class MapReader
 
     private:
         /**
-         * Read an XML map from a parsed XML tree, and populate things with
-         * objects in that map.
+         * Read an XML map from a parsed XML tree into the given map data.
+         */
+        static void readMapData(xmlNodePtr node, MapData &data);
+
+        /**
+         * Creates the map from the given map data, and populates things with
+         * the objects in that map.
          */
-        static Map *readMap(xmlNodePtr node, const std::string &path,
-                            MapComposite *composite,
-                            std::vector<Thing *> &things);
+        static Map *createMap(const MapData &data, MapComposite *composite,
+                              std::vector<Thing *> &things);
 
         /**
-         * Reads a map layer and adds it to the given map.
+         * Reads a map layer and marks the tiles it blocks in the map data.
          */
-        static void readLayer(xmlNodePtr node, Map *map);
+        static void readLayer(xmlNodePtr node, MapData &data,
+                              const std::vector<int> &tilesetFirstGids);
 
         /**
          * Get the string value from the given object property node.
@@ -64,11 +72,21 @@ class MapReader
                                              const std::string &def);
 
         /**
-         * Get the integer value from the given object property node.
+         * Get the integer value of the given object property, or the default
+         * when the object doesn't have it.
+         */
+        static int getObjectProperty(const MapData::Object &object,
+                                     const std::string &name, int def);
+
+        /**
+         * Get the string value of the given object property, or an empty
+         * string when the object doesn't have it.
          */
-        static int getObjectProperty(xmlNodePtr node, int def);
+        static std::string getObjectProperty(const MapData::Object &object,
+                                             const std::string &name);
 
-        static void setTileWithGid(Map *map, int x, int y, int gid);
+        static void setTileWithGid(MapData &data, int x, int y, int gid,
+                                   const std::vector<int> &tilesetFirstGids);
 };
 
 #endif
@@ -0,0 +1,261 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+#include "game-server/metrics.hpp"
+
+#include "net/bandwidth.hpp"
+
+using namespace Metrics;
+
+static const char *phaseNames[NB_PHASES] =
+{
+    "update",
+    "scripts",
+    "perform",
+    "combat",
+    "move",
+    "inform"
+};
+
+static const char *callNames[NB_CALLS] =
+{
+    "pathfinding",
+    "script"
+};
+
+struct MapPhases
+{
+    Histogram phases[NB_PHASES];
+};
+
+typedef std::map<int, MapPhases> Maps;
+
+static Maps maps;
+static Histogram ticks;
+static Histogram delayedEvents;
+static Histogram calls[NB_CALLS];
+static unsigned int skippedTicks = 0;
+static unsigned int overruns = 0;   /**< Times ticks had to be skipped. */
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+void Histogram::reset()
+{
+    std::fill(mBuckets, mBuckets + NB_BUCKETS, 0);
+    mCount = 0;
+    mMax = 0;
+    mSum = 0;
+}
+
+void Histogram::add(unsigned int value)
+{
+    int bucket = 0;
+    for (unsigned int v = value; v; v >>= 1)
+        ++bucket;
+
+    ++mBuckets[bucket];
+    ++mCount;
+    mSum += value;
+    if (value > mMax)
+        mMax = value;
+}
+
+unsigned int Histogram::getPercentile(int percent) const
+{
+    // Rank of the value, rounded up
+    const unsigned long long rank =
+            ((unsigned long long) mCount * percent + 99) / 100;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < NB_BUCKETS; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen >= rank && seen > 0)
+        {
+            const unsigned int upper =
+                    i == 32 ? 0xFFFFFFFFu : (1u << i) - 1;
+            return std::min(upper, mMax);
+        }
+    }
+    return mMax;
+}
+
+void Histogram::write(std::ostream &os) const
+{
+    os << " count=\"" << mCount
+       << "\" total=\"" << mSum
+       << "\" max=\"" << mMax
+       << "\" p50=\"" << getPercentile(50)
+       << "\" p90=\"" << getPercentile(90)
+       << "\" p99=\"" << getPercentile(99)
+       << "\" buckets=\"";
+
+    // Trailing empty buckets are left out
+    int last = NB_BUCKETS - 1;
+    while (last > 0 && !mBuckets[last])
+        --last;
+    for (int i = 0; i <= last; ++i)
+        os << (i ? " " : "") << mBuckets[i];
+    os << '"';
+}
+
+CallTimer::CallTimer(Call call):
+    mCall(call),
+    mStart(utils::Timer::getTimeInMicrosec())
+{
+}
+
+CallTimer::~CallTimer()
+{
+    addCallTime(mCall, utils::Timer::getTimeInMicrosec() - mStart);
+}
+
+Histogram *Metrics::getPhases(int mapId)
+{
+    return maps[mapId].phases;
+}
+
+void Metrics::addTickTime(unsigned int us)
+{
+    ticks.add(us);
+}
+
+void Metrics::addDelayedEventsTime(unsigned int us)
+{
+    delayedEvents.add(us);
+}
+
+void Metrics::addCallTime(Call call, unsigned int us)
+{
+    calls[call].add(us);
+}
+
+void Metrics::addSkippedTicks(int count)
+{
+    skippedTicks += count;
+    ++overruns;
+}
+
+void Metrics::reset()
+{
+    for (Maps::iterator i = maps.begin(), i_end = maps.end(); i != i_end; ++i)
+    {
+        for (int phase = 0; phase < NB_PHASES; ++phase)
+            i->second.phases[phase].reset();
+    }
+    ticks.reset();
+    delayedEvents.reset();
+    for (int call = 0; call < NB_CALLS; ++call)
+        calls[call].reset();
+    skippedTicks = 0;
+    overruns = 0;
+}
+
+void Metrics::write(std::ostream &os)
+{
+    os << "<metrics skipped_ticks=\"" << skippedTicks
+       << "\" overruns=\"" << overruns << "\">\n";
+
+    os << "<tick";
+    ticks.write(os);
+    os << "/>\n<delayedevents";
+    delayedEvents.write(os);
+    os << "/>\n";
+
+    for (int call = 0; call < NB_CALLS; ++call)
+    {
+        os << "<call name=\"" << callNames[call] << '"';
+        calls[call].write(os);
+        os << "/>\n";
+    }
+
+    for (Maps::const_iterator i = maps.begin(), i_end = maps.end();
+         i != i_end; ++i)
+    {
+        os << "<map id=\"" << i->first << "\">\n";
+        for (int phase = 0; phase < NB_PHASES; ++phase)
+        {
+            os << "<phase name=\"" << phaseNames[phase] << '"';
+            i->second.phases[phase].write(os);
+            os << "/>\n";
+        }
+        os << "</map>\n";
+    }
+
+    gBandwidth->dumpStatistics(os);
+
+    os << "</metrics>\n";
+}
+
+/**
+ * Describes a histogram on one line.
+ */
+static std::string describe(const char *name, const Histogram &histogram)
+{
+    std::ostringstream line;
+    line << name << ": " << histogram.getCount()
+         << " samples, p50 " << histogram.getPercentile(50)
+         << ", p90 " << histogram.getPercentile(90)
+         << ", p99 " << histogram.getPercentile(99)
+         << ", max " << histogram.getMax();
+    return line.str();
+}
+
+void Metrics::summarize(int mapId, std::vector<std::string> &lines)
+{
+    std::ostringstream skipped;
+    skipped << "Skipped ticks: " << skippedTicks << " in " << overruns
+            << " overruns";
+    lines.push_back(skipped.str());
+
+    lines.push_back(describe("Ticks (us)", ticks));
+    lines.push_back(describe("Delayed events (us)", delayedEvents));
+    lines.push_back(describe("Path finding (us)",
+                                calls[CALL_PATHFINDING]));
+    lines.push_back(describe("Script calls (us)", calls[CALL_SCRIPT]));
+
+    Maps::const_iterator i = maps.find(mapId);
+    if (i != maps.end())
+    {
+        for (int phase = 0; phase < NB_PHASES; ++phase)
+        {
+            std::ostringstream name;
+            name << "Map " << mapId << ' ' << phaseNames[phase] << " (us)";
+            lines.push_back(describe(name.str().c_str(),
+                                        i->second.phases[phase]));
+        }
+    }
+
+    std::ostringstream traffic;
+    traffic << "Client traffic: "
+            << gBandwidth->totalClientMessagesOut() << " messages ("
+            << gBandwidth->totalClientOut() << " B) out, "
+            << gBandwidth->totalClientMessagesIn() << " messages ("
+            << gBandwidth->totalClientIn() << " B) in";
+    lines.push_back(traffic.str());
+}
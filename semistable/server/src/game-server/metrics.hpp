@@ -0,0 +1,152 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "utils/timer.h"
+
+/**
+ * Measures where the game server spends its time: how long each phase of a
+ * world tick takes on each map, how long path finding and script calls take,
+ * and how many ticks had to be skipped. The traffic by message type and by
+ * client is counted by the BandwidthMonitor.
+ *
+ * All times are in microseconds and kept as histograms, so that the rare
+ * slow tick stays visible next to the median.
+ */
+namespace Metrics
+{
+    /**
+     * The phases of a world tick on a map.
+     */
+    enum Phase
+    {
+        PHASE_UPDATE = 0,
+        PHASE_SCRIPTS,
+        PHASE_PERFORM,
+        PHASE_COMBAT,
+        PHASE_MOVE,
+        PHASE_INFORM,
+        NB_PHASES
+    };
+
+    /**
+     * The kinds of calls that are timed wherever they are made.
+     */
+    enum Call
+    {
+        CALL_PATHFINDING = 0,
+        CALL_SCRIPT,
+        NB_CALLS
+    };
+
+    /**
+     * A histogram of values with buckets growing in powers of two. Bucket i
+     * counts the values that need i bits, so bucket 0 counts the zeros and
+     * bucket 10 the values from 512 to 1023.
+     */
+    class Histogram
+    {
+        public:
+            Histogram();
+
+            void add(unsigned int value);
+
+            void reset();
+
+            unsigned int getCount() const
+            { return mCount; }
+
+            unsigned int getMax() const
+            { return mMax; }
+
+            /**
+             * Returns an upper bound of the given percentile, accurate to
+             * the bucket it falls in.
+             */
+            unsigned int getPercentile(int percent) const;
+
+            /**
+             * Writes the histogram as XML attributes.
+             */
+            void write(std::ostream &os) const;
+
+        private:
+            enum { NB_BUCKETS = 33 };
+
+            unsigned int mBuckets[NB_BUCKETS];
+            unsigned int mCount;
+            unsigned int mMax;
+            unsigned long long mSum;
+    };
+
+    /**
+     * Times a call from its construction to its destruction.
+     */
+    class CallTimer
+    {
+        public:
+            CallTimer(Call call);
+            ~CallTimer();
+
+        private:
+            Call mCall;
+            uint64_t mStart;
+    };
+
+    /**
+     * Returns the histograms of the tick phases of a map, indexed by Phase.
+     */
+    Histogram *getPhases(int mapId);
+
+    void addTickTime(unsigned int us);
+
+    void addDelayedEventsTime(unsigned int us);
+
+    void addCallTime(Call call, unsigned int us);
+
+    /**
+     * Counts ticks that were skipped because the server fell behind.
+     */
+    void addSkippedTicks(int ticks);
+
+    /**
+     * Forgets everything measured so far.
+     */
+    void reset();
+
+    /**
+     * Writes everything measured so far as an XML document.
+     */
+    void write(std::ostream &os);
+
+    /**
+     * Describes the measures of the whole server and of the given map in a
+     * few lines of text.
+     */
+    void summarize(int mapId, std::vector<std::string> &lines);
+}
+
+#endif // METRICS_HPP
@@ -130,19 +130,7 @@ void Monster::perform()
             damage.element = mCurrentAttack->element;
             damage.type = mCurrentAttack->type;
 
-            int hit = performAttack(mTarget, mCurrentAttack->range, damage);
-
-            if (! mCurrentAttack->scriptFunction.empty()
-                && mScript
-                && hit > -1)
-            {
-                mScript->setMap(getMap());
-                mScript->prepare(mCurrentAttack->scriptFunction);
-                mScript->push(this);
-                mScript->push(mTarget);
-                mScript->push(hit);
-                mScript->execute();
-            }
+            performAttack(mTarget, mCurrentAttack->range, damage);
         }
     }
     if (mAction == ATTACK && !mTarget)
@@ -187,7 +175,8 @@ void Monster::update()
     Direction bestAttackDirection = DIRECTION_DOWN;
 
     // Iterate through objects nearby
-    int aroundArea = Configuration::getValue("visualRange", 448);
+    static const IntOption visualRange("visualRange", 448);
+    int aroundArea = visualRange;
     for (BeingIterator i(getMap()->getAroundBeingIterator(this, aroundArea)); i; ++i)
     {
         // We only want to attack player characters
@@ -386,6 +375,19 @@ void Monster::changeAnger(Actor *target, int amount)
     }
 }
 
+void Monster::attackResolved(Being *target, int hit)
+{
+    if (mCurrentAttack && !mCurrentAttack->scriptFunction.empty() && mScript)
+    {
+        mScript->setMap(getMap());
+        mScript->prepare(mCurrentAttack->scriptFunction);
+        mScript->push(this);
+        mScript->push(target);
+        mScript->push(hit);
+        mScript->execute();
+    }
+}
+
 int Monster::damage(Actor *source, const Damage &damage)
 {
     int HPLoss = Being::damage(source, damage);
@@ -280,6 +280,12 @@ class Monster : public Being
          */
         virtual int damage(Actor *source, const Damage &damage);
 
+        /**
+         * Calls the script function of the current attack with the damage
+         * it did.
+         */
+        virtual void attackResolved(Being *target, int hit);
+
         /**
          * Removes a being from the anger list.
          */
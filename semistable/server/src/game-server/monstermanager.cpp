@@ -287,3 +287,14 @@ MonsterClass *MonsterManager::getMonster(int id)
     MonsterClasses::const_iterator i = monsterClasses.find(id);
     return i != monsterClasses.end() ? i->second : 0;
 }
+
+std::vector<MonsterClass *> MonsterManager::getMonsters()
+{
+    std::vector<MonsterClass *> monsters;
+    for (MonsterClasses::const_iterator i = monsterClasses.begin(),
+         i_end = monsterClasses.end(); i != i_end; ++i)
+    {
+        monsters.push_back(i->second);
+    }
+    return monsters;
+}
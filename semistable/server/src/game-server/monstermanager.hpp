@@ -22,6 +22,7 @@
 #define MONSTERMANAGER_HPP
 
 #include <string>
+#include <vector>
 
 class MonsterClass;
 
@@ -46,6 +47,11 @@ namespace MonsterManager
      * Gets the MonsterClass having the given ID.
      */
     MonsterClass *getMonster(int id);
+
+    /**
+     * Gets all the monster classes, ordered by ID.
+     */
+    std::vector<MonsterClass *> getMonsters();
 }
 
 #endif // MONSTERMANAGER_HPP
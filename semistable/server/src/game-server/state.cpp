@@ -29,10 +29,12 @@
 #include "game-server/inventory.hpp"
 #include "game-server/item.hpp"
 #include "game-server/itemmanager.hpp"
+#include "game-server/combatqueue.hpp"
 #include "game-server/effect.hpp"
 #include "game-server/map.hpp"
 #include "game-server/mapcomposite.hpp"
 #include "game-server/mapmanager.hpp"
+#include "game-server/metrics.hpp"
 #include "game-server/monster.hpp"
 #include "game-server/npc.hpp"
 #include "game-server/trade.hpp"
@@ -64,10 +66,19 @@ typedef std::map< Actor *, DelayedEvent > DelayedEvents;
 static DelayedEvents delayedEvents;
 
 /**
- * Updates object states on the map.
+ * Distance up to which clients are informed about things around them.
  */
-static void updateMap(MapComposite *map)
+static const IntOption visualRangeOption("visualRange", 320);
+
+/**
+ * Updates object states on the map, and adds the time each phase took to the
+ * given histograms.
+ */
+static void updateMap(MapComposite *map, Metrics::Histogram *phases)
 {
+    uint64_t start = utils::Timer::getTimeInMicrosec();
+    uint64_t end;
+
     // 1. update object status.
     const std::vector< Thing * > &things = map->getEverything();
     for (std::vector< Thing * >::const_iterator i = things.begin(),
@@ -76,24 +87,46 @@ static void updateMap(MapComposite *map)
         (*i)->update();
     }
 
+    end = utils::Timer::getTimeInMicrosec();
+    phases[Metrics::PHASE_UPDATE].add(end - start);
+    start = end;
+
     // 2. run scripts.
     if (Script *s = map->getScript())
     {
         s->update();
     }
 
+    end = utils::Timer::getTimeInMicrosec();
+    phases[Metrics::PHASE_SCRIPTS].add(end - start);
+    start = end;
+
     // 3. perform actions.
     for (BeingIterator i(map->getWholeMapIterator()); i; ++i)
     {
         (*i)->perform();
     }
 
-    // 4. move objects around and update zones.
+    end = utils::Timer::getTimeInMicrosec();
+    phases[Metrics::PHASE_PERFORM].add(end - start);
+    start = end;
+
+    // 4. resolve the attacks declared by the actions and the scripts.
+    map->getCombatQueue()->resolve();
+
+    end = utils::Timer::getTimeInMicrosec();
+    phases[Metrics::PHASE_COMBAT].add(end - start);
+    start = end;
+
+    // 5. move objects around and update zones.
     for (BeingIterator i(map->getWholeMapIterator()); i; ++i)
     {
         (*i)->move();
     }
     map->update();
+
+    end = utils::Timer::getTimeInMicrosec();
+    phases[Metrics::PHASE_MOVE].add(end - start);
 }
 
 /**
@@ -166,7 +199,7 @@ static void informPlayer(MapComposite *map, Character *p)
     MessageOut damageMsg(GPMSG_BEINGS_DAMAGE);
     const Point &pold = p->getOldPosition(), ppos = p->getPosition();
     int pid = p->getPublicID(), pflags = p->getUpdateFlags();
-    int visualRange = Configuration::getValue("visualRange", 320);
+    int visualRange = visualRangeOption;
 
     // Inform client about activities of other beings near its character
     for (BeingIterator i(map->getAroundBeingIterator(p, visualRange)); i; ++i)
@@ -233,16 +266,14 @@ static void informPlayer(MapComposite *map, Character *p)
                 gameHandler->sendTo(p, DirMsg);
             }
 
-            // Send damage messages.
+            // Send damage messages, one for all the hits of the tick.
             if (o->canFight())
             {
                 Being *victim = static_cast< Being * >(o);
-                const Hits &hits = victim->getHitsTaken();
-                for (Hits::const_iterator j = hits.begin(),
-                     j_end = hits.end(); j != j_end; ++j)
+                if (int damage = victim->getDamageTaken())
                 {
                     damageMsg.writeShort(oid);
-                    damageMsg.writeShort(*j);
+                    damageMsg.writeShort(damage);
                 }
             }
 
@@ -431,8 +462,24 @@ static void informPlayer(MapComposite *map, Character *p)
 static bool dbgLockObjects;
 #endif
 
+/** World time of the current update. */
+static int currentTick = 0;
+
+int GameState::getCurrentTick()
+{
+    return currentTick;
+}
+
+void GameState::setCurrentTick(int tick)
+{
+    currentTick = tick;
+}
+
 void GameState::update(int worldTime)
 {
+    const uint64_t tickStart = utils::Timer::getTimeInMicrosec();
+    currentTick = worldTime;
+
 #   ifndef NDEBUG
     dbgLockObjects = true;
 #   endif
@@ -447,8 +494,10 @@ void GameState::update(int worldTime)
             continue;
         }
 
-        updateMap(map);
+        Metrics::Histogram *phases = Metrics::getPhases(map->getID());
+        updateMap(map, phases);
 
+        const uint64_t informStart = utils::Timer::getTimeInMicrosec();
         for (CharacterIterator p(map->getWholeMapIterator()); p; ++p)
         {
             informPlayer(map, *p);
@@ -463,6 +512,8 @@ void GameState::update(int worldTime)
             }
             */
         }
+        phases[Metrics::PHASE_INFORM].add(
+                utils::Timer::getTimeInMicrosec() - informStart);
 
         for (ActorIterator i(map->getWholeMapIterator()); i; ++i)
         {
@@ -470,7 +521,7 @@ void GameState::update(int worldTime)
             a->clearUpdateFlags();
             if (a->canFight())
             {
-                static_cast< Being * >(a)->clearHitsTaken();
+                static_cast< Being * >(a)->clearDamageTaken();
             }
         }
     }
@@ -480,6 +531,7 @@ void GameState::update(int worldTime)
 #   endif
 
     // Take care of events that were delayed because of their side effects.
+    const uint64_t delayedStart = utils::Timer::getTimeInMicrosec();
     for (DelayedEvents::iterator i = delayedEvents.begin(),
          i_end = delayedEvents.end(); i != i_end; ++i)
     {
@@ -509,6 +561,10 @@ void GameState::update(int worldTime)
         }
     }
     delayedEvents.clear();
+
+    const uint64_t tickEnd = utils::Timer::getTimeInMicrosec();
+    Metrics::addDelayedEventsTime(tickEnd - delayedStart);
+    Metrics::addTickTime(tickEnd - tickStart);
 }
 
 bool GameState::insert(Thing *ptr)
@@ -609,7 +665,7 @@ void GameState::remove(Thing *ptr)
 {
     assert(!dbgLockObjects);
     MapComposite *map = ptr->getMap();
-    int visualRange = Configuration::getValue("visualRange", 320);
+    int visualRange = visualRangeOption;
 
     ptr->removed();
 
@@ -751,7 +807,7 @@ void GameState::enqueueWarp(Character *ptr, MapComposite *m, int x, int y)
 void GameState::sayAround(Actor *obj, const std::string &text)
 {
     Point speakerPosition = obj->getPosition();
-    int visualRange = Configuration::getValue("visualRange", 320);
+    int visualRange = visualRangeOption;
 
     for (CharacterIterator i(obj->getMap()->getAroundActorIterator(obj, visualRange)); i; ++i)
     {
@@ -35,6 +35,18 @@ namespace GameState
      */
     void update(int worldTime);
 
+    /**
+     * Returns the world time of the current update, in ticks. Timers are
+     * kept as the tick they end at, so they don't need updating each tick.
+     */
+    int getCurrentTick();
+
+    /**
+     * Starts the given tick before the messages of that tick are handled,
+     * so that timers set by them count from the same tick as the update.
+     */
+    void setCurrentTick(int tick);
+
     /**
      * Inserts an thing in the game world.
      * @return false if the insertion failed and the thing is in limbo.
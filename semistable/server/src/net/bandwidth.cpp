@@ -22,11 +22,16 @@
 
 #include "netcomputer.hpp"
 
+#include <iomanip>
+#include <ostream>
+
 BandwidthMonitor::BandwidthMonitor():
     mAmountServerOutput(0),
     mAmountServerInput(0),
     mAmountClientOutput(0),
-    mAmountClientInput(0)
+    mAmountClientInput(0),
+    mClientMessagesOutput(0),
+    mClientMessagesInput(0)
 {
 }
 
@@ -40,39 +45,72 @@ void BandwidthMonitor::increaseInterServerInput(int size)
     mAmountServerInput += size;
 }
 
-void BandwidthMonitor::increaseClientOutput(NetComputer *nc, int size)
+void BandwidthMonitor::increaseClientOutput(NetComputer *nc, int messageId,
+                                            int size)
 {
     mAmountClientOutput += size;
-    // look for an existing client stored
-    ClientBandwidth::iterator itr = mClientBandwidth.find(nc);
+    ++mClientMessagesOutput;
 
-    // if there isnt one, create one
-    if (itr == mClientBandwidth.end())
-    {
-        std::pair<ClientBandwidth::iterator, bool> retItr;
-        retItr = mClientBandwidth.insert(std::pair<NetComputer*, std::pair<int, int> >(nc, std::pair<int, int>(0, 0)));
-        itr = retItr.first;
-    }
-
-    itr->second.first += size;
+    // operator[] creates the entries the first time
+    Traffic &client = mClientBandwidth[nc];
+    ++client.messagesOut;
+    client.bytesOut += size;
 
+    Traffic &message = mMessageBandwidth[messageId];
+    ++message.messagesOut;
+    message.bytesOut += size;
 }
 
-void BandwidthMonitor::increaseClientInput(NetComputer *nc, int size)
+void BandwidthMonitor::increaseClientInput(NetComputer *nc, int messageId,
+                                           int size)
 {
     mAmountClientInput += size;
+    ++mClientMessagesInput;
+
+    Traffic &client = mClientBandwidth[nc];
+    ++client.messagesIn;
+    client.bytesIn += size;
 
-    // look for an existing client stored
-    ClientBandwidth::iterator itr = mClientBandwidth.find(nc);
+    Traffic &message = mMessageBandwidth[messageId];
+    ++message.messagesIn;
+    message.bytesIn += size;
+}
+
+void BandwidthMonitor::removeClient(NetComputer *nc)
+{
+    mClientBandwidth.erase(nc);
+}
+
+void BandwidthMonitor::writeTraffic(std::ostream &os, const Traffic &traffic)
+{
+    os << " nb_out=\"" << traffic.messagesOut
+       << "\" bytes_out=\"" << traffic.bytesOut
+       << "\" nb_in=\"" << traffic.messagesIn
+       << "\" bytes_in=\"" << traffic.bytesIn << '"';
+}
+
+void BandwidthMonitor::dumpStatistics(std::ostream &os) const
+{
+    os << "<bandwidth server_out=\"" << mAmountServerOutput
+       << "\" server_in=\"" << mAmountServerInput << "\">\n";
+
+    for (MessageBandwidth::const_iterator i = mMessageBandwidth.begin(),
+         i_end = mMessageBandwidth.end(); i != i_end; ++i)
+    {
+        os << "<message id=\"" << std::hex << std::showbase << i->first
+           << std::dec << std::noshowbase << '"';
+        writeTraffic(os, i->second);
+        os << "/>\n";
+    }
 
-    // if there isnt one, create it
-    if (itr == mClientBandwidth.end())
+    for (ClientBandwidth::const_iterator i = mClientBandwidth.begin(),
+         i_end = mClientBandwidth.end(); i != i_end; ++i)
     {
-        std::pair<ClientBandwidth::iterator, bool> retItr;
-        retItr = mClientBandwidth.insert(std::pair<NetComputer*, std::pair<int, int> >(nc, std::pair<int, int>(0, 0)));
-        itr = retItr.first;
+        os << "<client address=\"" << *i->first << '"';
+        writeTraffic(os, i->second);
+        os << "/>\n";
     }
 
-    itr->second.second += size;
+    os << "</bandwidth>\n";
 }
 
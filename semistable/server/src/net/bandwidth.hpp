@@ -21,6 +21,7 @@
 #ifndef BANDWIDTH_H
 #define BANDWIDTH_H
 
+#include <iosfwd>
 #include <map>
 
 class NetComputer;
@@ -31,21 +32,51 @@ public:
     BandwidthMonitor();
     void increaseInterServerOutput(int size);
     void increaseInterServerInput(int size);
-    void increaseClientOutput(NetComputer *nc, int size);
-    void increaseClientInput(NetComputer *nc, int size);
+    void increaseClientOutput(NetComputer *nc, int messageId, int size);
+    void increaseClientInput(NetComputer *nc, int messageId, int size);
     int totalInterServerOut() const { return mAmountServerOutput; }
     int totalInterServerIn() const { return mAmountServerInput; }
     int totalClientOut() const { return mAmountClientOutput; }
     int totalClientIn() const { return mAmountClientInput; }
+    int totalClientMessagesOut() const { return mClientMessagesOutput; }
+    int totalClientMessagesIn() const { return mClientMessagesInput; }
+
+    /**
+     * Forgets the traffic of a client that disconnected.
+     */
+    void removeClient(NetComputer *nc);
+
+    /**
+     * Dumps the client traffic by message type and by client into the
+     * given stream, as XML.
+     */
+    void dumpStatistics(std::ostream &os) const;
 
 private:
+    struct Traffic
+    {
+        Traffic(): messagesOut(0), bytesOut(0), messagesIn(0), bytesIn(0) {}
+
+        int messagesOut;
+        int bytesOut;
+        int messagesIn;
+        int bytesIn;
+    };
+
+    static void writeTraffic(std::ostream &os, const Traffic &traffic);
+
     int mAmountServerOutput;
     int mAmountServerInput;
     int mAmountClientOutput;
     int mAmountClientInput;
+    int mClientMessagesOutput;
+    int mClientMessagesInput;
     // map of client to output and input
-    typedef std::map<NetComputer*, std::pair<int, int> > ClientBandwidth;
+    typedef std::map<NetComputer*, Traffic> ClientBandwidth;
     ClientBandwidth mClientBandwidth;
+    // map of message id to output and input
+    typedef std::map<int, Traffic> MessageBandwidth;
+    MessageBandwidth mMessageBandwidth;
 };
 
 extern BandwidthMonitor *gBandwidth;
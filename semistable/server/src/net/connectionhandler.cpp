@@ -124,7 +124,8 @@ void ConnectionHandler::process(enet_uint32 timeout)
                     LOG_DEBUG("Received message " << msg << " from "
                               << *comp);
 
-                    gBandwidth->increaseClientInput(comp, event.packet->dataLength);
+                    gBandwidth->increaseClientInput(comp, msg.getId(),
+                                                    event.packet->dataLength);
 
                     processMessage(comp, msg);
                 } else {
@@ -142,6 +143,8 @@ void ConnectionHandler::process(enet_uint32 timeout)
 
                 LOG_INFO("" << *comp << " disconnected.");
 
+                gBandwidth->removeClient(comp);
+
                 // Reset the peer's client information.
                 computerDisconnected(comp);
                 clients.erase(std::find(clients.begin(), clients.end(), comp));
@@ -155,11 +158,17 @@ void ConnectionHandler::process(enet_uint32 timeout)
 
 void ConnectionHandler::sendToEveryone(const MessageOut &msg)
 {
+    ENetPacket *packet = NetComputer::createPacket(msg);
+    if (!packet)
+        return;
+
     for (NetComputers::iterator i = clients.begin(), i_end = clients.end();
          i != i_end; ++i)
     {
-        (*i)->send(msg);
+        (*i)->send(msg, packet);
     }
+
+    NetComputer::releasePacket(packet);
 }
 
 unsigned int ConnectionHandler::getClientCount() const
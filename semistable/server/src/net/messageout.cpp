@@ -136,6 +136,14 @@ MessageOut::writeString(const std::string &string, int length)
     mPos += length;
 }
 
+int MessageOut::getId() const
+{
+    if (mPos < 2)
+        return -1;
+
+    return (unsigned short) ENET_NET_TO_HOST_16(*(short*) mData);
+}
+
 std::ostream&
 operator <<(std::ostream &os, const MessageOut &msg)
 {
@@ -79,6 +79,12 @@ class MessageOut
         unsigned int
         getLength() const { return mPos; }
 
+        /**
+         * Returns the message ID, or -1 when it wasn't written yet.
+         */
+        int
+        getId() const;
+
     private:
         /**
          * Ensures the capacity of the data buffer is large enough to hold the
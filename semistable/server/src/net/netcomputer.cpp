@@ -58,24 +58,41 @@ void NetComputer::disconnect(const MessageOut &msg)
 
 void NetComputer::send(const MessageOut &msg, bool reliable,
                        unsigned int channel)
+{
+    if (ENetPacket *packet = createPacket(msg, reliable))
+    {
+        send(msg, packet, channel);
+        releasePacket(packet);
+    }
+}
+
+void NetComputer::send(const MessageOut &msg, ENetPacket *packet,
+                       unsigned int channel)
 {
     LOG_DEBUG("Sending message " << msg << " to " << *this);
 
-    gBandwidth->increaseClientOutput(this, msg.getLength());
+    gBandwidth->increaseClientOutput(this, msg.getId(), msg.getLength());
+
+    enet_peer_send(mPeer, channel, packet);
+}
 
-    ENetPacket *packet;
-    packet = enet_packet_create(msg.getData(),
+ENetPacket *NetComputer::createPacket(const MessageOut &msg, bool reliable)
+{
+    ENetPacket *packet = enet_packet_create(msg.getData(),
                                 msg.getLength(),
                                 reliable ? ENET_PACKET_FLAG_RELIABLE : 0);
 
-    if (packet)
-    {
-        enet_peer_send(mPeer, channel, packet);
-    }
-    else
-    {
+    if (!packet)
         LOG_ERROR("Failure to create packet!");
-    }
+
+    return packet;
+}
+
+void NetComputer::releasePacket(ENetPacket *packet)
+{
+    // Queued packets are freed by ENet once they have been sent
+    if (packet->referenceCount == 0)
+        enet_packet_destroy(packet);
 }
 
 std::ostream &operator <<(std::ostream &os, const NetComputer &comp)
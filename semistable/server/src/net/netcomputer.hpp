@@ -76,6 +76,34 @@ class NetComputer
         void send(const MessageOut &msg, bool reliable = true,
                   unsigned int channel = 0);
 
+        /**
+         * Queues a packet that is shared with other computers. ENet counts
+         * the references to the packet, so the message is copied once no
+         * matter how many computers it goes to.
+         *
+         * @param msg    The message the packet was created from.
+         * @param packet The packet returned by createPacket.
+         * @see releasePacket
+         */
+        void send(const MessageOut &msg, ENetPacket *packet,
+                  unsigned int channel = 0);
+
+        /**
+         * Creates a packet for sending the same message to several
+         * computers.
+         *
+         * @return the packet, or <code>NULL</code> on failure
+         */
+        static ENetPacket *createPacket(const MessageOut &msg,
+                                        bool reliable = true);
+
+        /**
+         * Releases a packet created by createPacket once it has been queued
+         * for all computers. The packet is freed when it wasn't queued at
+         * all, otherwise ENet frees it once it has been sent.
+         */
+        static void releasePacket(ENetPacket *packet);
+
         /**
          * Returns IP address of computer in 32bit int form
          */
@@ -228,6 +228,8 @@ enum {
     GAMSG_SET_QUEST             = 0x0540, // D id, S name, S value
     GAMSG_GET_QUEST             = 0x0541, // D id, S name
     AGMSG_GET_QUEST_RESPONSE    = 0x0542, // D id, S name, S value
+    GAMSG_GET_CHAT_JOURNAL      = 0x0545, // D id, S character name, D minutes
+    AGMSG_CHAT_JOURNAL_RESPONSE = 0x0546, // D id, { S line }*
     GAMSG_BAN_PLAYER            = 0x0550, // D id, W duration
     GAMSG_CHANGE_PLAYER_LEVEL   = 0x0555, // D id, W level
     GAMSG_CHANGE_ACCOUNT_LEVEL  = 0x0556, // D id, W level
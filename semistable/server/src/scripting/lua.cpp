@@ -31,6 +31,7 @@ extern "C" {
 #include "game-server/buysell.hpp"
 #include "game-server/character.hpp"
 #include "game-server/collisiondetection.hpp"
+#include "game-server/combatqueue.hpp"
 #include "game-server/effect.hpp"
 #include "game-server/gamehandler.hpp"
 #include "game-server/inventory.hpp"
@@ -748,7 +749,11 @@ static int being_damage(lua_State *s)
     damage.type = lua_tointeger(s, 5);
     damage.element = lua_tointeger(s, 6);
 
-    being->damage(NULL, damage);
+    // Resolved with the attacks of the tick
+    if (MapComposite *map = being->getMap())
+        map->getCombatQueue()->add(NULL, being, damage);
+    else
+        being->damage(NULL, damage);
 
     return 0;
 }
@@ -23,6 +23,7 @@
 #include "luascript.hpp"
 
 #include "game-server/being.hpp"
+#include "game-server/metrics.hpp"
 
 #include "utils/logger.h"
 
@@ -62,6 +63,8 @@ void LuaScript::push(Thing *v)
 
 int LuaScript::execute()
 {
+    Metrics::CallTimer timer(Metrics::CALL_SCRIPT);
+
     assert(nbArgs >= 0);
     int res = lua_pcall(mState, nbArgs, 1, 0);
     nbArgs = -1;
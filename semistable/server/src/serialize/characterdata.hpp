@@ -82,7 +82,7 @@ void serializeCharacterData(const T &data, MessageOut &msg)
     }
 
     // character specials
-    std::map<int, Special*>::const_iterator special_it;
+    typename T::Specials::const_iterator special_it;
     msg.writeShort(data.getSpecialSize());
     for (special_it = data.getSpecialBegin(); special_it != data.getSpecialEnd() ; special_it++)
     {
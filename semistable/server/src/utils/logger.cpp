@@ -20,9 +20,10 @@
 
 #include "logger.h"
 
-#include <ctime>
+#include "utils/thread.hpp"
+
+#include <cstdlib>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
 
 #ifdef WIN32
@@ -33,51 +34,390 @@ namespace utils
 {
 
 static std::ofstream mLogFile;     /**< Log file. */
+static std::ofstream mBinaryFile;  /**< Binary log file. */
 bool Logger::mHasTimestamp = true; /**< Timestamp flag. */
 bool Logger::mTeeMode = false;     /**< Tee mode flag. */
 Logger::Level Logger::mVerbosity = Logger::Info; /**< Verbosity level. */
 
+/** Version of the binary log format. */
+static const char BINARY_VERSION = 1;
+
+/** Longest time the writer waits before writing the buffer, in ms. */
+static const unsigned int WRITE_INTERVAL = 100;
+
+/** Time a blocked or flushing caller waits before checking again, in ms. */
+static const unsigned int RETRY_INTERVAL = 10;
+
+static const char *prefixes[] =
+{
+    "[FTL]",
+    "[ERR]",
+    "[WRN]",
+    "[INF]",
+    "[DBG]"
+};
+
+/** Messages lost to a full buffer. */
+static volatile unsigned long droppedMessages = 0;
+
 /**
-  * Gets the current time.
+  * Gets the given time as a string. The string is only formatted again once
+  * the second changes.
   *
-  * @return the current time as string.
+  * @return the time as string, the format is: [hh:mm:ss]
   */
-static std::string getCurrentTime()
+static const char *getTimestamp(time_t now)
+{
+    static time_t cachedTime = -1;
+    static char timestamp[16];
+
+    if (now != cachedTime)
+    {
+        // convert time_t to tm struct to break the time into individual
+        // constituents
+        tm local = *(localtime(&now));
+        strftime(timestamp, sizeof(timestamp), "[%H:%M:%S]", &local);
+        cachedTime = now;
+    }
+
+    return timestamp;
+}
+
+/**
+ * Appends a number to a string, least significant byte first.
+ */
+static void appendLittleEndian(std::string &data, unsigned long long value,
+                               int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        data += (char) (value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/**
+ * Flushes the outputs, once the messages of a batch are written.
+ */
+static void flushOutputs()
+{
+    std::cout.flush();
+    if (mLogFile.is_open())
+        mLogFile.flush();
+    if (mBinaryFile.is_open())
+        mBinaryFile.flush();
+}
+
+/**
+ * A message waiting in the buffer of the asynchronous logger.
+ */
+struct LogRecord
+{
+    time_t time;
+    Logger::Level level;
+    std::string msg;
+};
+
+/**
+ * The background thread of the asynchronous logger, with the ring buffer
+ * the messages wait in.
+ *
+ * Any thread may push messages, while only the writer takes them out. Each
+ * slot of the buffer carries a sequence number telling whether it is free
+ * for the push at a given position or holds the message for the pop at that
+ * position. A push claims its position with a compare-and-swap, so pushing
+ * never takes a lock. C++03 has no atomics, so the GCC builtins are used.
+ */
+class LogWriter : public Thread
+{
+    public:
+        LogWriter(unsigned int capacity, Logger::OverflowPolicy policy);
+        ~LogWriter();
+
+        /**
+         * Adds a message to the buffer. Errors and fatal messages wait for
+         * room whatever the overflow policy.
+         *
+         * @return whether the message was added, rather than dropped
+         */
+        bool push(time_t time, Logger::Level level, const std::string &msg);
+
+        /**
+         * Waits until the messages pushed so far are written.
+         */
+        void flush();
+
+        /**
+         * Stops the thread and writes the remaining messages.
+         */
+        void stop();
+
+    protected:
+        void run();
+
+    private:
+        struct Slot
+        {
+            volatile unsigned long sequence;
+            LogRecord record;
+        };
+
+        bool tryPush(time_t time, Logger::Level level, const std::string &msg,
+                     unsigned long &position);
+        bool pop(LogRecord &record);
+
+        /**
+         * Writes the messages in the buffer.
+         */
+        void writeAll();
+
+        Slot *mSlots;
+        unsigned long mMask;                  /**< Capacity minus one. */
+        volatile unsigned long mEnqueuePos;   /**< Next position to push. */
+        volatile unsigned long mDequeuePos;   /**< Next position to pop. */
+        Logger::OverflowPolicy mPolicy;
+        unsigned long mReportedDrops;
+
+        Mutex mMutex;            /**< Guards mStopping and the conditions. */
+        Condition mWork;         /**< Wakes the writer. */
+        Condition mWritten;      /**< Wakes callers waiting for the writer. */
+        bool mStopping;
+};
+
+/** The writer while the logger is asynchronous. */
+static LogWriter *writer = 0;
+
+LogWriter::LogWriter(unsigned int capacity, Logger::OverflowPolicy policy):
+    mEnqueuePos(0),
+    mDequeuePos(0),
+    mPolicy(policy),
+    mReportedDrops(droppedMessages),
+    mStopping(false)
+{
+    unsigned long size = 2;
+    while (size < capacity)
+        size *= 2;
+
+    mSlots = new Slot[size];
+    mMask = size - 1;
+    for (unsigned long i = 0; i < size; ++i)
+        mSlots[i].sequence = i;
+}
+
+LogWriter::~LogWriter()
+{
+    delete[] mSlots;
+}
+
+bool LogWriter::tryPush(time_t time, Logger::Level level,
+                        const std::string &msg, unsigned long &position)
+{
+    Slot *slot;
+    unsigned long pos = mEnqueuePos;
+    for (;;)
+    {
+        slot = &mSlots[pos & mMask];
+        const unsigned long sequence = slot->sequence;
+        __sync_synchronize();
+        const long diff = (long) (sequence - pos);
+
+        if (diff == 0)
+        {
+            // The slot is free, try to claim it
+            if (__sync_bool_compare_and_swap(&mEnqueuePos, pos, pos + 1))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The writer didn't take the message of the previous round yet
+            return false;
+        }
+        pos = mEnqueuePos;
+    }
+
+    slot->record.time = time;
+    slot->record.level = level;
+    slot->record.msg = msg;
+
+    // Publish the message only once it is complete
+    __sync_synchronize();
+    slot->sequence = pos + 1;
+
+    position = pos;
+    return true;
+}
+
+bool LogWriter::pop(LogRecord &record)
+{
+    const unsigned long pos = mDequeuePos;
+    Slot &slot = mSlots[pos & mMask];
+    if (slot.sequence != pos + 1)
+        return false;
+    __sync_synchronize();
+
+    record.time = slot.record.time;
+    record.level = slot.record.level;
+    record.msg.clear();
+    record.msg.swap(slot.record.msg);
+
+    // Hand the slot back to the pushes of the next round
+    __sync_synchronize();
+    slot.sequence = pos + mMask + 1;
+    mDequeuePos = pos + 1;
+    return true;
+}
+
+bool LogWriter::push(time_t time, Logger::Level level, const std::string &msg)
+{
+    unsigned long pos;
+    while (!tryPush(time, level, msg, pos))
+    {
+        if (mPolicy == Logger::Drop && level > Logger::Error)
+        {
+            __sync_fetch_and_add(&droppedMessages, 1);
+            return false;
+        }
+
+        MutexLock lock(mMutex);
+        mWork.signal();
+        mWritten.wait(mMutex, RETRY_INTERVAL);
+    }
+
+    // Wake the writer early when the buffer is filling up. Signaling without
+    // the mutex may miss a writer about to wait, which then wakes up after
+    // the write interval anyway.
+    if (pos - mDequeuePos == (mMask + 1) / 2)
+        mWork.signal();
+
+    return true;
+}
+
+void LogWriter::flush()
+{
+    const unsigned long target = mEnqueuePos;
+
+    MutexLock lock(mMutex);
+    while ((long) (mDequeuePos - target) < 0)
+    {
+        mWork.signal();
+        mWritten.wait(mMutex, RETRY_INTERVAL);
+    }
+}
+
+void LogWriter::stop()
+{
+    mMutex.lock();
+    mStopping = true;
+    mWork.signal();
+    mMutex.unlock();
+
+    join();
+
+    // Messages pushed while the thread was finishing
+    writeAll();
+}
+
+void LogWriter::writeAll()
+{
+    LogRecord record;
+    while (pop(record))
+    {
+        try
+        {
+            Logger::write(record.time, record.level, record.msg);
+        }
+        catch (std::ios::failure &)
+        {
+            // Nobody to report to, the message is lost
+        }
+    }
+
+    const unsigned long dropped = droppedMessages;
+    if (dropped != mReportedDrops &&
+        Logger::mVerbosity >= Logger::Warn)
+    {
+        std::ostringstream os;
+        os << "Logger: " << dropped - mReportedDrops
+           << " messages dropped because the buffer was full";
+        try
+        {
+            Logger::write(time(NULL), Logger::Warn, os.str());
+        }
+        catch (std::ios::failure &)
+        {
+        }
+    }
+    mReportedDrops = dropped;
+
+    try
+    {
+        flushOutputs();
+    }
+    catch (std::ios::failure &)
+    {
+    }
+}
+
+void LogWriter::run()
 {
-    time_t now;
-    tm local;
+    mMutex.lock();
+    for (;;)
+    {
+        const bool stopping = mStopping;
 
-    // get current time_t value
-    time(&now);
+        mMutex.unlock();
+        writeAll();
+        mMutex.lock();
 
-    // convert time_t to tm struct to break the time into individual
-    // constituents
-    local = *(localtime(&now));
+        mWritten.signal();
 
-    // stringify the time, the format is: [hh:mm:ss]
-    using namespace std;
-    ostringstream os;
-    os << "[" << setw(2) << setfill('0') << local.tm_hour
-       << ":" << setw(2) << setfill('0') << local.tm_min
-       << ":" << setw(2) << setfill('0') << local.tm_sec
-       << "]";
+        if (stopping)
+            break;
 
-    return os.str();
+        mWork.wait(mMutex, WRITE_INTERVAL);
+    }
+    mMutex.unlock();
 }
 
-void Logger::output(std::ostream &os, const std::string &msg, const char *prefix)
+static void stopAsyncAtExit()
 {
+    Logger::stopAsync();
+}
+
+void Logger::write(time_t time, Level level, const std::string &msg)
+{
+    std::string line;
     if (mHasTimestamp)
     {
-        os << getCurrentTime() << ' ';
+        line += getTimestamp(time);
+        line += ' ';
+    }
+    line += prefixes[level];
+    line += ' ';
+    line += msg;
+    line += '\n';
+
+    bool open = mLogFile.is_open();
+
+    if (open)
+    {
+        mLogFile << line;
     }
 
-    if (prefix)
+    if (!open || mTeeMode)
     {
-        os << prefix << ' ';
+        (level <= Warn ? std::cerr : std::cout) << line;
     }
 
-    os << msg << std::endl;
+    if (mBinaryFile.is_open())
+    {
+        std::string record;
+        appendLittleEndian(record, (unsigned long long) time, 8);
+        appendLittleEndian(record, level, 1);
+        appendLittleEndian(record, msg.size(), 4);
+        record += msg;
+        mBinaryFile.write(record.data(), record.size());
+    }
 }
 
 void Logger::setLogFile(const std::string &logFile)
@@ -103,32 +443,105 @@ void Logger::setLogFile(const std::string &logFile)
     }
 }
 
+void Logger::setBinaryFile(const std::string &binaryFile)
+{
+    if (mBinaryFile.is_open())
+    {
+        mBinaryFile.close();
+    }
+
+    if (binaryFile.empty())
+    {
+        return;
+    }
+
+    mBinaryFile.open(binaryFile.c_str(),
+                     std::ios::binary | std::ios::out | std::ios::trunc);
+
+    if (!mBinaryFile.is_open())
+    {
+        throw std::ios::failure("unable to open " + binaryFile +
+                                "for writing");
+    }
+
+    mBinaryFile.exceptions(std::ios::failbit | std::ios::badbit);
+    mBinaryFile.write("MLOG", 4);
+    mBinaryFile.put(BINARY_VERSION);
+}
+
 void Logger::output(const std::string &msg, Level atVerbosity)
 {
-    static const char *prefixes[] =
+    if (mVerbosity < atVerbosity)
     {
-        "[FTL]",
-        "[ERR]",
-        "[WRN]",
-        "[INF]",
-        "[DBG]"
-    };
+        return;
+    }
+
+    const time_t now = time(NULL);
 
-    if (mVerbosity >= atVerbosity)
+    if (writer)
     {
-        bool open = mLogFile.is_open();
+        writer->push(now, atVerbosity, msg);
 
-        if (open)
+        // The program is usually about to exit
+        if (atVerbosity == Fatal)
         {
-            output(mLogFile, msg, prefixes[atVerbosity]);
+            writer->flush();
         }
+        return;
+    }
 
-        if (!open || mTeeMode)
-        {
-            output(atVerbosity <= Warn ? std::cerr : std::cout,
-                   msg, prefixes[atVerbosity]);
-        }
+    write(now, atVerbosity, msg);
+    flushOutputs();
+}
+
+bool Logger::startAsync(unsigned int capacity, OverflowPolicy policy)
+{
+    if (writer)
+    {
+        return true;
     }
+
+    LogWriter *newWriter = new LogWriter(capacity, policy);
+    if (!newWriter->start())
+    {
+        delete newWriter;
+        return false;
+    }
+    writer = newWriter;
+
+    static bool registered = false;
+    if (!registered)
+    {
+        atexit(stopAsyncAtExit);
+        registered = true;
+    }
+
+    return true;
+}
+
+void Logger::stopAsync()
+{
+    if (!writer)
+    {
+        return;
+    }
+
+    writer->stop();
+    delete writer;
+    writer = 0;
+}
+
+void Logger::flush()
+{
+    if (writer)
+    {
+        writer->flush();
+    }
+}
+
+unsigned long Logger::getDroppedCount()
+{
+    return droppedMessages;
 }
 
 } // namespace utils
@@ -21,6 +21,7 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <ctime>
 #include <iosfwd>
 #include <sstream>
 
@@ -34,8 +35,20 @@ namespace utils
  * By default, the messages will be timestamped but the logger can be
  * configured to not prefix the messages with a timestamp.
  *
+ * The messages are written as they are logged, unless the logger is made
+ * asynchronous with startAsync(). The messages are then pushed into a ring
+ * buffer, without taking a lock, and a background thread writes them in
+ * batches. When the buffer is full, the message is either dropped and
+ * counted or the caller waits for room, depending on the overflow policy.
+ * Errors are never dropped, and fatal messages are always written before
+ * output() returns.
+ *
+ * Next to the text log, the messages can also be written to a binary file
+ * with one record per message, which is easier for tools to read.
+ *
  * Limitations:
- *     - not thread-safe.
+ *     - only output() may be called from several threads, and only while
+ *       the logger is asynchronous.
  *
  * Example of use:
  *
@@ -81,6 +94,16 @@ class Logger
             Debug
         };
 
+        /**
+         * What to do with a message when the asynchronous buffer is full.
+         */
+        enum OverflowPolicy
+        {
+            Drop,   /**< Discard the message and count it, unless it is an
+                         error or fatal. */
+            Block   /**< Wait until the writer made room. */
+        };
+
         /**
          * Sets the log file.
          *
@@ -93,6 +116,21 @@ class Logger
          */
         static void setLogFile(const std::string &logFile);
 
+        /**
+         * Sets the binary log file, or stops writing one when the name is
+         * empty.
+         *
+         * The file starts with the four bytes "MLOG" and a byte holding the
+         * format version. Each message follows as its time in seconds (8
+         * bytes), its level (1 byte), the length of the text (4 bytes) and
+         * the text, with the numbers in little-endian order.
+         *
+         * @param binaryFile the log file name (may include path).
+         *
+         * @exception std::ios::failure if the log file could not be opened.
+         */
+        static void setBinaryFile(const std::string &binaryFile);
+
         /**
          * Add/removes the timestamp.
          *
@@ -131,22 +169,49 @@ class Logger
          */
         static void output(const std::string &msg, Level atVerbosity);
 
+        /**
+         * Starts writing the messages from a background thread. The log
+         * files have to be set before.
+         *
+         * @param capacity the number of messages the buffer holds, rounded
+         *        up to a power of two.
+         * @param policy what to do with messages when the buffer is full.
+         *
+         * @return whether the thread could be started.
+         */
+        static bool startAsync(unsigned int capacity = 4096,
+                               OverflowPolicy policy = Drop);
+
+        /**
+         * Writes the waiting messages and goes back to writing the messages
+         * as they are logged. Also called when the program exits.
+         */
+        static void stopAsync();
+
+        /**
+         * Waits until the messages logged so far are written.
+         */
+        static void flush();
+
+        /**
+         * Returns the number of messages dropped because the buffer was
+         * full.
+         */
+        static unsigned long getDroppedCount();
+
         static Level mVerbosity;   /**< Verbosity level. */
     private:
         static bool mHasTimestamp; /**< Timestamp flag. */
         static bool mTeeMode;      /**< Tee mode flag. */
 
         /**
-         * Logs a generic message.
-         *
-         * @param os the output stream.
-         * @param msg the message to log.
-         * @param prefix the message prefix.
+         * Writes a message to the log files and the standard outputs.
          *
          * @exception std::ios::failure.
          */
-        static void output(std::ostream &os, const std::string &msg,
-                           const char *prefix);
+        static void write(time_t time, Level level, const std::string &msg);
+
+        friend class LogWriter;
 };
 
 
@@ -28,9 +28,20 @@
 namespace utils
 {
 
+/**
+ * Folds ASCII letters to upper case. Other bytes, including those of UTF-8
+ * sequences, are left alone.
+ */
+static unsigned char foldCase(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
 StringFilter::StringFilter():
-    mInitialized(false)
+    mInitialized(false),
+    mClassCount(1)
 {
+    std::fill(mCharClasses, mCharClasses + 256, 0);
     loadSlangFilterList();
 }
 
@@ -41,21 +52,117 @@ StringFilter::~StringFilter()
 
 bool StringFilter::loadSlangFilterList()
 {
-    mInitialized = false;
+    Slangs slangs;
 
     std::string slangsList = Configuration::getValue("SlangsList", "");
     if (slangsList != "") {
         std::istringstream iss(slangsList);
         std::string tmp;
         while (getline(iss, tmp, ',')) {
-            mSlangs.push_back(tmp);
+            slangs.push_back(tmp);
         }
-        mInitialized = true;
     }
 
+    setSlangFilterList(slangs);
     return mInitialized;
 }
 
+void StringFilter::setSlangFilterList(const std::list<std::string> &slangs)
+{
+    mSlangs.clear();
+
+    // An empty slang would match everything
+    for (Slangs::const_iterator i = slangs.begin(); i != slangs.end(); ++i)
+    {
+        if (!i->empty())
+            mSlangs.push_back(*i);
+    }
+
+    compile();
+    mInitialized = !mSlangs.empty();
+}
+
+void StringFilter::compile()
+{
+    // Give each (folded) character used in the slangs its own class
+    std::fill(mCharClasses, mCharClasses + 256, 0);
+    mClassCount = 1;
+
+    for (Slangs::const_iterator i = mSlangs.begin(); i != mSlangs.end(); ++i)
+    {
+        for (std::string::const_iterator c = i->begin(); c != i->end(); ++c)
+        {
+            unsigned char folded = foldCase(*c);
+            if (!mCharClasses[folded])
+                mCharClasses[folded] = mClassCount++;
+        }
+    }
+
+    for (int c = 0; c < 256; ++c)
+        mCharClasses[c] = mCharClasses[foldCase(c)];
+
+    // Build the trie, with -1 for missing edges
+    mTransitions.assign(mClassCount, -1);
+    mMatches.assign(1, 0);
+
+    for (Slangs::const_iterator i = mSlangs.begin(); i != mSlangs.end(); ++i)
+    {
+        int state = 0;
+        for (std::string::const_iterator c = i->begin(); c != i->end(); ++c)
+        {
+            const int edge = state * mClassCount +
+                             mCharClasses[(unsigned char) *c];
+            if (mTransitions[edge] == -1)
+            {
+                mTransitions[edge] = mMatches.size();
+                mTransitions.resize(mTransitions.size() + mClassCount, -1);
+                mMatches.push_back(0);
+            }
+            state = mTransitions[edge];
+        }
+        mMatches[state] = 1;
+    }
+
+    // Fill in the missing edges by following the failure links, breadth
+    // first so that the states the links point to are complete
+    std::vector<int> failure(mMatches.size(), 0);
+    std::vector<int> queue;
+    queue.reserve(mMatches.size());
+
+    for (int c = 0; c < mClassCount; ++c)
+    {
+        int &next = mTransitions[c];
+        if (next == -1)
+            next = 0;
+        else
+            queue.push_back(next);
+    }
+
+    for (std::vector<int>::size_type q = 0; q < queue.size(); ++q)
+    {
+        const int state = queue[q];
+        const int fail = failure[state];
+
+        if (mMatches[fail])
+            mMatches[state] = 1;
+
+        for (int c = 0; c < mClassCount; ++c)
+        {
+            int &next = mTransitions[state * mClassCount + c];
+            const int failNext = mTransitions[fail * mClassCount + c];
+            if (next == -1)
+            {
+                next = failNext;
+            }
+            else
+            {
+                failure[next] = failNext;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
 void StringFilter::writeSlangFilterList()
 {
     // Write the list to config
@@ -76,26 +183,17 @@ bool StringFilter::filterContent(const std::string &text) const
         return true;
     }
 
-    bool isContentClean = true;
-    std::string upperCaseText = text;
-
-    std::transform(text.begin(), text.end(), upperCaseText.begin(),
-            (int(*)(int))std::toupper);
-
-    for (Slangs::const_iterator i = mSlangs.begin(); i != mSlangs.end(); ++i)
+    // We look for all slangs into the sentence at once.
+    int state = 0;
+    for (std::string::const_iterator c = text.begin(); c != text.end(); ++c)
     {
-        // We look for slangs into the sentence.
-        std::string upperCaseSlang = *i;
-        std::transform(upperCaseSlang.begin(), upperCaseSlang.end(),
-                upperCaseSlang.begin(), (int(*)(int))std::toupper);
-
-        if (upperCaseText.compare(upperCaseSlang)) {
-            isContentClean = false;
-            break;
-        }
+        state = mTransitions[state * mClassCount +
+                             mCharClasses[(unsigned char) *c]];
+        if (mMatches[state])
+            return false;
     }
 
-    return isContentClean;
+    return true;
 }
 
 bool StringFilter::isEmailValid(const std::string &email) const
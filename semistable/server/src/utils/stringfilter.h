@@ -23,6 +23,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 namespace utils
 {
@@ -30,6 +31,10 @@ namespace utils
 /**
  * Used to filter content containing bad words. Like username, character's
  * names, chat, ...
+ *
+ * The slangs are compiled into an Aho-Corasick automaton when the list is
+ * loaded, so a text is checked against all of them in a single pass. The
+ * matching ignores the case of ASCII letters.
  */
 class StringFilter
 {
@@ -46,6 +51,11 @@ class StringFilter
          */
         bool loadSlangFilterList();
 
+        /**
+         * Replaces the slang list.
+         */
+        void setSlangFilterList(const std::list<std::string> &slangs);
+
         /**
          * Write slang list to the config file.
          *
@@ -73,10 +83,31 @@ class StringFilter
         bool findDoubleQuotes(const std::string &text) const;
 
     private:
+        /**
+         * Builds the automaton from the slang list.
+         */
+        void compile();
+
         typedef std::list<std::string> Slangs;
         typedef Slangs::iterator SlangIterator;
         Slangs mSlangs;    /**< the formatted Slangs list */
         bool mInitialized;                 /**< Set if the list is loaded */
+
+        /**
+         * The class of each byte in the automaton. Letters of both cases
+         * share a class, and bytes that appear in no slang are class 0.
+         */
+        unsigned char mCharClasses[256];
+        int mClassCount;
+
+        /**
+         * The next state for each state and character class, with the
+         * failure links already followed.
+         */
+        std::vector<int> mTransitions;
+
+        /** Whether a slang ends in each state. */
+        std::vector<char> mMatches;
 };
 
 } // ::utils
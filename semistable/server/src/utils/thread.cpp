@@ -0,0 +1,120 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/thread.hpp"
+
+#include <errno.h>
+#include <sys/time.h>
+
+namespace utils
+{
+
+Mutex::Mutex()
+{
+    pthread_mutex_init(&mMutex, NULL);
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+void Mutex::lock()
+{
+    pthread_mutex_lock(&mMutex);
+}
+
+void Mutex::unlock()
+{
+    pthread_mutex_unlock(&mMutex);
+}
+
+Condition::Condition()
+{
+    pthread_cond_init(&mCondition, NULL);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&mCondition);
+}
+
+void Condition::wait(Mutex &mutex)
+{
+    pthread_cond_wait(&mCondition, &mutex.mMutex);
+}
+
+bool Condition::wait(Mutex &mutex, unsigned int ms)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    struct timespec timeout;
+    timeout.tv_sec = now.tv_sec + ms / 1000;
+    timeout.tv_nsec = (now.tv_usec + (ms % 1000) * 1000) * 1000;
+    if (timeout.tv_nsec >= 1000000000)
+    {
+        ++timeout.tv_sec;
+        timeout.tv_nsec -= 1000000000;
+    }
+
+    return pthread_cond_timedwait(&mCondition, &mutex.mMutex,
+                                  &timeout) != ETIMEDOUT;
+}
+
+void Condition::signal()
+{
+    pthread_cond_signal(&mCondition);
+}
+
+Thread::Thread():
+    mRunning(false)
+{
+}
+
+Thread::~Thread()
+{
+}
+
+bool Thread::start()
+{
+    if (mRunning)
+        return true;
+
+    mRunning = pthread_create(&mThread, NULL, &Thread::entry, this) == 0;
+    return mRunning;
+}
+
+void Thread::join()
+{
+    if (!mRunning)
+        return;
+
+    pthread_join(mThread, NULL);
+    mRunning = false;
+}
+
+void *Thread::entry(void *thread)
+{
+    static_cast<Thread *>(thread)->run();
+    return NULL;
+}
+
+} // ::utils
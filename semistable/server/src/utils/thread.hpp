@@ -0,0 +1,147 @@
+/*
+ *  The Mana Server
+ *  Copyright (C) 2010  The Mana Developers
+ *
+ *  This file is part of The Mana Server.
+ *
+ *  The Mana Server is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  The Mana Server is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with The Mana Server.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_HPP
+#define THREAD_HPP
+
+#include <pthread.h>
+
+namespace utils
+{
+
+/**
+ * A mutual exclusion lock.
+ */
+class Mutex
+{
+    public:
+        Mutex();
+        ~Mutex();
+
+        void lock();
+        void unlock();
+
+    private:
+        Mutex(const Mutex &);
+        Mutex &operator=(const Mutex &);
+
+        pthread_mutex_t mMutex;
+
+        friend class Condition;
+};
+
+/**
+ * Locks a mutex for as long as it exists.
+ */
+class MutexLock
+{
+    public:
+        MutexLock(Mutex &mutex): mMutex(mutex) { mMutex.lock(); }
+        ~MutexLock() { mMutex.unlock(); }
+
+    private:
+        MutexLock(const MutexLock &);
+        MutexLock &operator=(const MutexLock &);
+
+        Mutex &mMutex;
+};
+
+/**
+ * A condition variable, for a thread to wait until another one wakes it.
+ */
+class Condition
+{
+    public:
+        Condition();
+        ~Condition();
+
+        /**
+         * Waits until the condition is signaled. The mutex has to be locked,
+         * and is unlocked while waiting.
+         */
+        void wait(Mutex &mutex);
+
+        /**
+         * Waits until the condition is signaled or the given time has passed.
+         *
+         * @return <code>false</code> when the time passed
+         */
+        bool wait(Mutex &mutex, unsigned int ms);
+
+        /**
+         * Wakes one waiting thread.
+         */
+        void signal();
+
+    private:
+        Condition(const Condition &);
+        Condition &operator=(const Condition &);
+
+        pthread_cond_t mCondition;
+};
+
+/**
+ * A thread of execution. Subclasses implement run(), which is called on the
+ * new thread once it is started.
+ */
+class Thread
+{
+    public:
+        Thread();
+
+        /**
+         * Destructor. The thread has to be joined before.
+         */
+        virtual ~Thread();
+
+        /**
+         * Starts the thread.
+         *
+         * @return whether the thread could be created
+         */
+        bool start();
+
+        /**
+         * Waits until run() returns.
+         */
+        void join();
+
+        /**
+         * Returns whether the thread was started and not joined yet.
+         */
+        bool isRunning() const
+        { return mRunning; }
+
+    protected:
+        virtual void run() = 0;
+
+    private:
+        Thread(const Thread &);
+        Thread &operator=(const Thread &);
+
+        static void *entry(void *thread);
+
+        pthread_t mThread;
+        bool mRunning;
+};
+
+} // ::utils
+
+#endif // THREAD_HPP
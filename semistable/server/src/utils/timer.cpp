@@ -99,4 +99,12 @@ uint64_t Timer::getTimeInMillisec()
     return timeInMillisec;
 }
 
+uint64_t Timer::getTimeInMicrosec()
+{
+    timeval time;
+
+    gettimeofday(&time, 0);
+    return (uint64_t)time.tv_sec * 1000 * 1000 + time.tv_usec;
+}
+
 } // ::utils
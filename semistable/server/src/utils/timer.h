@@ -67,12 +67,17 @@ class Timer
          */
         void changeInterval (unsigned int newinterval);
 
-    private:
         /**
          * Calls gettimeofday() and converts it into milliseconds.
          */
-        uint64_t getTimeInMillisec();
+        static uint64_t getTimeInMillisec();
 
+        /**
+         * Calls gettimeofday() and converts it into microseconds.
+         */
+        static uint64_t getTimeInMicrosec();
+
+    private:
         /**
          * Interval between two pulses.
          */